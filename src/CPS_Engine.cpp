@@ -16,7 +16,8 @@
  * \param   SE a SensingEngine as the input source
  * ================================================================================================
  */
-CPS_Engine::CPS_Engine(SensingEngine* SE) : InferenceEngine(SE)
+CPS_Engine::CPS_Engine(SensingEngine* SE) : InferenceEngine(SE), trackLookups(0), trackHits(0), savedTimeSum(0), speculatedSamples(0), acceptedSamples(0),
+                                             revokedBatches(0), mosaicModel(nullptr), batchSamples(0), batchSlots(0), heldServed(0), addedLatencySum(0), fixedLatencySum(0), cascadeLatencySum(0)
 {
     registerModels();
 }
@@ -33,35 +34,40 @@ CPS_Engine::registerModels (void)
 {
 #if MODEL_MASK & RESNET_56_56
     imgShapes.emplace_back(make_pair(56, 56));
-    models.emplace_back(new OnnxResNet("resnet50_56_56", 4));
+    models.emplace_back(ModelPool::acquire<OnnxResNet>("resnet50_56_56", 4));
 #endif
 #if MODEL_MASK & RESNET_112_112
     imgShapes.emplace_back(make_pair(112, 112));
-    models.emplace_back(new OnnxResNet("resnet50_112_112", 4));
+    models.emplace_back(ModelPool::acquire<OnnxResNet>("resnet50_112_112", 4));
 #endif
 #if MODEL_MASK & RESNET_168_168
     imgShapes.emplace_back(make_pair(168, 168));
-    models.emplace_back(new OnnxResNet("resnet50_168_168", 4));
+    models.emplace_back(ModelPool::acquire<OnnxResNet>("resnet50_168_168", 4));
 #endif
 #if MODEL_MASK & RESNET_224_224
     imgShapes.emplace_back(make_pair(224, 224));
-    models.emplace_back(new OnnxResNet("resnet50_224_224", 2));
+    models.emplace_back(ModelPool::acquire<OnnxResNet>("resnet50_224_224", 2));
 #endif
 #if MODEL_MASK & RESNET_280_280
     imgShapes.emplace_back(make_pair(280, 280));
-    models.emplace_back(new OnnxResNet("resnet50_280_280", 1));
+    models.emplace_back(ModelPool::acquire<OnnxResNet>("resnet50_280_280", 1));
 #endif
 #if MODEL_MASK & RESNET_336_336
     imgShapes.emplace_back(make_pair(336, 336));
-    models.emplace_back(new OnnxResNet("resnet50_336_336", 1));
+    models.emplace_back(ModelPool::acquire<OnnxResNet>("resnet50_336_336", 1));
 #endif
 #if MODEL_MASK & RESNET_448_448
     imgShapes.emplace_back(make_pair(448, 448));
-    models.emplace_back(new OnnxResNet("resnet50_448_448", 1));
+    models.emplace_back(ModelPool::acquire<OnnxResNet>("resnet50_448_448", 1));
 #endif
 #if MODEL_MASK & RESNET_1280_1920
     imgShapes.emplace_back(make_pair(1280, 1920));
-    models.emplace_back(new OnnxResNet("resnet50_1280_1920", 1));
+    models.emplace_back(ModelPool::acquire<OnnxResNet>("resnet50_1280_1920", 1));
+#endif
+#if MOSAIC_PACKING && CPS_SCHED_POLICY != CPS_SCHED_CASCADE
+    /* no entry in imgShapes, the slices are never assigned to it by the shape */
+    mosaicModel = ModelPool::acquire<OnnxYoloNet>(MOSAIC_MODEL, 4);
+    models.emplace_back(mosaicModel);
 #endif
 }
 
@@ -75,7 +81,12 @@ CPS_Engine::registerModels (void)
 void 
 CPS_Engine::dataPreprocessor(void)
 {
+    TRACE_SCOPE("cps", "slice");
     log_D("CPS_Engine", "dataPreprocessor");
+#if CPS_SPECULATION
+    speculate();
+#endif
+
     struct timeval start, end;
     gettimeofday(&start, NULL);
         /* ******************************************
@@ -147,44 +158,100 @@ CPS_Engine::dataPreprocessor(void)
          * Removing too samll obstacle
          * ******************************************
          */
+        vector<pair<float, boundingBox_t>> kept;
         for (auto obstacle: obstacles) {
             int area = (obstacle.second.right - obstacle.second.left) * (obstacle.second.bottom - obstacle.second.top);
-            
-            if (area > pow(56, 2) && LIDAR_RANGING_MAX > obstacle.first)
-            {
-                log_V("CPS_Engine", "Slincing obstacle: [" + to_string(obstacle.second.top) + ", " + to_string(obstacle.second.bottom) + ", " + to_string(obstacle.second.left) + ", " + to_string(obstacle.second.right) + "]");
-                int diff_area = INT32_MAX;
-                int shapeId = 0;
-                for (int i = 0; i < imgShapes.size(); i++)
-                {
-                    int new_diff = abs(area - (imgShapes[i].first * imgShapes[i].second));
-                    if (new_diff < diff_area)
-                    {
-                        shapeId = i;
-                        diff_area = new_diff;
-                    }
-                }
+            if (area > pow(56, 2) && LIDAR_RANGING_MAX > obstacle.first) kept.push_back(obstacle);
+        }
 
-                string logInfo = "assign [" + to_string(obstacle.second.bottom - obstacle.second.top) + ", " + to_string(obstacle.second.right - obstacle.second.left) + "] to shape: [" + to_string(imgShapes[shapeId].first) + ", " + to_string(imgShapes[shapeId].second) + "]";
-                log_V("CPS_Engine::dataPreprocessor", logInfo);
+        /* ******************************************
+         * Tracking the obstacles
+         * ******************************************
+         */
+        vector<Track_Box_t> trackBoxes;
+        vector<float> trackDepths;
+        vector<int> trackIds;
+        for (auto& obstacle : kept) {
+            trackBoxes.push_back({obstacle.second.left, obstacle.second.top, obstacle.second.right, obstacle.second.bottom});
+            trackDepths.push_back(obstacle.first);
+        }
+        tracker.update(trackBoxes, trackDepths, &trackIds);
+
+        vector<Inference_Task_t> newTasks;
+        taskOrigins.clear();
+#if TRACK_RESULT_REUSE
+        int hitNum = 0;
+        float savedTime = 0;
+#endif
+        for (int k = 0; k < kept.size(); k++) {
+            auto& obstacle = kept[k];
+            log_V("CPS_Engine", "Slincing obstacle: [" + to_string(obstacle.second.top) + ", " + to_string(obstacle.second.bottom) + ", " + to_string(obstacle.second.left) + ", " + to_string(obstacle.second.right) + "]");
+            int shapeId = assignShape(obstacle.second);
 
-                /* Create task by the object from the raw image */
-                cv::Mat* croppedImage = new cv::Mat(mImg(
-                    cv::Range(obstacle.second.top   , obstacle.second.bottom), 
-                    cv::Range(obstacle.second.left  , obstacle.second.right)
-                ));
+            string logInfo = "assign [" + to_string(obstacle.second.bottom - obstacle.second.top) + ", " + to_string(obstacle.second.right - obstacle.second.left) + "] to shape: [" + to_string(imgShapes[shapeId].first) + ", " + to_string(imgShapes[shapeId].second) + "]";
+            log_V("CPS_Engine::dataPreprocessor", logInfo);
 
-                /* ************************************************************
-                 * Set the priority as the fraction of the normalized distant
-                 * ************************************************************
-                 */
-                Inference_Task_t task = {(void*)croppedImage, (LIDAR_RANGING_MAX - obstacle.first) / LIDAR_RANGING_MAX, models[shapeId]};
-                taskQueue.emplace_back(task);
+#if TRACK_RESULT_REUSE
+            /* The stable track reuses its cached results without inference */
+            vector<Inference_Result_t> cached;
+            if (tracker.lookup(trackIds[k], &cached))
+            {
+                Inference_Result_t* slots = cached.empty() ? nullptr : frameResults.reserve(cached.size());
+                if (slots) copy(cached.begin(), cached.end(), slots);
 
+                OnnxModel* model = models[shapeId];
+                savedTime += model->Onnx_estimateLatency(model->batchLimit) / model->batchLimit;
+                hitNum++;
+                continue;
             }
+#endif
+#if CPS_SPECULATION
+            /* The speculative sample on the predicted box serves the obstacle */
+            if (acceptSpeculation(trackIds[k], obstacle.second, models[shapeId])) continue;
+#endif
+
+            /* Create task by the object from the raw image */
+            cv::Mat* croppedImage = new cv::Mat(mImg(
+                cv::Range(obstacle.second.top   , obstacle.second.bottom), 
+                cv::Range(obstacle.second.left  , obstacle.second.right)
+            ));
+
+            /* ************************************************************
+             * Set the priority as the fraction of the normalized distant
+             * ************************************************************
+             */
+            Inference_Task_t task = {(void*)croppedImage, (LIDAR_RANGING_MAX - obstacle.first) / LIDAR_RANGING_MAX, models[shapeId]};
+            newTasks.push_back(task);
+            taskOrigins[task.data] = {obstacle.second, task.priority, 0, trackIds[k]};
         }
+
+#if CPS_SPECULATION
+        /* The batches without any accepted sample are withdrawn */
+        for (auto& speculation : speculations)
+        {
+            if (find(speculation.accepted.begin(), speculation.accepted.end(), true) != speculation.accepted.end()) continue;
+            speculation.job->revoke();
+        }
+#endif
+
+#if TRACK_RESULT_REUSE
+        trackLookups += kept.size();
+        trackHits += hitNum;
+        savedTimeSum += savedTime;
+        log_I("CPS_Engine", "Track cache: hits " + to_string(hitNum) + "/" + to_string(kept.size()) + ", saved: " + to_string(savedTime) + " ms, hit rate: " +
+                            to_string(trackLookups ? trackHits * 100.0 / trackLookups : 0) + "% (total saved " + to_string(savedTimeSum) + " ms)");
+#endif
         mLidarPoints.clear();
         obstacles.clear();
+
+#if TASK_CARRY_OVER
+        mergeCarriedTasks(newTasks);
+#endif
+        if (mosaicModel) packMosaics(newTasks);
+        for (auto& task : newTasks)
+        {
+            taskQueue.push(task);
+        }
     gettimeofday(&end, NULL);
     
     float spendTime = (1000000 * (end.tv_sec - start.tv_sec) + (end.tv_usec - start.tv_usec)) * 0.001;   
@@ -202,11 +269,11 @@ CPS_Engine::dataPreprocessor(void)
 void 
 CPS_Engine::Inference_sched (void)
 {
-    /* sort the taskQueue by non-ascending order of priority */
-    sort(taskQueue.begin(), taskQueue.end(), [](Inference_Task_t x, Inference_Task_t y) {return x.priority > y.priority;});
-    for(auto task : taskQueue)
+    TRACE_SCOPE("cps", "sched");
+    /* the taskQueue keeps the tasks of each model in a heap, no sort needed */
+    for(auto model : models)
     {
-        log_V("CPS_Engine", "Sort tasks: " + to_string(task.priority));
+        log_V("CPS_Engine", model->modelName + " tasks: " + to_string(taskQueue.size(model)) + ", priority: " + to_string(taskQueue.priority(model)));
     }
 }
 
@@ -220,95 +287,1023 @@ CPS_Engine::Inference_sched (void)
 void 
 CPS_Engine::onInference (timeval frameStart)
 {
+    TRACE_SCOPE("cps", "inference");
+#if BATCH_ACCUMULATION
+    accumulateTasks(frameStart);
+#endif
     
     log_D("CPS_Engine", "Task queue size: " + to_string(taskQueue.size()));
     if(taskQueue.size() == 0)
     {
         log_D("CPS_Engine", "taskQueue.size() == 0");
+#if CPS_SPECULATION
+        collectSpeculation();
+#endif
         return;
     }
 
-    vector<Inference_Task_t*> taskSetPriorities;
-    for(auto model : models)
+#if CPS_SCHED_POLICY == CPS_SCHED_KNAPSACK
+    int cancelledJobs = scheduleKnapsack(frameStart);
+#elif CPS_SCHED_POLICY == CPS_SCHED_CASCADE
+    int cancelledJobs = scheduleCascade(frameStart);
+#else
+    int cancelledJobs = scheduleGreedy(frameStart);
+#endif
+#if CPS_SPECULATION
+    collectSpeculation();
+#endif
+    
+    log_I("CPS_Engine", "Cancelled batches: " + to_string(cancelledJobs));
+    log_I("CPS_Engine", "Remaining tasks: " + to_string(taskQueue.size()));
+    log_I("CPS_Engine", "Batch fill: " + to_string(batchSlots ? batchSamples * 100.0 / batchSlots : 0) + "%, held tasks: " + to_string(heldTasks.size()) +
+                        ", added latency: " + to_string(heldServed ? addedLatencySum / heldServed : 0) + " ms per held task");
+    vector<Inference_Task_t> remainingTasks;
+    taskQueue.snapshot(&remainingTasks);
+    for(auto task : remainingTasks)
     {
-        taskSetPriorities.emplace_back(new Inference_Task_t({nullptr, 0, model}));
+        log_D("CPS_Engine", task.model->modelName);
     }
 
+#if TASK_CARRY_OVER
+    carryOverTasks();
+#endif
+    taskQueue.clear();
+    heldReleases.clear();
+
+}
+
+
+/** ===============================================================================================
+ * \name    releaseTask
+ * 
+ * \brief   Release the cropped image of a task dropped without inference
+ * ================================================================================================
+ */
+void 
+CPS_Engine::releaseTask (const Inference_Task_t& task)
+{
+    mosaics.erase(task.data);
+    delete (cv::Mat*) task.data;
+}
+
+
+/** ===============================================================================================
+ * \name    scheduleGreedy
+ * 
+ * \brief   Run the model with the most summed priority first, fill its batch with the tasks
+ * 
+ * \return  the number of batches cancelled by the frame deadline
+ * ================================================================================================
+ */
+int 
+CPS_Engine::scheduleGreedy (timeval frameStart)
+{
+    float spendTime;
+    struct timeval now;
+    int cancelledJobs = 0;
+
+    /* The models without enough time in this frame */
+    vector<OnnxModel*> skippedModels;
+
+    do 
+    {
+        /* Update remaining time */
+        gettimeofday(&now, NULL);
+        spendTime = (1000000 * (now.tv_sec - frameStart.tv_sec) + (now.tv_usec - frameStart.tv_usec)) * 0.001;
+        float remaingTime = SENSING_PERIOD - spendTime;
+        log_D("CPS_Engine", "Remaining time: " + to_string(remaingTime));
+        
+        /* Choose the most priority model with enough time */
+        OnnxModel* maxModel = nullptr;
+        for(auto model : models)
+        {
+            if (taskQueue.size(model) == 0 || find(skippedModels.begin(), skippedModels.end(), model) != skippedModels.end()) continue;
+            if (!maxModel || taskQueue.priority(model) > taskQueue.priority(maxModel)) maxModel = model;
+        }
+
+        if(!maxModel)
+        {
+            break;
+
+        } else if(maxModel->Onnx_estimateLatency(maxModel->batchLimit) > remaingTime) {
+            skippedModels.push_back(maxModel);
+            continue;
+        }
+
+        /* Pick the most priority tasks of the model */
+        vector<Inference_Task_t> batch;
+        while (batch.size() < maxModel->batchLimit && taskQueue.size(maxModel) > 0)
+        {
+            batch.push_back(taskQueue.pop(maxModel));
+        }
+
+        /* Start Inference */
+        cancelledJobs += inferenceBatch(maxModel, batch);
+
+    }while(SENSING_PERIOD > spendTime);
+
+    return cancelledJobs;
+}
+
+
+/** ===============================================================================================
+ * \name    scheduleKnapsack
+ * 
+ * \brief   Solve a multiple-choice knapsack over the models. Option n of a model runs its n most
+ *          priority tasks in ceil(n / batchLimit) batches, the cost is the profiled latency of these
+ *          batches and the value is the summed priority. The picked options maximize the scheduled
+ *          priority within the remaining time of the frame.
+ * 
+ * \return  the number of batches cancelled by the frame deadline
+ * ================================================================================================
+ */
+int 
+CPS_Engine::scheduleKnapsack (timeval frameStart)
+{
     /* ******************************************
-     * Calculate the total priority of model
+     * Drain the tasks of each model in 
+     * non-ascending order of priority
      * ******************************************
      */
-    for(auto task : taskQueue)
+    vector<vector<Inference_Task_t>> modelTasks(models.size());
+    for (int m = 0; m < models.size(); m++)
     {
-        for (int i = 0; i < taskSetPriorities.size(); i++)
+        while (taskQueue.size(models[m]) > 0)
         {
-            if(taskSetPriorities[i]->model == task.model)
+            modelTasks[m].push_back(taskQueue.pop(models[m]));
+        }
+    }
+
+    knapsack.clear();
+    vector<int> groupModels;
+    for (int m = 0; m < models.size(); m++)
+    {
+        if (modelTasks[m].empty()) continue;
+
+        OnnxModel* model = models[m];
+        int group = knapsack.addGroup();
+        groupModels.push_back(m);
+
+        float value = 0;
+        float batchLatency = model->Onnx_estimateLatency(model->batchLimit);
+        for (int n = 1; n <= modelTasks[m].size(); n++)
+        {
+            value += modelTasks[m][n - 1].priority;
+
+            int restNum = n % model->batchLimit;
+            float cost = (n / model->batchLimit) * batchLatency + (restNum ? model->Onnx_estimateLatency(restNum) : 0);
+            knapsack.addOption(group, cost, value);
+        }
+    }
+
+    /* ******************************************
+     * Solve within the remaining time
+     * ******************************************
+     */
+    struct timeval now, solved;
+    gettimeofday(&now, NULL);
+    float spendTime = (1000000 * (now.tv_sec - frameStart.tv_sec) + (now.tv_usec - frameStart.tv_usec)) * 0.001;
+    float remaingTime = SENSING_PERIOD - spendTime;
+
+    vector<int> choices;
+    float scheduledPriority = knapsack.solve(remaingTime, &choices);
+
+    gettimeofday(&solved, NULL);
+    log_D("CPS_Engine", "Knapsack solve spend: " + to_string(1000000 * (solved.tv_sec - now.tv_sec) + (solved.tv_usec - now.tv_usec)) + " us");
+    log_D("CPS_Engine", "Remaining time: " + to_string(remaingTime) + ", scheduled priority: " + to_string(scheduledPriority));
+
+    /* ******************************************
+     * Run the picked batches, the most priority
+     * model first
+     * ******************************************
+     */
+    vector<pair<float, int>> schedule;
+    for (int g = 0; g < choices.size(); g++)
+    {
+        int m = groupModels[g];
+        int taskNum = choices[g] + 1;
+
+        float priority = 0;
+        for (int i = 0; i < taskNum; i++) priority += modelTasks[m][i].priority;
+        if (taskNum > 0) schedule.emplace_back(priority, m);
+
+        /* the unpicked tasks remain in the queue */
+        for (int i = taskNum; i < modelTasks[m].size(); i++)
+        {
+            taskQueue.push(modelTasks[m][i]);
+        }
+        modelTasks[m].resize(taskNum);
+    }
+    sort(schedule.begin(), schedule.end(), [](pair<float, int> x, pair<float, int> y) {return x.first > y.first;});
+
+    int cancelledJobs = 0;
+    for (auto& entry : schedule)
+    {
+        OnnxModel* model = models[entry.second];
+        vector<Inference_Task_t>& tasks = modelTasks[entry.second];
+
+        for (int i = 0; i < tasks.size(); i += model->batchLimit)
+        {
+            vector<Inference_Task_t> batch(tasks.begin() + i, tasks.begin() + min((int)tasks.size(), i + model->batchLimit));
+            cancelledJobs += inferenceBatch(model, batch);
+        }
+    }
+
+    return cancelledJobs;
+}
+
+
+/** ===============================================================================================
+ * \name    scheduleCascade
+ * 
+ * \brief   Run every task on the cheapest model first and escalate the samples scored below 
+ *          CASCADE_CONFIDENCE to the next model, up to the model assigned by the crop shape. The
+ *          saving is the profiled latency of the fixed assignment minus the one of the cascade.
+ * 
+ * \return  the number of batches cancelled by the frame deadline
+ * ================================================================================================
+ */
+int 
+CPS_Engine::scheduleCascade (timeval frameStart)
+{
+    vector<Inference_Task_t> tasks;
+    taskQueue.snapshot(&tasks);
+    taskQueue.clear();
+    sort(tasks.begin(), tasks.end(), [](const Inference_Task_t& x, const Inference_Task_t& y) {return x.priority > y.priority;});
+
+    /* ******************************************
+     * The fixed assignment
+     * ******************************************
+     */
+    vector<int> assigned(tasks.size());
+    vector<int> assignedNum(models.size(), 0);
+    for (int i = 0; i < tasks.size(); i++)
+    {
+        assigned[i] = find(models.begin(), models.end(), tasks[i].model) - models.begin();
+        assignedNum[assigned[i]]++;
+    }
+
+    float fixedLatency = 0;
+    for (int m = 0; m < models.size(); m++)
+    {
+        int batchNum = (assignedNum[m] + models[m]->batchLimit - 1) / models[m]->batchLimit;
+        fixedLatency += batchNum * models[m]->Onnx_estimateLatency(models[m]->batchLimit);
+    }
+
+    /* ******************************************
+     * Escalate level by level
+     * ******************************************
+     */
+    vector<vector<Inference_Result_t>> taskResults(tasks.size());
+    vector<bool> requeued(tasks.size(), false);
+    vector<int> pending(tasks.size());
+    for (int i = 0; i < tasks.size(); i++) pending[i] = i;
+
+    int cancelledJobs = 0;
+    float cascadeLatency = 0;
+    bool timeout = false;
+    for (int level = 0; level < models.size() && !pending.empty() && !timeout; level++)
+    {
+        OnnxModel* model = models[level];
+        vector<int> escalated;
+
+        for (int begin = 0; begin < pending.size(); begin += model->batchLimit)
+        {
+            int end = min((int)pending.size(), begin + model->batchLimit);
+
+            struct timeval now;
+            gettimeofday(&now, NULL);
+            float remaingTime = SENSING_PERIOD - (1000000 * (now.tv_sec - frameStart.tv_sec) + (now.tv_usec - frameStart.tv_usec)) * 0.001;
+            float batchLatency = model->Onnx_estimateLatency(end - begin);
+            if (batchLatency > remaingTime)
+            {
+                /* the samples not inferred yet remain in the queue */
+                for (int i = begin; i < pending.size(); i++)
+                {
+                    if (level > 0) continue;
+                    taskQueue.push(tasks[pending[i]]);
+                    requeued[pending[i]] = true;
+                }
+                timeout = true;
+                break;
+            }
+
+            /* Start Inference */
+            bool urgent = false;
+            for (int i = begin; i < end; i++)
+            {
+                Inference_Task_t& task = tasks[pending[i]];
+                urgent |= task.priority >= URGENT_TASK_PRIORITY;
+
+                vector<float> dataStream(model->singleInputSize);
+                model->dataPreprocess(task.data, &dataStream);
+                model->Onnx_addInput(dataStream);
+            }
+
+            cascadeResults.clear();
+            InferenceJob* job = executor.submit(model, &frameDeadline, urgent, &cascadeResults);
+            job->wait();
+            cascadeLatency += batchLatency;
+            bool cancelled = job->cancelled;
+            delete job;
+
+            /* a cancelled level keeps the results of the previous level and stops there */
+            if (cancelled)
+            {
+                log_W("CPS_Engine", model->modelName + " cancelled by the frame deadline");
+                cancelledJobs++;
+                continue;
+            }
+
+            /* Replace the results by the level, escalate the uncertain samples */
+            vector<float> confidence(end - begin, 0);
+            for (int i = begin; i < end; i++) taskResults[pending[i]].clear();
+            for (int r = 0; r < cascadeResults.size(); r++)
+            {
+                const Inference_Result_t& result = cascadeResults[r];
+                int taskId = pending[begin + result.sampleId];
+                confidence[result.sampleId] = max(confidence[result.sampleId], result.score);
+                taskResults[taskId].push_back(result);
+            }
+            for (int i = begin; i < end; i++)
             {
-                taskSetPriorities[i]->priority += task.priority;
+                if (confidence[i - begin] < CASCADE_CONFIDENCE && level < assigned[pending[i]]) escalated.push_back(pending[i]);
             }
         }
+
+        log_D("CPS_Engine", model->modelName + " escalated " + to_string(escalated.size()) + "/" + to_string(pending.size()));
+        if (!timeout) pending.swap(escalated);
     }
 
-    for(auto taskSetPriority : taskSetPriorities)
+    /* ******************************************
+     * Accept the last results of every task
+     * ******************************************
+     */
+    for (int i = 0; i < tasks.size(); i++)
     {
-        log_V("CPS_Engine", taskSetPriority->model->modelName + " priority: " + to_string(taskSetPriority->priority));
+        if (requeued[i]) continue;
+
+        if (!taskResults[i].empty())
+        {
+            Inference_Result_t* slots = frameResults.reserve(taskResults[i].size());
+            if (slots) copy(taskResults[i].begin(), taskResults[i].end(), slots);
+
+#if TRACK_RESULT_REUSE
+            auto origin = taskOrigins.find(tasks[i].data);
+            if (origin != taskOrigins.end() && origin->second.trackId >= 0) tracker.store(origin->second.trackId, taskResults[i]);
+#endif
+        }
+        delete (cv::Mat*) tasks[i].data;
     }
 
-    float spendTime;
+    fixedLatencySum += fixedLatency;
+    cascadeLatencySum += cascadeLatency;
+    log_I("CPS_Engine", "Cascade profiled: " + to_string(cascadeLatency) + " ms, fixed assignment profiled: " + to_string(fixedLatency) + " ms, estimated saving: " + 
+                        to_string(fixedLatency - cascadeLatency) + " ms (total " + to_string(fixedLatencySum - cascadeLatencySum) + " ms)");
+
+    return cancelledJobs;
+}
+
+
+/** ===============================================================================================
+ * \name    inferenceBatch
+ * 
+ * \brief   Preprocess the tasks into one batch of the model and wait for the inference
+ * 
+ * \param   model the model of the tasks
+ * \param   tasks the tasks of the batch, no more than the batchLimit
+ * 
+ * \return  true if the batch is cancelled by the frame deadline
+ * ================================================================================================
+ */
+bool 
+CPS_Engine::inferenceBatch (OnnxModel* model, vector<Inference_Task_t>& tasks)
+{
+    TRACE_SCOPE_ARG("cps", "batch", tasks.size());
     struct timeval now;
+    gettimeofday(&now, NULL);
 
-    do 
+    bool urgent = false;
+    vector<Mosaic_t> batchMosaics;
+    vector<int> trackIds;
+    for (auto& task : tasks)
     {
-        /* Update remaining time */
-        gettimeofday(&now, NULL);
-        spendTime = (1000000 * (now.tv_sec - frameStart.tv_sec) + (now.tv_usec - frameStart.tv_usec)) * 0.001;
-        float remaingTime = SENSING_PERIOD - spendTime;
-        log_D("CPS_Engine", "Remaining time: " + to_string(remaingTime));
-        
-        /* Choose the most priority model with enough time */
-        auto max_task = max_element(taskSetPriorities.begin(), taskSetPriorities.end(), [](Inference_Task_t* x, Inference_Task_t* y) {return x->priority < y->priority;});
+        urgent |= task.priority >= URGENT_TASK_PRIORITY;
+
+        auto origin = taskOrigins.find(task.data);
+        trackIds.push_back(origin != taskOrigins.end() ? origin->second.trackId : -1);
 
-        float tolerance = 1e-6;  // The precision tolerance
-        if(abs((*max_task)->priority) < tolerance)
+        auto mosaic = mosaics.find(task.data);
+        if (mosaic != mosaics.end())
         {
-            break;
+            batchMosaics.push_back(mosaic->second);
+            mosaics.erase(mosaic);
+        }
+
+        /* the latency added by holding the task */
+        auto held = heldReleases.find(task.data);
+        if (held != heldReleases.end())
+        {
+            addedLatencySum += (1000000 * (now.tv_sec - held->second.tv_sec) + (now.tv_usec - held->second.tv_usec)) * 0.001;
+            heldServed++;
+            heldReleases.erase(held);
+        }
+
+        vector<float> dataStream(model->singleInputSize);
+        model->dataPreprocess(task.data, &dataStream);
+        model->Onnx_addInput(dataStream);
+
+        /* the cropped image is served */
+        delete (cv::Mat*) task.data;
+    }
+
+    batchSamples += tasks.size();
+    batchSlots += model->batchLimit;
+
+    /* Start Inference, the detections on the canvases are mapped back before joining the frame */
+    if (model == mosaicModel) mosaicResults.clear();
+    size_t resultStart = frameResults.size();
+    InferenceJob* job = executor.submit(model, &frameDeadline, urgent, model == mosaicModel ? &mosaicResults : &frameResults);
+    job->wait();
+
+    bool cancelled = job->cancelled;
+    bool cache = TRACK_RESULT_REUSE && !cancelled;
+    if (model == mosaicModel)
+    {
+        decodeMosaics(batchMosaics, mosaicResults, cache);
+    } else if (cache) {
+        cacheResults(trackIds, frameResults, resultStart);
+    }
+
+    if (cancelled)
+    {
+        log_W("CPS_Engine", model->modelName + " cancelled by the frame deadline");
+    }
+    delete job;
+
+    return cancelled;
+}
+
+
+/** ===============================================================================================
+ * \name    packMosaics
+ * 
+ * \brief   Pack the crops with no side above MOSAIC_MAX_CROP into the canvases of the mosaic model.
+ *          A canvas becomes one task with the highest priority of its crops, the crops keep their
+ *          original size.
+ * 
+ * \param   newTasks the slices of the frame, the packed crops are replaced by the canvases
+ * ================================================================================================
+ */
+void 
+CPS_Engine::packMosaics (vector<Inference_Task_t>& newTasks)
+{
+    TRACE_SCOPE("cps", "pack mosaics");
+    vector<int> candidates;
+    vector<cv::Size> sizes;
+    for (int i = 0; i < newTasks.size(); i++)
+    {
+        cv::Mat* crop = (cv::Mat*) newTasks[i].data;
+        if (crop->cols > MOSAIC_MAX_CROP || crop->rows > MOSAIC_MAX_CROP) continue;
+
+        candidates.push_back(i);
+        sizes.push_back(cv::Size(crop->cols, crop->rows));
+    }
+    if (candidates.size() < MOSAIC_MIN_CROPS) return;
+
+    cv::Size canvasSize(mosaicModel->Onnx_inputWidth(), mosaicModel->Onnx_inputHeight());
+    vector<Mosaic_Place_t> places;
+    int canvasNum = MosaicPacker::pack(sizes, canvasSize, MOSAIC_MARGIN, MOSAIC_MAX_CANVAS, &places);
+
+    /* ******************************************
+     * Compose the canvases
+     * ******************************************
+     */
+    vector<int> cropNum(canvasNum, 0);
+    for (auto& place : places)
+    {
+        if (place.canvas >= 0) cropNum[place.canvas]++;
+    }
+
+    vector<Inference_Task_t> canvases(canvasNum, Inference_Task_t{nullptr, 0, mosaicModel});
+    vector<bool> packed(newTasks.size(), false);
+    for (int c = 0; c < candidates.size(); c++)
+    {
+        int canvas = places[c].canvas;
+        if (canvas < 0 || cropNum[canvas] < MOSAIC_MIN_CROPS) continue;
+
+        Inference_Task_t& task = newTasks[candidates[c]];
+        if (!canvases[canvas].data)
+        {
+            canvases[canvas].data = new cv::Mat(canvasSize, mImg.type(), cv::Scalar::all(114));
+        }
+        ((cv::Mat*) task.data)->copyTo((*(cv::Mat*) canvases[canvas].data)(places[c].rect));
+        canvases[canvas].priority = max(canvases[canvas].priority, task.priority);
 
-        } else if((*max_task)->model->spendTime > remaingTime) {
-            (*max_task)->priority = 0;
+        Mosaic_t& mosaic = mosaics[canvases[canvas].data];
+        mosaic.rects.push_back(places[c].rect);
+        mosaic.origins.push_back(taskOrigins[task.data]);
+        mosaic.models.push_back(task.model);
+
+        packed[candidates[c]] = true;
+    }
+
+    /* ******************************************
+     * Replace the packed crops by the canvases
+     * ******************************************
+     */
+    vector<Inference_Task_t> tasks;
+    int packedNum = 0;
+    for (int i = 0; i < newTasks.size(); i++)
+    {
+        if (!packed[i])
+        {
+            tasks.push_back(newTasks[i]);
             continue;
         }
+        delete (cv::Mat*) newTasks[i].data;
+        packedNum++;
+    }
+    for (auto& canvas : canvases)
+    {
+        if (canvas.data) tasks.push_back(canvas);
+    }
 
-        /* Pick task form the queue */
-        for (auto it = taskQueue.begin(); it < taskQueue.end() && !(*max_task)->model->fullyBatch;)
+    log_I("CPS_Engine", "Mosaic: packed " + to_string(packedNum) + " crops, samples: " + to_string(newTasks.size()) + " -> " + to_string(tasks.size()));
+    newTasks.swap(tasks);
+}
+
+
+/** ===============================================================================================
+ * \name    decodeMosaics
+ * 
+ * \brief   Map the detections on the canvases back to the obstacles. A detection belongs to the crop
+ *          containing its center, and its box is moved into the source image. The detections in the
+ *          margins are dropped.
+ * 
+ * \param   batchMosaics the canvases of the batch in the sample order
+ * \param   results the detections of the batch
+ * \param   cache cache the detections of every crop into its track
+ * ================================================================================================
+ */
+void 
+CPS_Engine::decodeMosaics (const vector<Mosaic_t>& batchMosaics, const ResultBuffer& results, bool cache)
+{
+    vector<vector<vector<Inference_Result_t>>> cropResults(batchMosaics.size());
+    for (size_t m = 0; m < batchMosaics.size(); m++) cropResults[m].resize(batchMosaics[m].rects.size());
+
+    for (size_t r = 0; r < results.size(); r++)
+    {
+        const Inference_Result_t& result = results[r];
+        if (result.sampleId >= batchMosaics.size()) continue;
+
+        const Mosaic_t& mosaic = batchMosaics[result.sampleId];
+        int crop = MosaicPacker::locate(mosaic.rects, (result.box[0] + result.box[2]) / 2, (result.box[1] + result.box[3]) / 2);
+        if (crop < 0) continue;
+
+        Inference_Result_t* slot = frameResults.reserve(1);
+        if (!slot) break;
+
+        float dx = mosaic.origins[crop].box.left - mosaic.rects[crop].x;
+        float dy = mosaic.origins[crop].box.top - mosaic.rects[crop].y;
+        *slot = result;
+        slot->box[0] += dx;
+        slot->box[1] += dy;
+        slot->box[2] += dx;
+        slot->box[3] += dy;
+        cropResults[result.sampleId][crop].push_back(*slot);
+    }
+
+    if (!cache) return;
+    for (size_t m = 0; m < batchMosaics.size(); m++)
+    {
+        for (size_t c = 0; c < cropResults[m].size(); c++)
         {
-            Inference_Task_t task = (*it);
+            if (batchMosaics[m].origins[c].trackId >= 0) tracker.store(batchMosaics[m].origins[c].trackId, cropResults[m][c]);
+        }
+    }
+}
+
+
+/** ===============================================================================================
+ * \name    accumulateTasks
+ * 
+ * \brief   Merge the held tasks back into the queue, then hold the partial batch of every model for
+ *          the next frame. The partial batch is held only if none of its tasks is urgent or held for
+ *          BATCH_ACCUMULATE_FRAMES already, and its earliest task still meets its deadline of
+ *          BATCH_DEADLINE_PERIODS after waiting one more frame.
+ * 
+ * \param   frameStart the start time of the frame
+ * ================================================================================================
+ */
+void 
+CPS_Engine::accumulateTasks (timeval frameStart)
+{
+    struct timeval period = {SENSING_PERIOD / 1000, (SENSING_PERIOD % 1000) * 1000};
+    struct timeval nextFrame;
+    timeradd(&frameStart, &period, &nextFrame);
 
-            if((*max_task)->model == task.model)
+    /* ******************************************
+     * Merge the held tasks
+     * ******************************************
+     */
+    vector<Held_Task_t> held;
+    held.swap(heldTasks);
+    map<void*, Held_Task_t*> heldByData;
+    for (auto& task : held)
+    {
+        taskQueue.push(task.task);
+        taskOrigins[task.task.data] = task.origin;
+        heldReleases[task.task.data] = task.release;
+        heldByData[task.task.data] = &task;
+    }
+
+    /* ******************************************
+     * Hold the partial batches
+     * ******************************************
+     */
+    for (auto model : models)
+    {
+        int restNum = taskQueue.size(model) % model->batchLimit;
+        if (restNum == 0) continue;
+
+        vector<Inference_Task_t> tasks;
+        while (taskQueue.size(model) > 0)
+        {
+            tasks.push_back(taskQueue.pop(model));
+        }
+
+        int fullNum = tasks.size() - restNum;
+        bool holdable = true;
+        vector<Held_Task_t> partial;
+        for (int i = fullNum; i < tasks.size() && holdable; i++)
+        {
+            Held_Task_t task = {tasks[i], taskOrigins[tasks[i].data], frameStart, 0};
+            auto it = heldByData.find(tasks[i].data);
+            if (it != heldByData.end())
+            {
+                task.release = it->second->release;
+                task.frames = it->second->frames;
+            }
+
+            struct timeval deadline = task.release;
+            for (int p = 0; p < BATCH_DEADLINE_PERIODS; p++) timeradd(&deadline, &period, &deadline);
+            float slack = (1000000 * (deadline.tv_sec - nextFrame.tv_sec) + (deadline.tv_usec - nextFrame.tv_usec)) * 0.001;
+
+            holdable = task.frames < BATCH_ACCUMULATE_FRAMES && tasks[i].priority < URGENT_TASK_PRIORITY && 
+                       slack >= model->Onnx_estimateLatency(model->batchLimit);
+            task.frames++;
+            partial.push_back(task);
+        }
+
+        int keepNum = holdable ? fullNum : tasks.size();
+        for (int i = 0; i < keepNum; i++)
+        {
+            taskQueue.push(tasks[i]);
+        }
+        if (holdable)
+        {
+            for (auto& task : partial) heldReleases.erase(task.task.data);
+            heldTasks.insert(heldTasks.end(), partial.begin(), partial.end());
+        }
+    }
+
+    log_D("CPS_Engine", "Held tasks: " + to_string(heldTasks.size()));
+}
+
+
+/** ===============================================================================================
+ * \name    carryOverTasks
+ * 
+ * \brief   Keep the unserved tasks for the next frame instead of dropping them. A task expires after
+ *          TASK_EXPIRY_AGE frames. Only the obstacle box is kept, the image is cropped again from
+ *          the next frame.
+ * ================================================================================================
+ */
+void 
+CPS_Engine::carryOverTasks (void)
+{
+    vector<Inference_Task_t> remainingTasks;
+    taskQueue.snapshot(&remainingTasks);
+
+    int expiredNum = 0;
+    carriedTasks.clear();
+    for (auto& task : remainingTasks)
+    {
+        /* a canvas carries its obstacles, they are packed again in the next frame */
+        vector<pair<Task_Origin_t, OnnxModel*>> obstacles;
+        auto mosaic = mosaics.find(task.data);
+        if (mosaic != mosaics.end())
+        {
+            for (int i = 0; i < mosaic->second.origins.size(); i++)
             {
-                (*max_task)->priority -= task.priority;
+                obstacles.push_back(make_pair(mosaic->second.origins[i], mosaic->second.models[i]));
+            }
+        } else {
+            obstacles.push_back(make_pair(taskOrigins[task.data], task.model));
+        }
+        releaseTask(task);
 
-                cv::Mat* img = (cv::Mat*) task.data;
-                vector<float> dataStream(task.model->singleInputSize);
-                task.model->dataPreprocess(task.data, &dataStream);
-                task.model->Onnx_addInput(dataStream);
-                taskQueue.erase(it);
+        for (auto& obstacle : obstacles)
+        {
+            obstacle.first.age++;
+            if (obstacle.first.age > TASK_EXPIRY_AGE)
+            {
+                expiredNum++;
                 continue;
             }
-            it++;
+            carriedTasks.push_back(obstacle);
         }
+    }
 
-        /* Start Inference */
-        (*max_task)->model->Onnx_inference();
+    log_I("CPS_Engine", "Carried tasks: " + to_string(carriedTasks.size()) + ", expired tasks: " + to_string(expiredNum));
+}
 
-    }while(SENSING_PERIOD > spendTime);
-    
-    log_I("CPS_Engine", "Remaining tasks: " + to_string(taskQueue.size()));
-    for(auto task : taskQueue)
+
+/** ===============================================================================================
+ * \name    speculate
+ * 
+ * \brief   Start the inference on the boxes of the tracks projected into the new frame, before the
+ *          lidar points are clustered. The predicted crops are assigned by their shapes and batched
+ *          per model, the batches run on the workers while the engine clusters.
+ * ================================================================================================
+ */
+void 
+CPS_Engine::speculate (void)
+{
+    TRACE_SCOPE("cps", "speculate");
+    struct timeval start, end;
+    gettimeofday(&start, NULL);
+
+    vector<int> trackIds;
+    vector<Track_Box_t> predicted;
+    tracker.predict(&trackIds, &predicted);
+
+    /* ******************************************
+     * Group the predicted boxes by the models
+     * ******************************************
+     */
+    vector<vector<int>> modelSamples(models.size());
+    vector<boundingBox_t> boxes(predicted.size());
+    for (int i = 0; i < predicted.size(); i++)
     {
-        log_D("CPS_Engine", task.model->modelName);
+        boxes[i].left   = max(0.0f, predicted[i].left);
+        boxes[i].top    = max(0.0f, predicted[i].top);
+        boxes[i].right  = min((float)mImg.cols, predicted[i].right);
+        boxes[i].bottom = min((float)mImg.rows, predicted[i].bottom);
+
+        int area = (boxes[i].right - boxes[i].left) * (boxes[i].bottom - boxes[i].top);
+        if (boxes[i].right <= boxes[i].left || boxes[i].bottom <= boxes[i].top || area <= pow(56, 2)) continue;
+        modelSamples[assignShape(boxes[i])].push_back(i);
     }
 
-    taskQueue.clear();
-    taskSetPriorities.clear();
+    /* ******************************************
+     * Submit the batches
+     * ******************************************
+     */
+    speculations.clear();
+    int sampleNum = 0;
+    for (int m = 0; m < models.size(); m++)
+    {
+        OnnxModel* model = models[m];
+        for (int begin = 0; begin < modelSamples[m].size(); begin += model->batchLimit)
+        {
+            int end = min((int)modelSamples[m].size(), begin + model->batchLimit);
+
+            Speculation_t speculation;
+            for (int s = begin; s < end; s++)
+            {
+                const boundingBox_t& box = boxes[modelSamples[m][s]];
+                cv::Mat crop = mImg(cv::Range(box.top, box.bottom), cv::Range(box.left, box.right));
+
+                vector<float> dataStream(model->singleInputSize);
+                model->dataPreprocess(&crop, &dataStream);
+                model->Onnx_addInput(dataStream);
+
+                speculation.trackIds.push_back(trackIds[modelSamples[m][s]]);
+                speculation.boxes.push_back(box);
+            }
+            speculation.accepted.assign(speculation.boxes.size(), false);
+            speculation.results = new ResultBuffer(model->batchLimit * RESULT_TOP_K);
+            speculation.job = executor.submit(model, &frameDeadline, false, speculation.results);
+            speculations.push_back(speculation);
+            sampleNum += end - begin;
+        }
+    }
+    speculatedSamples += sampleNum;
+
+    gettimeofday(&end, NULL);
+    float spendTime = (1000000 * (end.tv_sec - start.tv_sec) + (end.tv_usec - start.tv_usec)) * 0.001;
+    log_I("CPS_Engine", "Speculation: " + to_string(sampleNum) + " samples in " + to_string(speculations.size()) + " batches, spend: " + to_string(spendTime) + " ms");
+}
+
+
+/** ===============================================================================================
+ * \name    acceptSpeculation
+ * 
+ * \brief   Validate the speculative samples against a clustered obstacle. A sample of the same track
+ *          and model, with the predicted box overlapping the obstacle above SPECULATION_IOU, serves
+ *          the obstacle.
+ * 
+ * \param   trackId the track of the obstacle
+ * \param   box the clustered box of the obstacle
+ * \param   model the model assigned to the obstacle
+ * 
+ * \return  true if a sample is accepted, the obstacle needs no task
+ * ================================================================================================
+ */
+bool 
+CPS_Engine::acceptSpeculation (int trackId, const boundingBox_t& box, OnnxModel* model)
+{
+    for (auto& speculation : speculations)
+    {
+        if (speculation.job->model != model) continue;
+
+        for (int i = 0; i < speculation.trackIds.size(); i++)
+        {
+            if (speculation.trackIds[i] != trackId || speculation.accepted[i]) continue;
+            if (boxIoU(speculation.boxes[i], box) < SPECULATION_IOU) return false;
+
+            speculation.accepted[i] = true;
+            return true;
+        }
+    }
+    return false;
+}
+
+
+/** ===============================================================================================
+ * \name    collectSpeculation
+ * 
+ * \brief   Wait for the speculative batches, the results of the accepted samples join the frame and
+ *          the others are dropped
+ * ================================================================================================
+ */
+void 
+CPS_Engine::collectSpeculation (void)
+{
+    TRACE_SCOPE("cps", "collect speculation");
+    int sampleNum = 0, acceptedNum = 0, revokedNum = 0, cancelledNum = 0;
+    float savedTime = 0;
+    for (auto& speculation : speculations)
+    {
+        speculation.job->wait();
+        OnnxModel* model = speculation.job->model;
+        int accepted = count(speculation.accepted.begin(), speculation.accepted.end(), true);
+        sampleNum += speculation.accepted.size();
+
+        if (speculation.job->isRevoked() && accepted == 0)
+        {
+            revokedNum++;
+        } else if (speculation.job->cancelled) {
+            log_W("CPS_Engine", model->modelName + " speculation cancelled by the frame deadline");
+            cancelledNum++;
+        } else {
+            vector<int> trackIds(speculation.trackIds.size(), -1);
+            for (size_t r = 0; r < speculation.results->size(); r++)
+            {
+                const Inference_Result_t& result = (*speculation.results)[r];
+                if (result.sampleId >= speculation.accepted.size() || !speculation.accepted[result.sampleId]) continue;
+
+                Inference_Result_t* slot = frameResults.reserve(1);
+                if (slot) *slot = result;
+            }
+            for (int i = 0; i < speculation.accepted.size(); i++)
+            {
+                if (speculation.accepted[i]) trackIds[i] = speculation.trackIds[i];
+            }
+#if TRACK_RESULT_REUSE
+            cacheResults(trackIds, *speculation.results, 0);
+#endif
+            acceptedNum += accepted;
+            savedTime += accepted * model->Onnx_estimateLatency(model->batchLimit) / model->batchLimit;
+        }
+
+        delete speculation.job;
+        delete speculation.results;
+    }
+    speculations.clear();
+
+    acceptedSamples += acceptedNum;
+    revokedBatches += revokedNum;
+    log_I("CPS_Engine", "Speculation: accepted " + to_string(acceptedNum) + "/" + to_string(sampleNum) + " samples, revoked batches: " + to_string(revokedNum) +
+                        ", cancelled batches: " + to_string(cancelledNum) + ", off the critical path: " + to_string(savedTime) + " ms");
+    log_I("CPS_Engine", "Speculation: accept rate: " + to_string(speculatedSamples ? acceptedSamples * 100.0 / speculatedSamples : 0) + "%, revoked batches: " + 
+                        to_string(revokedBatches));
+}
+
+
+/** ===============================================================================================
+ * \name    assignShape
+ * 
+ * \brief   The model input shape with the closest area to the box
+ * 
+ * \return  the index in imgShapes, also the index of the model
+ * ================================================================================================
+ */
+int 
+CPS_Engine::assignShape (const boundingBox_t& box)
+{
+    int area = (box.right - box.left) * (box.bottom - box.top);
+    int diff_area = INT32_MAX;
+    int shapeId = 0;
+    for (int i = 0; i < imgShapes.size(); i++)
+    {
+        int new_diff = abs(area - (imgShapes[i].first * imgShapes[i].second));
+        if (new_diff < diff_area)
+        {
+            shapeId = i;
+            diff_area = new_diff;
+        }
+    }
+    return shapeId;
+}
+
+
+/** ===============================================================================================
+ * \name    cacheResults
+ * 
+ * \brief   Cache the results of a batch into the tracks of its samples
+ * 
+ * \param   trackIds the track of every sample in the batch order, -1 if not tracked
+ * \param   results the result buffer the batch was written into
+ * \param   begin the first result of the batch in the buffer
+ * ================================================================================================
+ */
+void 
+CPS_Engine::cacheResults (const vector<int>& trackIds, const ResultBuffer& results, size_t begin)
+{
+    vector<vector<Inference_Result_t>> sampleResults(trackIds.size());
+    for (size_t r = begin; r < results.size(); r++)
+    {
+        if (results[r].sampleId < trackIds.size()) sampleResults[results[r].sampleId].push_back(results[r]);
+    }
+
+    for (int i = 0; i < trackIds.size(); i++)
+    {
+        if (trackIds[i] >= 0) tracker.store(trackIds[i], sampleResults[i]);
+    }
+}
+
+
+/** ===============================================================================================
+ * \name    mergeCarriedTasks
+ * 
+ * \brief   Merge the carried tasks into the slices of the new frame. A carried task overlapping a 
+ *          new slice is the same obstacle, the new slice takes the higher priority of them. The
+ *          others are cropped from the new frame with the aged priority.
+ * 
+ * \param   newTasks the slices of the new frame
+ * ================================================================================================
+ */
+void 
+CPS_Engine::mergeCarriedTasks (vector<Inference_Task_t>& newTasks)
+{
+    int sliceNum = newTasks.size();
+    int duplicatedNum = 0;
+
+    for (auto& carried : carriedTasks)
+    {
+        Task_Origin_t& origin = carried.first;
+        float agedPriority = min(1.0f, origin.basePriority + (float)TASK_AGING_RATE * origin.age);
+
+        /* ******************************************
+         * Deduplicate against the new slices
+         * ******************************************
+         */
+        bool duplicated = false;
+        for (int i = 0; i < sliceNum; i++)
+        {
+            if (boxIoU(taskOrigins[newTasks[i].data].box, origin.box) > TASK_DEDUP_IOU)
+            {
+                newTasks[i].priority = max(newTasks[i].priority, agedPriority);
+                duplicated = true;
+                break;
+            }
+        }
+        if (duplicated)
+        {
+            duplicatedNum++;
+            continue;
+        }
+
+        /* ******************************************
+         * Crop the obstacle from the new frame
+         * ******************************************
+         */
+        int top     = max(0, (int)origin.box.top);
+        int bottom  = min(mImg.rows, (int)origin.box.bottom);
+        int left    = max(0, (int)origin.box.left);
+        int right   = min(mImg.cols, (int)origin.box.right);
+        if (bottom <= top || right <= left) continue;
+
+        cv::Mat* croppedImage = new cv::Mat(mImg(cv::Range(top, bottom), cv::Range(left, right)));
+        Inference_Task_t task = {(void*)croppedImage, agedPriority, carried.second};
+        newTasks.push_back(task);
+        taskOrigins[task.data] = origin;
+    }
+
+    log_I("CPS_Engine", "Merged carried tasks: " + to_string(newTasks.size() - sliceNum) + ", duplicated: " + to_string(duplicatedNum));
+    carriedTasks.clear();
+}
 
-}
\ No newline at end of file
@@ -16,9 +16,24 @@
  * \param   SE a SensingEngine as the input source
  * ================================================================================================
  */
-InferenceEngine::InferenceEngine(SensingEngine* SE) : mSE(SE)
+InferenceEngine::InferenceEngine(SensingEngine* SE) : mSE(SE), dispatcher(&executor), sensedFrameId(-1)
 {
-    
+    pthread_mutex_init(&engineMutex, NULL);
+    pthread_mutex_init(&frameMutex, NULL);
+}
+
+
+/** ===============================================================================================
+ * \name    ~InferenceEngine
+ * 
+ * \brief   Stop the engine and release its models
+ * ================================================================================================
+ */
+InferenceEngine::~InferenceEngine (void)
+{
+    stop();
+    pthread_mutex_destroy(&engineMutex);
+    pthread_mutex_destroy(&frameMutex);
 }
 
 
@@ -30,27 +45,168 @@ InferenceEngine::InferenceEngine(SensingEngine* SE) : mSE(SE)
  */
 void
 InferenceEngine::run (void)
+{
+    /* The threads created from here inherit the engine cores */
+    CpuPlan::pinThread(CPU_ROLE_ENGINE);
+
+    /* Start the long-lived inference workers */
+    for (auto model: models)
+    {
+        executor.addModel(model);
+        taskQueue.addModel(model);
+    }
+
+#if STAGED_PIPELINE
+    runStaged();
+#elif PIPELINED_EXECUTION
+    runPipelined();
+#else
+    runSequential();
+#endif
+
+    stop();
+}
+
+
+/** ===============================================================================================
+ * \name    runSequential
+ * 
+ * \brief   Sync, schedule and inference the frames one by one
+ * ================================================================================================
+ */
+void
+InferenceEngine::runSequential (void)
 {
     struct timeval start, end;
     for (int frameId = 0; frameId < FRAME_NUM; frameId++)
     {
         log_I("main", "Start frame: " + to_string(frameId) + "-----------------");
+        TRACE_SCOPE_ARG("engine", "frame", frameId);
 
         gettimeofday(&start, NULL);
+        struct timeval period = {SENSING_PERIOD / 1000, (SENSING_PERIOD % 1000) * 1000};
+        timeradd(&start, &period, &frameDeadline);
+        frameResults.clear();
 
-            onSyncData();
+            if (!onSyncData()) break;
 
             Inference_sched();
 
+#if OVERLOAD_CONTROL
+            controlOverload();
+#endif
+
             onInference(start);
 
         gettimeofday(&end, NULL);
+#if OVERLOAD_CONTROL
+        overload.frameFinished(captureTime);
+#endif
 
         float spendTime = (1000000 * (end.tv_sec - start.tv_sec) + (end.tv_usec - start.tv_usec)) * 0.001;
         log_I("InferenceEngine", "Inference spend: " + to_string(spendTime) + " ms");
+        TRACE_COUNTER("engine", "frame latency us", spendTime * 1000);
+
+#if LOG_RESULTS
+        for (auto model: models)
+        {
+            model->logResults(frameResults);
+        }
+#endif
     }
 
-    stop();
+#if OVERLOAD_CONTROL
+    overload.report();
+#endif
+}
+
+
+/** ===============================================================================================
+ * \name    runPipelined
+ * 
+ * \brief   Release a frame every SENSING_PERIOD without waiting for the inference of the previous
+ *          frames. The scheduled tasks are handed to the EDF dispatcher, the onInference policy of 
+ *          the engine is bypassed.
+ * ================================================================================================
+ */
+void
+InferenceEngine::runPipelined (void)
+{
+    for (auto model: models)
+    {
+        dispatcher.addModel(model);
+    }
+    dispatcher.start();
+
+    struct timeval release, next, now;
+    struct timeval period = {SENSING_PERIOD / 1000, (SENSING_PERIOD % 1000) * 1000};
+    vector<Inference_Task_t> tasks;
+
+    gettimeofday(&release, NULL);
+    for (int frameId = 0; frameId < FRAME_NUM; frameId++)
+    {
+        log_I("main", "Release frame: " + to_string(frameId) + "-----------------");
+        TRACE_INSTANT("engine", "release", frameId);
+
+            if (!onSyncData()) break;
+
+            Inference_sched();
+
+        taskQueue.snapshot(&tasks);
+        taskQueue.clear();
+        dispatcher.submitFrame(frameId, release, tasks);
+
+        /* sleep until the next release */
+        timeradd(&release, &period, &next);
+        release = next;
+        gettimeofday(&now, NULL);
+        if (timercmp(&now, &release, <))
+        {
+            struct timeval sleepTime;
+            timersub(&release, &now, &sleepTime);
+            usleep(sleepTime.tv_sec * 1000000 + sleepTime.tv_usec);
+        } else {
+            log_W("InferenceEngine", "Frame " + to_string(frameId) + " overruns the release of the next frame");
+            TRACE_INSTANT("engine", "overrun", frameId);
+            release = now;
+        }
+    }
+
+    dispatcher.stop();
+    dispatcher.report();
+}
+
+
+/** ===============================================================================================
+ * \name    runStaged
+ * 
+ * \brief   Run every step as a pipeline stage, the frames flow through the stages concurrently:
+ *          sync -> slice -> sched -> preprocess -> inference -> decode. The onInference policy of the
+ *          engine is bypassed, every model's tasks are batched in priority order.
+ * ================================================================================================
+ */
+void
+InferenceEngine::runStaged (void)
+{
+    Pipeline pipeline;
+    pipeline.addStage("sync",       InferenceEngine::stageSync,         this, 1);
+    pipeline.addStage("slice",      InferenceEngine::stageSlice,        this, 1);
+    pipeline.addStage("sched",      InferenceEngine::stageSched,        this, 1);
+    pipeline.addStage("preprocess", InferenceEngine::stagePreprocess,   this, STAGE_PREPROCESS_THREADS);
+    pipeline.addStage("inference",  InferenceEngine::stageInference,    this, STAGE_INFERENCE_THREADS);
+    pipeline.addStage("decode",     InferenceEngine::stageDecode,       this, STAGE_DECODE_THREADS);
+    pipeline.start();
+
+    for (int frameId = 0; frameId < FRAME_NUM; frameId++)
+    {
+        Frame_Context_t* frame = new Frame_Context_t();
+        frame->frameId = frameId;
+        frame->results = new ResultBuffer();
+        pipeline.push(frame);
+    }
+
+    pipeline.stop();
+    pipeline.report();
 }
 
 
@@ -63,11 +219,14 @@ InferenceEngine::run (void)
 void
 InferenceEngine::stop (void)
 {
+    executor.stop();
+
+    /* stopped once, the models are released */
     for(auto model: models)
     {
-        model->~OnnxModel();
+        ModelPool::release(model);
     }
-
+    models.clear();
 }
 
 
@@ -75,25 +234,85 @@ InferenceEngine::stop (void)
  * \name    onSyncData
  * 
  * \brief   Load the data from the SensingEngine, and enable next sensing cycle.
+ * 
+ * \return  false if the sensing is finished without new data
  * ================================================================================================
  */
-void 
+bool 
 InferenceEngine::onSyncData (void)
 {    
+    if (!readSensing(&mImg, &mLidarPoints)) return false;
+
+    dataPreprocessor();
+    return true;
+}
+
+
+/** ===============================================================================================
+ * \name    readSensing
+ * 
+ * \brief   Wait for the SensingEngine, copy out the data and enable next sensing cycle.
+ * 
+ * \param   img the camera image
+ * \param   lidarPoints the lidar ranging points
+ * 
+ * \return  false if the sensing is finished without new data
+ * ================================================================================================
+ */
+bool 
+InferenceEngine::readSensing (cv::Mat* img, vector<pair<pair<int, int>, float>>* lidarPoints)
+{
+    TRACE_SCOPE("engine", "sync");
     struct timeval start, end;
     gettimeofday(&start, NULL);
-        while(!mSE->readyToSync());
-        mImg = mSE->getCameraData();
-        mLidarPoints.clear();
-        mLidarPoints = mSE->getLidarData();
-        log_D("onSyncData", "Image width: " + to_string(mImg.cols) + ", Image height: " + to_string(mImg.rows));
-        log_D("onSyncData", "Lidar count: " + to_string(mLidarPoints.size()));
-        mSE->startNextSensing();
+        while(!mSE->readyToSync())
+        {
+            /* the last frame is set ready before the sensing finishes */
+            if (mSE->finished() && !mSE->readyToSync()) return false;
+        }
+        mSE->takeData(img, lidarPoints, &captureTime, &sensedFrameId);
+        log_D("onSyncData", "Image width: " + to_string(img->cols) + ", Image height: " + to_string(img->rows));
+        log_D("onSyncData", "Lidar count: " + to_string(lidarPoints->size()));
+#if OVERLOAD_CONTROL
+        overload.frameSynced(sensedFrameId);
+#endif
     gettimeofday(&end, NULL);
     float spendTime = (1000000 * (end.tv_sec - start.tv_sec) + (end.tv_usec - start.tv_usec)) * 0.001;
     log_I("InferenceEngine", "Data sync spend: " + to_string(spendTime) + " ms");
+    return true;
+}
 
-    dataPreprocessor();
+
+/** ===============================================================================================
+ * \name    controlOverload
+ * 
+ * \brief   Under overload, move the tasks onto the fastest model and shed the lowest priority tasks
+ *          beyond the remaining time of the frame by OVERLOAD_POLICY
+ * ================================================================================================
+ */
+void 
+InferenceEngine::controlOverload (void)
+{
+    if (!overload.overloaded()) return;
+
+    vector<Inference_Task_t> shed;
+    int downgradedNum = 0;
+#if OVERLOAD_POLICY & OVERLOAD_DOWNGRADE
+    downgradedNum = overload.downgradeTasks(&taskQueue, models, &shed);
+#endif
+#if OVERLOAD_POLICY & OVERLOAD_SHED
+    struct timeval now;
+    gettimeofday(&now, NULL);
+    float budget = (1000000 * (frameDeadline.tv_sec - now.tv_sec) + (frameDeadline.tv_usec - now.tv_usec)) * 0.001;
+    overload.shedTasks(&taskQueue, models, budget, &shed);
+#endif
+
+    for (auto& task : shed)
+    {
+        releaseTask(task);
+    }
+    log_W("InferenceEngine", "Overload: downgraded tasks: " + to_string(downgradedNum) + ", shed tasks: " + to_string(shed.size()));
+    TRACE_INSTANT("engine", "overload", shed.size());
 }
 
 
@@ -150,20 +369,269 @@ InferenceEngine::onInference (timeval frameStart)
 
 
 /** ===============================================================================================
- * \name    threadInference
+ * \name    postprocess
  * 
- * \brief   Inference model in thread
+ * \brief   Process the decoded results of a finished frame
  * 
- * \param   arg the pointer of the OnnxModel going to inference
+ * \param   results the decoded results of the frame
+ * \param   img the source image of the frame
  * ================================================================================================
  */
-void* 
-InferenceEngine::threadInference (void* arg)
+void 
+InferenceEngine::postprocess (const ResultBuffer& results, const cv::Mat& img)
 {
-    OnnxModel* model = (OnnxModel*) arg;
 
-    log_I(model->modelName, "ThreadInference start");
-    model->Onnx_inference();
+}
+
 
-    pthread_exit(nullptr);
-}
\ No newline at end of file
+/** ===============================================================================================
+ * \name    releaseTask
+ * 
+ * \brief   Release the data of a task dropped without inference
+ * ================================================================================================
+ */
+void 
+InferenceEngine::releaseTask (const Inference_Task_t& task)
+{
+
+}
+
+
+/** ===============================================================================================
+ * \name    stageSync
+ * 
+ * \brief   The sync stage, read the sensing data into the frame and release the frame
+ * ================================================================================================
+ */
+void 
+InferenceEngine::stageSync (void* item, Pipeline* pipeline, int stageId, void* arg)
+{
+    InferenceEngine* engine = (InferenceEngine*) arg;
+    Frame_Context_t* frame = (Frame_Context_t*) item;
+    TRACE_SCOPE_ARG("pipeline", "stage sync", frame->frameId);
+
+    if (!engine->readSensing(&frame->img, &frame->lidarPoints))
+    {
+        delete frame->results;
+        delete frame;
+        return;
+    }
+
+    int relativeDeadline = SENSING_PERIOD * PIPELINE_DEADLINE_PERIODS;
+    struct timeval period = {relativeDeadline / 1000, (relativeDeadline % 1000) * 1000};
+    gettimeofday(&frame->release, NULL);
+    timeradd(&frame->release, &period, &frame->deadline);
+
+    pipeline->emit(stageId, frame);
+}
+
+
+/** ===============================================================================================
+ * \name    stageSlice
+ * 
+ * \brief   The slicing stage, run the dataPreprocessor of the engine on the frame
+ * ================================================================================================
+ */
+void 
+InferenceEngine::stageSlice (void* item, Pipeline* pipeline, int stageId, void* arg)
+{
+    InferenceEngine* engine = (InferenceEngine*) arg;
+    Frame_Context_t* frame = (Frame_Context_t*) item;
+    TRACE_SCOPE_ARG("pipeline", "stage slice", frame->frameId);
+
+    pthread_mutex_lock(&engine->engineMutex);
+        engine->frameDeadline = frame->deadline;
+        engine->mImg = frame->img;
+        engine->mLidarPoints = frame->lidarPoints;
+        engine->dataPreprocessor();
+
+        engine->taskQueue.snapshot(&frame->tasks);
+        engine->taskQueue.clear();
+    pthread_mutex_unlock(&engine->engineMutex);
+
+    /* the tasks on the whole image point to the engine's image, which is replaced by the next frame */
+    for (auto& task : frame->tasks)
+    {
+        if (task.data == (void*)&engine->mImg) task.data = (void*)&frame->img;
+    }
+
+    pipeline->emit(stageId, frame);
+}
+
+
+/** ===============================================================================================
+ * \name    stageSched
+ * 
+ * \brief   The scheduling stage, run the Inference_sched of the engine and split the tasks into 
+ *          batches of each model in priority order
+ * ================================================================================================
+ */
+void 
+InferenceEngine::stageSched (void* item, Pipeline* pipeline, int stageId, void* arg)
+{
+    InferenceEngine* engine = (InferenceEngine*) arg;
+    Frame_Context_t* frame = (Frame_Context_t*) item;
+    TRACE_SCOPE_ARG("pipeline", "stage sched", frame->frameId);
+
+    vector<Batch_Context_t*> batches;
+    pthread_mutex_lock(&engine->engineMutex);
+        /* the frames overlap, the scheduler budgets by the deadline of this one */
+        engine->frameDeadline = frame->deadline;
+        for (auto& task : frame->tasks)
+        {
+            engine->taskQueue.push(task);
+        }
+        engine->Inference_sched();
+
+        for (auto model : engine->models)
+        {
+            while (engine->taskQueue.size(model) > 0)
+            {
+                Batch_Context_t* batch = new Batch_Context_t();
+                batch->frame = frame;
+                batch->model = model;
+                while (batch->tasks.size() < model->batchLimit && engine->taskQueue.size(model) > 0)
+                {
+                    batch->tasks.push_back(engine->taskQueue.pop(model));
+                }
+                batches.push_back(batch);
+            }
+        }
+        engine->taskQueue.clear();
+    pthread_mutex_unlock(&engine->engineMutex);
+
+    log_D("InferenceEngine", "Frame " + to_string(frame->frameId) + " batches: " + to_string(batches.size()));
+
+    /* count before emitting, the batches could finish before the loop ends */
+    frame->pendingBatches = batches.size();
+    frame->cancelledBatches = 0;
+    if (batches.empty())
+    {
+        engine->finishFrame(frame);
+        return;
+    }
+
+    for (auto batch : batches)
+    {
+        pipeline->emit(stageId, batch);
+    }
+}
+
+
+/** ===============================================================================================
+ * \name    stagePreprocess
+ * 
+ * \brief   The preprocess stage, preprocess the tasks of a batch into the model input
+ * ================================================================================================
+ */
+void 
+InferenceEngine::stagePreprocess (void* item, Pipeline* pipeline, int stageId, void* arg)
+{
+    Batch_Context_t* batch = (Batch_Context_t*) item;
+    OnnxModel* model = batch->model;
+    TRACE_SCOPE_ARG("pipeline", "stage preprocess", batch->frame->frameId);
+
+    vector<float> dataStream(model->singleInputSize);
+    batch->inputs.reserve(batch->tasks.size() * model->singleInputSize);
+    for (auto& task : batch->tasks)
+    {
+        model->dataPreprocess(task.data, &dataStream);
+        batch->inputs.insert(batch->inputs.end(), dataStream.begin(), dataStream.end());
+    }
+
+    pipeline->emit(stageId, batch);
+}
+
+
+/** ===============================================================================================
+ * \name    stageInference
+ * 
+ * \brief   The inference stage, run the batch before the frame deadline and keep the outputs for 
+ *          the decode stage
+ * ================================================================================================
+ */
+void 
+InferenceEngine::stageInference (void* item, Pipeline* pipeline, int stageId, void* arg)
+{
+    Batch_Context_t* batch = (Batch_Context_t*) item;
+    TRACE_SCOPE_ARG("pipeline", "stage inference", batch->frame->frameId);
+
+    batch->progress.nextSegment = 0;
+    batch->progress.preempted   = false;
+    batch->progress.keepOutputs = true;
+    batch->progress.shouldYield = nullptr;
+    batch->progress.yieldArg    = nullptr;
+
+    float spendTime = batch->model->Onnx_inference(batch->inputs, &batch->frame->deadline, &batch->cancelled, &batch->progress);
+    if (!batch->cancelled) batch->model->spendTime = spendTime;
+
+    pipeline->emit(stageId, batch);
+}
+
+
+/** ===============================================================================================
+ * \name    stageDecode
+ * 
+ * \brief   The decode stage, decode the outputs into the frame results, finish the frame with its
+ *          last batch
+ * ================================================================================================
+ */
+void 
+InferenceEngine::stageDecode (void* item, Pipeline* pipeline, int stageId, void* arg)
+{
+    InferenceEngine* engine = (InferenceEngine*) arg;
+    Batch_Context_t* batch = (Batch_Context_t*) item;
+    Frame_Context_t* frame = batch->frame;
+    TRACE_SCOPE_ARG("pipeline", "stage decode", frame->frameId);
+
+    if (batch->cancelled)
+    {
+        frame->cancelledBatches++;
+    } else {
+        batch->model->Onnx_decode(batch->progress.values, frame->results, batch->progress.sampleNum);
+    }
+
+    /* the crops of the batch are done, the tasks on the whole image share the frame's image */
+    pthread_mutex_lock(&engine->engineMutex);
+        for (auto& task : batch->tasks)
+        {
+            if (task.data != (void*)&frame->img) engine->releaseTask(task);
+        }
+    pthread_mutex_unlock(&engine->engineMutex);
+    delete batch;
+
+    if (--frame->pendingBatches == 0) engine->finishFrame(frame);
+}
+
+
+/** ===============================================================================================
+ * \name    finishFrame
+ * 
+ * \brief   Report and release a frame of the staged pipeline
+ * ================================================================================================
+ */
+void 
+InferenceEngine::finishFrame (Frame_Context_t* frame)
+{
+    struct timeval now;
+    gettimeofday(&now, NULL);
+    float latency = (1000000 * (now.tv_sec - frame->release.tv_sec) + (now.tv_usec - frame->release.tv_usec)) * 0.001;
+    TRACE_COUNTER("engine", "frame latency us", latency * 1000);
+
+    pthread_mutex_lock(&frameMutex);
+        log_I("InferenceEngine", "Frame " + to_string(frame->frameId) + ": tasks " + to_string(frame->tasks.size()) +
+                                 ", cancelled batches " + to_string(frame->cancelledBatches.load()) +
+                                 ", latency " + to_string(latency) + " ms");
+
+        postprocess(*frame->results, frame->img);
+#if LOG_RESULTS
+        for (auto model: models)
+        {
+            model->logResults(*frame->results);
+        }
+#endif
+    pthread_mutex_unlock(&frameMutex);
+
+    delete frame->results;
+    delete frame;
+}
@@ -0,0 +1,353 @@
+/**
+ * \name    MultiStreamEngine.cpp
+ *
+ * \brief   Implement the API
+ *
+ * \date    Oct 18, 2026
+ */
+
+#include "include/InferenceEngine.hpp"
+
+/** ===============================================================================================
+ * \name    MultiStreamEngine
+ *
+ * \brief   Construct an engine without streams
+ * ================================================================================================
+ */
+MultiStreamEngine::MultiStreamEngine (void) : firstStream(0)
+{
+
+}
+
+
+/** ===============================================================================================
+ * \name    ~MultiStreamEngine
+ *
+ * \brief   Delete the engines of the streams
+ * ================================================================================================
+ */
+MultiStreamEngine::~MultiStreamEngine (void)
+{
+    executor.stop();
+    for (auto& stream : streams)
+    {
+        delete stream.engine;
+    }
+}
+
+
+/** ===============================================================================================
+ * \name    addStream
+ *
+ * \brief   Attach an engine with its SensingEngine as a stream, its models are taken from the
+ *          ModelPool so the streams share them
+ *
+ * \param   engine the engine of the stream, not run by itself, deleted by the MultiStreamEngine
+ * ================================================================================================
+ */
+void
+MultiStreamEngine::addStream (InferenceEngine* engine)
+{
+    Stream_t stream = {};
+    stream.engine = engine;
+    stream.active = true;
+    streams.push_back(stream);
+
+    for (auto model : engine->models)
+    {
+        engine->taskQueue.addModel(model);
+        if (find(models.begin(), models.end(), model) == models.end()) models.push_back(model);
+    }
+}
+
+
+/** ===============================================================================================
+ * \name    run
+ *
+ * \brief   Sync all streams, inference their tasks together and finish them frame by frame
+ * ================================================================================================
+ */
+void
+MultiStreamEngine::run (void)
+{
+    CpuPlan::pinThread(CPU_ROLE_ENGINE);
+    for (auto model : models)
+    {
+        executor.addModel(model);
+    }
+
+    struct timeval runStart, start, end;
+    gettimeofday(&runStart, NULL);
+    for (int frameId = 0; frameId < FRAME_NUM; frameId++)
+    {
+        log_I("main", "Start frame: " + to_string(frameId) + " of " + to_string(streams.size()) + " streams -----------------");
+
+        gettimeofday(&start, NULL);
+            if (!syncStreams()) break;
+
+            inferenceStreams(start);
+
+            finishStreams();
+        gettimeofday(&end, NULL);
+
+        float spendTime = (1000000 * (end.tv_sec - start.tv_sec) + (end.tv_usec - start.tv_usec)) * 0.001;
+        log_I("MultiStreamEngine", "Inference spend: " + to_string(spendTime) + " ms");
+    }
+    gettimeofday(&end, NULL);
+    report((1000000 * (end.tv_sec - runStart.tv_sec) + (end.tv_usec - runStart.tv_usec)) * 0.001);
+
+    executor.stop();
+    for (auto batch : batchResults)
+    {
+        delete batch;
+    }
+    for (auto& stream : streams)
+    {
+        stream.engine->stop();
+    }
+}
+
+
+/** ===============================================================================================
+ * \name    syncStreams
+ *
+ * \brief   Sync and slice the next frame of every active stream
+ *
+ * \return  false if all streams are finished
+ * ================================================================================================
+ */
+bool
+MultiStreamEngine::syncStreams (void)
+{
+    TRACE_SCOPE("streams", "sync");
+    bool anyActive = false;
+    for (auto& stream : streams)
+    {
+        if (!stream.active) continue;
+
+        InferenceEngine* engine = stream.engine;
+        engine->frameResults.clear();
+        if (!engine->onSyncData())
+        {
+            stream.active = false;
+            continue;
+        }
+
+        /* the stream deadline follows its own capture */
+        struct timeval period = {SENSING_PERIOD / 1000, (SENSING_PERIOD % 1000) * 1000};
+        timeradd(&engine->captureTime, &period, &stream.deadline);
+        engine->frameDeadline = stream.deadline;
+
+        engine->Inference_sched();
+
+        engine->taskQueue.snapshot(&stream.tasks);
+        engine->taskQueue.clear();
+        sort(stream.tasks.begin(), stream.tasks.end(), [](const Inference_Task_t& x, const Inference_Task_t& y) {return x.priority > y.priority;});
+
+        stream.missNum = 0;
+        stream.taskNum += stream.tasks.size();
+        anyActive = true;
+    }
+    return anyActive;
+}
+
+
+/** ===============================================================================================
+ * \name    inferenceStreams
+ *
+ * \brief   Admit the tasks of the streams round-robin, the i-th most priority task of every stream
+ *          before the (i+1)-th of any, starting from a stream rotated every frame. A task is admitted
+ *          if the batches of its model still fit the remaining time, the models run in parallel on
+ *          their own workers. The admitted tasks of a model are batched across the streams.
+ *
+ * \param   frameStart the start time of the frame
+ * ================================================================================================
+ */
+void
+MultiStreamEngine::inferenceStreams (timeval frameStart)
+{
+    TRACE_SCOPE("streams", "inference");
+    struct timeval now;
+    gettimeofday(&now, NULL);
+    float budget = SENSING_PERIOD - (1000000 * (now.tv_sec - frameStart.tv_sec) + (now.tv_usec - frameStart.tv_usec)) * 0.001;
+
+    /* ******************************************
+     * Fair admission
+     * ******************************************
+     */
+    vector<vector<pair<int, Inference_Task_t>>> admitted(models.size());
+    vector<float> modelCost(models.size(), 0);
+
+    size_t maxTasks = 0;
+    for (auto& stream : streams) maxTasks = max(maxTasks, stream.tasks.size());
+
+    for (size_t rank = 0; rank < maxTasks; rank++)
+    {
+        for (size_t k = 0; k < streams.size(); k++)
+        {
+            int s = (firstStream + k) % streams.size();
+            Stream_t& stream = streams[s];
+            if (!stream.active || rank >= stream.tasks.size()) continue;
+
+            Inference_Task_t& task = stream.tasks[rank];
+            int m = find(models.begin(), models.end(), task.model) - models.begin();
+            float batchCost = (admitted[m].size() % task.model->batchLimit == 0) ? task.model->Onnx_estimateLatency(task.model->batchLimit) : 0;
+
+            if (modelCost[m] + batchCost > budget)
+            {
+                stream.shedNum++;
+                stream.missNum++;
+                stream.engine->releaseTask(task);
+                continue;
+            }
+            modelCost[m] += batchCost;
+            admitted[m].push_back(make_pair(s, task));
+        }
+    }
+    firstStream = streams.empty() ? 0 : (firstStream + 1) % streams.size();
+
+    /* ******************************************
+     * Batch across the streams
+     * ******************************************
+     */
+    vector<Stream_Batch_t> batches;
+    for (int m = 0; m < models.size(); m++)
+    {
+        OnnxModel* model = models[m];
+        for (size_t begin = 0; begin < admitted[m].size(); begin += model->batchLimit)
+        {
+            size_t end = min(admitted[m].size(), begin + model->batchLimit);
+
+            Stream_Batch_t batch;
+            timeval deadline = streams[admitted[m][begin].first].deadline;
+            bool urgent = false;
+            for (size_t i = begin; i < end; i++)
+            {
+                int s = admitted[m][i].first;
+                Inference_Task_t& task = admitted[m][i].second;
+
+                vector<float> dataStream(model->singleInputSize);
+                model->dataPreprocess(task.data, &dataStream);
+                model->Onnx_addInput(dataStream);
+                streams[s].engine->releaseTask(task);
+
+                batch.streamIds.push_back(s);
+                urgent |= task.priority >= URGENT_TASK_PRIORITY;
+                if (timercmp(&streams[s].deadline, &deadline, <)) deadline = streams[s].deadline;
+            }
+
+            if (batches.size() == batchResults.size()) batchResults.push_back(new ResultBuffer());
+            batch.results = batchResults[batches.size()];
+            batch.results->clear();
+            batch.job = executor.submit(model, &deadline, urgent, batch.results);
+            batches.push_back(batch);
+        }
+    }
+
+    /* ******************************************
+     * Account the samples into their streams
+     * ******************************************
+     */
+    for (auto& batch : batches)
+    {
+        batch.job->wait();
+        gettimeofday(&now, NULL);
+
+        for (auto s : batch.streamIds)
+        {
+            if (batch.job->cancelled || timercmp(&now, &streams[s].deadline, >))
+            {
+                streams[s].missNum++;
+            } else {
+                streams[s].doneNum++;
+            }
+        }
+
+        for (size_t r = 0; r < batch.results->size(); r++)
+        {
+            const Inference_Result_t& result = (*batch.results)[r];
+            Inference_Result_t* slot = streams[batch.streamIds[result.sampleId]].engine->frameResults.reserve(1);
+            if (slot) *slot = result;
+        }
+
+        if (batch.job->cancelled)
+        {
+            log_W("MultiStreamEngine", batch.job->model->modelName + " cancelled by the deadline");
+        }
+        delete batch.job;
+    }
+}
+
+
+/** ===============================================================================================
+ * \name    finishStreams
+ *
+ * \brief   Postprocess the frame of every stream and account its deadline
+ * ================================================================================================
+ */
+void
+MultiStreamEngine::finishStreams (void)
+{
+    TRACE_SCOPE("streams", "finish");
+    struct timeval now;
+    gettimeofday(&now, NULL);
+
+    for (int s = 0; s < streams.size(); s++)
+    {
+        Stream_t& stream = streams[s];
+        if (!stream.active) continue;
+
+        InferenceEngine* engine = stream.engine;
+        engine->postprocess(engine->frameResults, engine->mImg);
+#if LOG_RESULTS
+        for (auto model : engine->models)
+        {
+            model->logResults(engine->frameResults);
+        }
+#endif
+
+        float responseTime = (1000000 * (now.tv_sec - engine->captureTime.tv_sec) + (now.tv_usec - engine->captureTime.tv_usec)) * 0.001;
+        stream.frameNum++;
+        stream.responseSum += responseTime;
+        if (stream.missNum == 0) stream.frameMet++;
+
+        log_I("MultiStreamEngine", "Stream " + to_string(s) + ": tasks: " + to_string(stream.tasks.size()) +
+                                   ", misses: " + to_string(stream.missNum) + ", response: " + to_string(responseTime) + " ms");
+    }
+}
+
+
+/** ===============================================================================================
+ * \name    report
+ *
+ * \brief   Log the deadline accounting of every stream and the aggregate throughput
+ *
+ * \param   elapsedTime the run time in ms
+ * ================================================================================================
+ */
+void
+MultiStreamEngine::report (float elapsedTime)
+{
+    int frameNum = 0, doneNum = 0;
+    log_I("MultiStreamEngine", "Stream, frames, deadline met, tasks, done, shed, average response (ms)");
+    for (int s = 0; s < streams.size(); s++)
+    {
+        Stream_t& stream = streams[s];
+        frameNum += stream.frameNum;
+        doneNum += stream.doneNum;
+
+        string logInfo;
+        logInfo  = to_string(s) + ", ";
+        logInfo += to_string(stream.frameNum) + ", ";
+        logInfo += to_string(stream.frameMet) + ", ";
+        logInfo += to_string(stream.taskNum) + ", ";
+        logInfo += to_string(stream.doneNum) + ", ";
+        logInfo += to_string(stream.shedNum) + ", ";
+        logInfo += to_string(stream.frameNum ? stream.responseSum / stream.frameNum : 0);
+        log_I("MultiStreamEngine", logInfo);
+    }
+
+    if (elapsedTime <= 0) return;
+    log_I("MultiStreamEngine", "Throughput: " + to_string(frameNum * 1000 / elapsedTime) + " frames/s, " +
+                               to_string(doneNum * 1000 / elapsedTime) + " tasks/s");
+}
@@ -16,7 +16,8 @@
  * \param   SE a SensingEngine as the input source
  * ================================================================================================
  */
-SGE_Engine::SGE_Engine(SensingEngine* SE) : InferenceEngine(SE)
+SGE_Engine::SGE_Engine(SensingEngine* SE) : InferenceEngine(SE), frameSkipped(false), diffFrames(0), skippedFrames(0), regionFrames(0), framesSinceFull(0),
+                                           diffSavedSum(0), contentionFactor(1), scheduledLatency(0), predictedTime(0), fixedLatencySum(0), cascadeLatencySum(0)
 {
     registerModels();
 }
@@ -33,19 +34,19 @@ SGE_Engine::registerModels (void)
 {
 #if MODEL_MASK & YOLONET_256_256
     log_D("SGE_Engine", "Create model: yolov7-tiny_256_256");
-    models.emplace_back(new OnnxYoloNet("yolov7-tiny_256_256", 4));
+    models.emplace_back(ModelPool::acquire<OnnxYoloNet>("yolov7-tiny_256_256", 4));
 #endif
 #if MODEL_MASK & YOLONET_384_384
     log_D("SGE_Engine", "Create model: yolov7-tiny_384_384");
-    models.emplace_back(new OnnxYoloNet("yolov7-tiny_384_384", 4));
+    models.emplace_back(ModelPool::acquire<OnnxYoloNet>("yolov7-tiny_384_384", 4));
 #endif
 #if MODEL_MASK & YOLONET_512_512
     log_D("SGE_Engine", "Create model: yolov7-tiny_512_512");
-    models.emplace_back(new OnnxYoloNet("yolov7-tiny_512_512", 4));
+    models.emplace_back(ModelPool::acquire<OnnxYoloNet>("yolov7-tiny_512_512", 4));
 #endif
 #if MODEL_MASK & YOLONET_640_640
     log_D("SGE_Engine", "Create model: yolov7-tiny_640_640");
-    models.emplace_back(new OnnxYoloNet("yolov7-tiny_640_640", 4));
+    models.emplace_back(ModelPool::acquire<OnnxYoloNet>("yolov7-tiny_640_640", 4));
 #endif
 }
 
@@ -59,11 +60,17 @@ SGE_Engine::registerModels (void)
 void 
 SGE_Engine::dataPreprocessor(void)
 {
+    TRACE_SCOPE("sge", "slice");
     log_D("SGE_Engine", "dataPreprocessor");
-    for(auto model : models)
+    void* data = (void*)&mImg;
+    vector<OnnxModel*> frameModels = models;
+#if FRAME_DIFFERENCING && !STAGED_PIPELINE && !PIPELINED_EXECUTION
+    data = differenceFrame(&frameModels);
+#endif
+    for(auto model : frameModels)
     {
-        Inference_Task_t task = {(void*)&mImg, -1, model};
-        taskQueue.emplace_back(task);
+        Inference_Task_t task = {data, -1, model};
+        taskQueue.push(task);
     }
 }
 
@@ -71,13 +78,96 @@ SGE_Engine::dataPreprocessor(void)
 /** ===============================================================================================
  * \name    Inference_sched
  * 
- * \brief   Schedule the input datas into prioritied task
+ * \brief   Select the resolutions fitting the remaining time of the frame. The latency of every
+ *          resolution is its profiled latency scaled by the contention factor, and its value is
+ *          its input area relative to the largest one. SGE_SCHED_SUBSET keeps the most valuable
+ *          subset, SGE_SCHED_SINGLE the most valuable one. The fastest resolution is kept if none
+ *          fits.
  * ================================================================================================
  */
 void 
 SGE_Engine::Inference_sched (void)
 {
+    TRACE_SCOPE("sge", "sched");
+    vector<Inference_Task_t> tasks;
+    taskQueue.snapshot(&tasks);
+    scheduledLatency = 0;
+    predictedTime = 0;
+    if (tasks.empty()) return;
+
+#if SGE_SCHED_POLICY == SGE_SCHED_ALL || SGE_SCHED_POLICY == SGE_SCHED_CASCADE
+    for (auto& task : tasks)
+    {
+        scheduledLatency += task.model->Onnx_estimateLatency(1);
+    }
+    predictedTime = scheduledLatency * contentionFactor;
+#else
+    /* ******************************************
+     * The remaining time of the frame
+     * ******************************************
+     */
+    struct timeval now;
+    gettimeofday(&now, NULL);
+    float budget = (1000000 * (frameDeadline.tv_sec - now.tv_sec) + (frameDeadline.tv_usec - now.tv_usec)) * 0.001;
+    if (budget <= 0 || budget > SENSING_PERIOD) budget = SENSING_PERIOD;
+
+    float maxArea = 0;
+    vector<float> latencies;
+    for (auto& task : tasks)
+    {
+        maxArea = max(maxArea, (float)task.model->Onnx_inputWidth() * task.model->Onnx_inputHeight());
+        latencies.push_back(task.model->Onnx_estimateLatency(1));
+    }
+
+    /* ******************************************
+     * Select the resolutions
+     * ******************************************
+     */
+    knapsack.clear();
+#if SGE_SCHED_POLICY == SGE_SCHED_SINGLE
+    int group = knapsack.addGroup();
+#endif
+    for (int i = 0; i < tasks.size(); i++)
+    {
+#if SGE_SCHED_POLICY == SGE_SCHED_SUBSET
+        int group = knapsack.addGroup();
+#endif
+        float value = tasks[i].model->Onnx_inputWidth() * tasks[i].model->Onnx_inputHeight() / maxArea;
+        knapsack.addOption(group, latencies[i] * contentionFactor, value);
+    }
+
+    vector<int> choices;
+    knapsack.solve(budget, &choices);
+
+    vector<bool> selected(tasks.size(), false);
+#if SGE_SCHED_POLICY == SGE_SCHED_SINGLE
+    if (choices[0] >= 0) selected[choices[0]] = true;
+#else
+    for (int i = 0; i < tasks.size(); i++) selected[i] = choices[i] >= 0;
+#endif
+    if (find(selected.begin(), selected.end(), true) == selected.end())
+    {
+        selected[min_element(latencies.begin(), latencies.end()) - latencies.begin()] = true;
+    }
+
+    /* ******************************************
+     * Keep the selected tasks only
+     * ******************************************
+     */
+    taskQueue.clear();
+    string decision;
+    for (int i = 0; i < tasks.size(); i++)
+    {
+        if (!selected[i]) continue;
 
+        taskQueue.push(tasks[i]);
+        scheduledLatency += latencies[i];
+        decision += tasks[i].model->modelName + " ";
+    }
+    predictedTime = scheduledLatency * contentionFactor;
+
+    log_I("SGE_Engine", "Budget: " + to_string(budget) + " ms, contention: " + to_string(contentionFactor) + ", selected: " + decision);
+#endif
 }
 
 
@@ -90,33 +180,275 @@ SGE_Engine::Inference_sched (void)
 void 
 SGE_Engine::onInference (timeval frameStart)
 {
-    struct timeval now;
+    TRACE_SCOPE("sge", "inference");
+#if SGE_SCHED_POLICY == SGE_SCHED_CASCADE
+    int cancelledJobs = inferenceCascade(frameStart);
+    log_I("SGE_Engine", "Cancelled batches: " + to_string(cancelledJobs));
+#else
+    struct timeval now, launch;
     gettimeofday(&now, NULL);
+    launch = now;
     float spendTime = (1000000 * (now.tv_sec - frameStart.tv_sec) + (now.tv_usec - frameStart.tv_usec)) * 0.001;
 
-    vector<pthread_t*> waitingThreads;
+    vector<InferenceJob*> waitingJobs;
     while(SENSING_PERIOD - spendTime > 0 && taskQueue.size() > 0)
     {
         log_D("SGE_Engine", "Task queue size: " + to_string(taskQueue.size()));
 
-        auto it = taskQueue.begin();
-        Inference_Task_t task = *it;
+        Inference_Task_t task = taskQueue.pop();
         vector<float> dataStream(task.model->singleInputSize);
         task.model->dataPreprocess(task.data, &dataStream);
         task.model->Onnx_addInput(dataStream);
-        // task.model->Onnx_inference();
         
-        pthread_create(&task.model->mthread, NULL, threadInference, (void*)task.model);
-        waitingThreads.push_back(&task.model->mthread);
-
-        taskQueue.erase(it);
+        waitingJobs.push_back(executor.submit(task.model, &frameDeadline, false, &frameResults));
 
         gettimeofday(&now, NULL);
         spendTime = (1000000 * (now.tv_sec - frameStart.tv_sec) + (now.tv_usec - frameStart.tv_usec)) * 0.001;
     }
 
-    for(auto thread: waitingThreads)
+    int cancelledJobs = 0;
+    for(auto job: waitingJobs)
+    {
+        job->wait();
+        if (job->cancelled)
+        {
+            cancelledJobs++;
+            log_W("SGE_Engine", job->model->modelName + " cancelled by the frame deadline");
+        }
+        delete job;
+    }
+    log_I("SGE_Engine", "Cancelled batches: " + to_string(cancelledJobs));
+
+    /* ******************************************
+     * Learn the contention from the frame
+     * ******************************************
+     */
+    gettimeofday(&now, NULL);
+    float actualTime = (1000000 * (now.tv_sec - launch.tv_sec) + (now.tv_usec - launch.tv_usec)) * 0.001;
+    if (!waitingJobs.empty() && scheduledLatency > 0)
     {
-        pthread_join((*thread), NULL);
+        contentionFactor += SGE_CONTENTION_SMOOTHING * (actualTime / scheduledLatency - contentionFactor);
     }
+    log_I("SGE_Engine", "Predicted: " + to_string(predictedTime) + " ms, actual: " + to_string(actualTime) + " ms");
+#endif
+
+    postprocess(frameResults, mImg);
+}
+
+
+/** ===============================================================================================
+ * \name    inferenceCascade
+ * 
+ * \brief   Run the resolutions from the lowest one and stop once the mean score of the detections
+ *          reaches CASCADE_CONFIDENCE. A frame without detections is escalated, the small or distant
+ *          objects could be missed at the low resolutions. The saving is an estimate, the profiled
+ *          latency of all resolutions minus the one of the launched resolutions, logged along with
+ *          the measured time of the cascade.
+ * 
+ * \return  the number of batches cancelled by the frame deadline
+ * ================================================================================================
+ */
+int 
+SGE_Engine::inferenceCascade (timeval frameStart)
+{
+    TRACE_SCOPE("sge", "cascade");
+    vector<Inference_Task_t> tasks;
+    taskQueue.snapshot(&tasks);
+    taskQueue.clear();
+    sort(tasks.begin(), tasks.end(), [](const Inference_Task_t& x, const Inference_Task_t& y) {return x.model->Onnx_inputWidth() < y.model->Onnx_inputWidth();});
+
+    float fixedLatency = 0;
+    for (auto& task : tasks)
+    {
+        fixedLatency += task.model->Onnx_estimateLatency(1);
+    }
+
+    int cancelledJobs = 0;
+    float cascadeLatency = 0;
+    string decision;
+    struct timeval cascadeStart, cascadeEnd;
+    gettimeofday(&cascadeStart, NULL);
+    for (auto& task : tasks)
+    {
+        struct timeval now;
+        gettimeofday(&now, NULL);
+        float remaingTime = SENSING_PERIOD - (1000000 * (now.tv_sec - frameStart.tv_sec) + (now.tv_usec - frameStart.tv_usec)) * 0.001;
+        float latency = task.model->Onnx_estimateLatency(1);
+        if (latency > remaingTime) break;
+
+        vector<float> dataStream(task.model->singleInputSize);
+        task.model->dataPreprocess(task.data, &dataStream);
+        task.model->Onnx_addInput(dataStream);
+
+        size_t first = frameResults.size();
+        InferenceJob* job = executor.submit(task.model, &frameDeadline, false, &frameResults);
+        job->wait();
+        cascadeLatency += latency;
+        decision += task.model->modelName + " ";
+        if (job->cancelled)
+        {
+            cancelledJobs++;
+            log_W("SGE_Engine", job->model->modelName + " cancelled by the frame deadline");
+        }
+        delete job;
+
+        /* ******************************************
+         * The confidence of the resolution
+         * ******************************************
+         */
+        int detectionNum = 0;
+        float scoreSum = 0;
+        for (size_t r = first; r < frameResults.size(); r++)
+        {
+            if (frameResults[r].score < FUSION_SCORE_THRESHOLD) continue;
+            scoreSum += frameResults[r].score;
+            detectionNum++;
+        }
+        if (detectionNum > 0 && scoreSum / detectionNum >= CASCADE_CONFIDENCE) break;
+    }
+    gettimeofday(&cascadeEnd, NULL);
+    float measuredTime = (1000000 * (cascadeEnd.tv_sec - cascadeStart.tv_sec) + (cascadeEnd.tv_usec - cascadeStart.tv_usec)) * 0.001;
+
+    fixedLatencySum += fixedLatency;
+    cascadeLatencySum += cascadeLatency;
+    log_I("SGE_Engine", "Cascade: " + decision + "measured " + to_string(measuredTime) + " ms, profiled " + to_string(cascadeLatency) + 
+                        " ms, all resolutions profiled: " + to_string(fixedLatency) + " ms, estimated saving: " + 
+                        to_string(fixedLatency - cascadeLatency) + " ms (total " + to_string(fixedLatencySum - cascadeLatencySum) + " ms)");
+
+    return cancelledJobs;
+}
+
+
+/** ===============================================================================================
+ * \name    differenceFrame
+ * 
+ * \brief   Compare the frame with the last inferred one. A frame with the changed blocks no more than 
+ *          DIFF_SKIP_RATIO is skipped and keeps all detections. A changed region smaller than
+ *          DIFF_REGION_RATIO of the frame is inferred alone, by the resolutions not larger than it,
+ *          and the detections outside it are kept. The whole frame is inferred otherwise, or once
+ *          DIFF_REFRESH_FRAMES passed since the last whole frame.
+ * 
+ * \param   frameModels the models of the frame, reduced by the decision
+ * 
+ * \return  the image of the tasks
+ * ================================================================================================
+ */
+void* 
+SGE_Engine::differenceFrame (vector<OnnxModel*>* frameModels)
+{
+    TRACE_SCOPE("sge", "difference");
+    struct timeval start, end;
+    gettimeofday(&start, NULL);
+        int changedNum = differencer.update(mImg);
+        cv::Rect region = differencer.changedRegion(DIFF_REGION_MARGIN);
+    gettimeofday(&end, NULL);
+    float diffTime = (1000000 * (end.tv_sec - start.tv_sec) + (end.tv_usec - start.tv_usec)) * 0.001;
+
+    float frameArea = (float)mImg.cols * mImg.rows;
+    bool refresh = ++framesSinceFull >= DIFF_REFRESH_FRAMES;
+
+    frameSkipped = false;
+    inferredRegion = cv::Rect(0, 0, mImg.cols, mImg.rows);
+    reusedDetections.clear();
+    void* data = (void*)&mImg;
+    float savedTime = 0;
+    string decision = "whole frame";
+
+    if (!refresh && differencer.changedRatio() <= DIFF_SKIP_RATIO)
+    {
+        /* ******************************************
+         * Skip the frame
+         * ******************************************
+         */
+        for (auto model : *frameModels) savedTime += model->Onnx_estimateLatency(1);
+        frameModels->clear();
+        frameSkipped = true;
+        skippedFrames++;
+        decision = "skipped";
+
+    } else if (!refresh && region.area() < frameArea * DIFF_REGION_RATIO) {
+        /* ******************************************
+         * Infer the changed region
+         * ******************************************
+         */
+        inferredRegion = region;
+        regionImg = mImg(region);
+        data = (void*)&regionImg;
+
+        for (auto& detection : fusion.results())
+        {
+            bool overlapped = detection.box[0] < region.x + region.width && detection.box[2] > region.x &&
+                              detection.box[1] < region.y + region.height && detection.box[3] > region.y;
+            if (!overlapped) reusedDetections.push_back(detection);
+        }
+
+        /* the resolutions larger than the region only upsample it, the smallest one is kept */
+        OnnxModel* smallest = nullptr;
+        for (auto model : models)
+        {
+            if (!smallest || model->Onnx_inputWidth() * model->Onnx_inputHeight() < smallest->Onnx_inputWidth() * smallest->Onnx_inputHeight()) smallest = model;
+        }
+        frameModels->clear();
+        for (auto model : models)
+        {
+            if (model == smallest || model->Onnx_inputWidth() * model->Onnx_inputHeight() <= region.area())
+            {
+                frameModels->push_back(model);
+            } else {
+                savedTime += model->Onnx_estimateLatency(1);
+            }
+        }
+        regionFrames++;
+        decision = "region [" + to_string(region.x) + ", " + to_string(region.y) + ", " + to_string(region.width) + ", " + to_string(region.height) + "]";
+    }
+    if (!frameSkipped && inferredRegion.area() == frameArea) framesSinceFull = 0;
+
+    /* compare the next frames with the pixels inferred, a skipped frame keeps the reference */
+    if (!frameSkipped) differencer.updateReference(mImg, inferredRegion);
+
+    diffFrames++;
+    diffSavedSum += savedTime;
+    log_I("SGE_Engine", "Frame diff: changed blocks: " + to_string(changedNum) + " (" + to_string(differencer.changedRatio() * 100) + "%), " + decision + 
+                        ", diff spend: " + to_string(diffTime) + " ms, saved: " + to_string(savedTime) + " ms");
+    log_I("SGE_Engine", "Frame diff: skip rate: " + to_string(skippedFrames * 100.0 / diffFrames) + "%, region frames: " + to_string(regionFrames) + 
+                        ", total saved: " + to_string(diffSavedSum) + " ms");
+
+    return data;
+}
+
+
+/** ===============================================================================================
+ * \name    postprocess
+ * 
+ * \brief   Merge the detections of all resolutions in the source image
+ * 
+ * \param   results the decoded results of the frame
+ * \param   img the source image of the frame
+ * ================================================================================================
+ */
+void 
+SGE_Engine::postprocess (const ResultBuffer& results, const cv::Mat& img)
+{
+    TRACE_SCOPE("sge", "postprocess");
+#if FRAME_DIFFERENCING && !STAGED_PIPELINE && !PIPELINED_EXECUTION
+    /* the skipped frame keeps the detections of the last frame */
+    if (frameSkipped)
+    {
+        log_I("SGE_Engine", "Kept detections: " + to_string(fusion.results().size()));
+#if LOG_RESULTS
+        fusion.logResults();
+#endif
+        return;
+    }
+
+    float fusionTime = fusion.fuse(results, models, inferredRegion.width, inferredRegion.height);
+    fusion.offset(inferredRegion.x, inferredRegion.y);
+    fusion.append(reusedDetections);
+#else
+    float fusionTime = fusion.fuse(results, models, img.cols, img.rows);
+#endif
+    log_I("SGE_Engine", "Fused detections: " + to_string(fusion.results().size()) + ", fusion spend: " + to_string(fusionTime) + " ms");
+#if LOG_RESULTS
+    fusion.logResults();
+#endif
 }
\ No newline at end of file
@@ -12,11 +12,16 @@
  * \name    SensingEngine
  * 
  * \brief   The class for handling the peripheral sensor
+ * 
+ * \param   datasetPath the dataset replayed by the sensors
  * ================================================================================================
  */
-SensingEngine::SensingEngine ()
+SensingEngine::SensingEngine (string datasetPath) : datasetPath(datasetPath)
 {
     dataReadyToSync = false;
+    sensingDone = false;
+    sensedFrameId = -1;
+    pthread_mutex_init(&dataMutex, NULL);
 }
 
 
@@ -62,23 +67,43 @@ void*
 SensingEngine::threadSensing (void* arg)
 {
     SensingEngine* param = (SensingEngine*) arg;
+    CpuPlan::pinThread(CPU_ROLE_SENSING);
+    TRACE_THREAD("sensing");
+
+#if OVERLOAD_CONTROL && (OVERLOAD_POLICY & OVERLOAD_SKIP)
+    /* ******************************************
+     * Sense every period in real time, a frame 
+     * not synced in time is overwritten by the 
+     * next one
+     * ******************************************
+     */
+    struct timeval release, next, now;
+    struct timeval period = {SENSING_PERIOD / 1000, (SENSING_PERIOD % 1000) * 1000};
+    gettimeofday(&release, NULL);
+    for(int frameID = 0; frameID < FRAME_NUM; frameID++)
+    {
+        log_D("SensingEngine", "Start sensing");
+        param->sense(frameID);
+        param->dataReadyToSync = true;
+        log_D("SensingEngine", "Done sensing");
+
+        timeradd(&release, &period, &next);
+        release = next;
+        gettimeofday(&now, NULL);
+        if (timercmp(&now, &release, <))
+        {
+            struct timeval sleepTime;
+            timersub(&release, &now, &sleepTime);
+            usleep(sleepTime.tv_sec * 1000000 + sleepTime.tv_usec);
+        }
+    }
+#else
     for(int frameID = 0; frameID < FRAME_NUM; frameID++)
     {
         if (!param->dataReadyToSync)
         {
             log_D("SensingEngine", "Start sensing");
-
-#if PERIPHERAL_MASK & SENSOR_CAMERA
-            param->Sensing_Camera(DATASET_PATH + to_string(frameID) + "/FRONT.jpeg");
-#endif
-
-#if PERIPHERAL_MASK & SENSOR_LIDAR
-            param->Sensing_Lidar(DATASET_PATH + to_string(frameID) + "/FRONT.txt");
-#endif
-
-#if PERIPHERAL_MASK & SENSOR_AUDIO
-            std::cout << "Sensing_Audio haven't implement" << std::endl;
-#endif
+            param->sense(frameID);
             param->dataReadyToSync = true;
             log_D("SensingEngine", "Done sensing");
         }
@@ -88,6 +113,8 @@ SensingEngine::threadSensing (void* arg)
         }while(param->dataReadyToSync);
     }
     param->dataReadyToSync = false;
+#endif
+    param->sensingDone = true;
     pthread_exit(nullptr);
 }
 
@@ -106,21 +133,87 @@ SensingEngine::startNextSensing (void)
 }
 
 
+/** ===============================================================================================
+ * \name    takeData
+ * 
+ * \brief   Copy out the data of the last sensed frame and enable the next sensing cycle
+ * 
+ * \param   img the camera image
+ * \param   lidarPoints the lidar ranging points
+ * \param   capture the capture time of the frame
+ * \param   frameId the dataset frame of the data
+ * ================================================================================================
+ */
+void
+SensingEngine::takeData (cv::Mat* img, vector<pair<pair<int, int>, float>>* lidarPoints, timeval* capture, int* frameId)
+{
+    pthread_mutex_lock(&dataMutex);
+        *img = cameraData;
+        *lidarPoints = LidarData;
+        *capture = captureTime;
+        *frameId = sensedFrameId;
+        dataReadyToSync = false;
+    pthread_mutex_unlock(&dataMutex);
+}
+
+
+/** ===============================================================================================
+ * \name    sense
+ * 
+ * \brief   Read all peripherals of the frame, then swap the data in. The files are loaded outside
+ *          the lock, so \b takeData is not blocked by the loading.
+ * 
+ * \param   frameID the dataset frame
+ * ================================================================================================
+ */
+void
+SensingEngine::sense (int frameID)
+{
+    TRACE_SCOPE_ARG("sensing", "sense", frameID);
+    struct timeval capture;
+    gettimeofday(&capture, NULL);
+
+    cv::Mat img;
+    vector<pair<pair<int, int>, float>> lidarPoints;
+
+#if PERIPHERAL_MASK & SENSOR_CAMERA
+    Sensing_Camera(datasetPath + to_string(frameID) + "/FRONT.jpeg", &img);
+#endif
+
+#if PERIPHERAL_MASK & SENSOR_LIDAR
+    Sensing_Lidar(datasetPath + to_string(frameID) + "/FRONT.txt", &lidarPoints);
+#endif
+
+#if PERIPHERAL_MASK & SENSOR_AUDIO
+    std::cout << "Sensing_Audio haven't implement" << std::endl;
+#endif
+
+    pthread_mutex_lock(&dataMutex);
+        cameraData = img;
+        LidarData.swap(lidarPoints);
+        captureTime = capture;
+        sensedFrameId = frameID;
+    pthread_mutex_unlock(&dataMutex);
+}
+
+
 /** ===============================================================================================
  * \name    Sensing_Camera
  * 
  * \brief   load the image form the dataset
  * 
  * \param   filePath image file path for loading
+ * \param   img the loaded image
  * ================================================================================================
  */
 void
-SensingEngine::Sensing_Camera (string filePath)
+SensingEngine::Sensing_Camera (string filePath, cv::Mat* img)
 {
+    TRACE_SCOPE("sensing", "camera");
     struct timeval start, end;
     gettimeofday(&start, NULL);
 
-        cameraData = cv::imread(filePath, cv::ImreadModes::IMREAD_COLOR);
+        *img = cv::imread(filePath, cv::ImreadModes::IMREAD_COLOR);
 
     gettimeofday(&end, NULL);
     float spendTime = (1000000 * (end.tv_sec - start.tv_sec) + (end.tv_usec - start.tv_usec)) * 0.001;
@@ -134,18 +227,20 @@ SensingEngine::Sensing_Camera (string filePath)
  * \brief   load the lidar points form the dataset
  * 
  * \param   filePath lidar file path for loading
+ * \param   lidarPoints the loaded ranging points
  * ================================================================================================
  */
 void
-SensingEngine::Sensing_Lidar (string filePath)
+SensingEngine::Sensing_Lidar (string filePath, vector<pair<pair<int, int>, float>>* lidarPoints)
 {
+    TRACE_SCOPE("sensing", "lidar");
     struct timeval start, end;
     gettimeofday(&start, NULL);
         fstream file; 
         file.open(filePath, ios::in);
         assert(file.is_open() && "dataset file is not exist");
     
-        LidarData.clear();
+        lidarPoints->clear();
 
         // parser lines into ranging points
         string readLine;
@@ -156,7 +251,7 @@ SensingEngine::Sensing_Lidar (string filePath)
             int y = stoi(readLine);
             getline(file, readLine, '\n');
             float distant = stof(readLine);
-            LidarData.emplace_back(make_pair(make_pair(x, y), distant));
+            lidarPoints->emplace_back(make_pair(make_pair(x, y), distant));
         }
         file.close();
     gettimeofday(&end, NULL);
@@ -44,6 +44,22 @@
 #define RT_CPS                  0       // the related work: "Real-Time Task Scheduling for Machine Perception in Intelligent Cyber-Physical System."
 #define RT_SGE                  1       // my approach
 
+/* CPS scheduling policy */
+#define CPS_SCHED_GREEDY        0       // the most summed priority model first, the paper's policy
+#define CPS_SCHED_KNAPSACK      1       // multiple-choice knapsack over (model, batch number)
+#define CPS_SCHED_CASCADE       2       // the cheapest model first, escalate the low confidence samples
+
+/* Overload policy */
+#define OVERLOAD_SKIP           0x01    // sense in real time, the frames not synced in time are overwritten
+#define OVERLOAD_SHED           0x02    // shed the lowest priority tasks beyond the frame budget
+#define OVERLOAD_DOWNGRADE      0x04    // move the tasks onto the fastest model
+
+/* SGE scheduling policy */
+#define SGE_SCHED_ALL           0       // launch every resolution each frame
+#define SGE_SCHED_SUBSET        1       // the subset of resolutions within the budget
+#define SGE_SCHED_SINGLE        2       // the single best resolution within the budget
+#define SGE_SCHED_CASCADE       3       // the lowest resolution first, escalate the low confidence frames
+
 
 /* ************************************************************************************************
  * Application Configuration
@@ -64,6 +80,141 @@
 #define DATASET_PATH            "../dataset/segment-10243642118467607790_880_000_900_000/"
 #define MODEL_PATH              "../models/"
 
+/* CPS scheduler */
+#define CPS_SCHED_POLICY        CPS_SCHED_GREEDY
+#define KNAPSACK_TIME_RESOLUTION 0.5    // ms, the budget unit of the knapsack solver
+
+/* SGE scheduler */
+#define SGE_SCHED_POLICY        SGE_SCHED_ALL
+#define SGE_CONTENTION_SMOOTHING 0.3    // the weight of the last frame in the contention factor
+
+/* Confidence cascade */
+#define CASCADE_CONFIDENCE      0.6     // the results above it are not escalated to the next resolution
+
+/* Cross-frame batching */
+#define BATCH_ACCUMULATION      false   // hold the partial batches of CPS across frames
+#define BATCH_ACCUMULATE_FRAMES 2       // the frames a task could be held
+#define BATCH_DEADLINE_PERIODS  3       // the relative deadline of a held task in SENSING_PERIOD
+
+/* Mosaic packing */
+#define MOSAIC_PACKING          false   // pack the small crops into the canvases of a detection model, not with CPS_SCHED_CASCADE
+#define MOSAIC_MODEL            "yolov7-tiny_640_640"
+#define MOSAIC_MAX_CROP         160     // px, a crop with a larger side is not packed
+#define MOSAIC_MARGIN           8       // px, the gap between the crops
+#define MOSAIC_MAX_CANVAS       2       // the canvases per frame
+#define MOSAIC_MIN_CROPS        2       // a canvas with fewer crops is unpacked
+
+/* Multi-stream */
+#define MULTI_STREAM_NUM        1       // the sensor streams served by one shared model pool
+#define STREAM_DATASET_PATHS    {DATASET_PATH}  // the dataset of every stream, or the command line arguments
+
+/* Obstacle tracking */
+#define TRACK_RESULT_REUSE      false   // reuse the cached results of the stable tracks instead of inferring again
+#define TRACK_IOU               0.3     // a box overlapping a track above it could be the same obstacle
+#define TRACK_DEPTH_GATE        5       // m, the depth change of the same obstacle between frames below it
+#define TRACK_MAX_MISSED        2       // the frames a track survives without a match
+#define TRACK_STABLE_IOU        0.7     // a track moved less than it between frames is stable
+#define TRACK_STABLE_FRAMES     2       // the stable frames before the cached results are reused
+#define TRACK_RESULT_TTL        5       // the frames the cached results are fresh
+
+/* Overload control */
+#define OVERLOAD_CONTROL        false   // skip, shed or downgrade under overload by OVERLOAD_POLICY
+#define OVERLOAD_POLICY         (OVERLOAD_SKIP | OVERLOAD_SHED)
+#define OVERLOAD_LAG_THRESHOLD  SENSING_PERIOD  // ms, the end-to-end lag above it is overload
+#define OVERLOAD_RECOVER_RATIO  0.5     // recover once the lag is below this ratio of the threshold
+#define OVERLOAD_LAG_SMOOTHING  0.5     // the weight of the last frame in the lag
+
+/* Pipelined execution */
+#define PIPELINED_EXECUTION     false   // overlap the frames, dispatch the tasks by the earliest deadline
+#define PIPELINE_DEADLINE_PERIODS 2     // the relative deadline of the tasks in SENSING_PERIOD
+
+/* Task carry-over */
+#define TASK_CARRY_OVER         true    // keep the unserved tasks into the next frame
+#define TASK_AGING_RATE         0.1     // the priority raised per carried frame
+#define TASK_EXPIRY_AGE         3       // the frames a task could be carried
+#define TASK_DEDUP_IOU          0.3     // a carried task overlapping a new slice above it is the same obstacle
+
+/* Speculative inference */
+#define SPECULATIVE_INFERENCE   false   // CPS infers the predicted boxes of the tracks while the lidar points are clustered
+#define SPECULATION_IOU         0.6     // a speculative sample serves the clustered obstacle overlapping it above this
+#define CPS_SPECULATION         (SPECULATIVE_INFERENCE && !STAGED_PIPELINE && !PIPELINED_EXECUTION && MULTI_STREAM_NUM == 1)
+
+/* Staged pipeline */
+#define STAGED_PIPELINE         false   // run sync, slicing, scheduling, preprocess, inference and decode as stages
+#define STAGE_QUEUE_SIZE        8       // the input queue size of each stage
+#define STAGE_PREPROCESS_THREADS 2
+#define STAGE_INFERENCE_THREADS SESSION_REPLICAS
+#define STAGE_DECODE_THREADS    1
+
+/* Latency profile */
+#define LATENCY_PROFILE_PATH    "../profile/"
+#define LATENCY_CALIBRATION_RUNS 5      // runs per batch size without a saved profile at setup
+#define SCHED_LATENCY_PERCENTILE 0.95   // the percentile used as the WCET estimation
+#define PADDING_BATCH           true    // pad every inference to the batchLimit
+
+/* CPU plan */
+#define CPU_PLAN                false   // pin the threads by their roles, the sets below assume 8 cores
+#define CPU_SET_SENSING         "0"
+#define CPU_SET_ENGINE          "1"     // the engine loop, the dispatcher, the watchdog and the pipeline stages
+#define CPU_SET_INFERENCE       "2-7"   // the inference workers and the intra-op threads
+#define CPU_FIFO_SENSING        0       // SCHED_FIFO priority of the sensing thread, 0 for SCHED_OTHER
+#define CPU_FIFO_ENGINE         0       // SCHED_FIFO priority of the engine threads, 0 for SCHED_OTHER
+#define CPU_ISOLATE_MODELS      false   // split the inference cores into one pool per model
+#define CPU_MODEL_POOLS         4       // the number of model pools, the models share them round-robin
+#define INTRA_OP_THREADS        0       // the intra-op threads of each session, 0 for the cores of its pool
+
+/* Inference workers */
+#define SESSION_REPLICAS        1       // concurrent sessions of each model, share the prepacked weights
+#define EXECUTOR_WORKERS_PER_MODEL SESSION_REPLICAS // long-lived inference threads of each model
+#define EXECUTOR_QUEUE_SIZE     16      // the submission queue size of each model
+
+/* Log */
+#define LOG_RING_SIZE           1024    // the records in the ring of each thread
+#define LOG_DRAIN_PERIOD        2000    // us, the period of the drainer
+#define LOG_TAG_SIZE            32      // the longer tags are truncated
+#define LOG_TEXT_SIZE           160     // the longer messages take several records
+#define LOG_MAX_ARGS            8       // the arguments of a deferred format
+
+/* Trace */
+#define TRACE_ENABLE            false   // record the spans of every stage into TRACE_FILE
+#define TRACE_FILE              "trace.json"    // Chrome trace events, opened by chrome://tracing or Perfetto
+#define TRACE_BUFFER_SIZE       65536   // the latest events kept per thread
+
+/* Frame differencing */
+#define FRAME_DIFFERENCING      false   // SGE skips the unchanged frames and infers the changed region only, with the sequential execution
+#define DIFF_BLOCK_SIZE         16      // px, the side of a compared block
+#define DIFF_BLOCK_THRESHOLD    8       // the mean absolute difference per byte above it is a changed block
+#define DIFF_SKIP_RATIO         0       // the frame with the changed blocks no more than this ratio is skipped
+#define DIFF_REGION_RATIO       0.5     // infer the changed region only if it is smaller than this ratio of the frame
+#define DIFF_REGION_MARGIN      2       // blocks, added around the changed region
+#define DIFF_REFRESH_FRAMES     10      // infer the whole frame at least once in these frames
+
+/* Inference results */
+#define RESULT_BUFFER_SIZE      4096    // the maximum results in one frame
+#define RESULT_TOP_K            1       // the classes kept per classification sample
+#define LOG_RESULTS             true    // log the decoded results of each frame
+
+/* Detection fusion */
+#define FUSION_NMS              0       // keep the highest score box of each cluster
+#define FUSION_WBF              1       // weighted box fusion, average the boxes of each cluster by the scores
+#define FUSION_METHOD           FUSION_NMS
+#define FUSION_IOU_THRESHOLD    0.5     // the boxes of the same class above it are one object
+#define FUSION_SCORE_THRESHOLD  0.25    // drop the detections below it before fusion
+
+/* Preemptible inference */
+#define PREEMPTIBLE_INFERENCE   true    // load the segments split by tools/split_onnx_model.py if exist
+#define URGENT_TASK_PRIORITY    0.8     // the batch with a higher priority task preempts the others
+
+/* Memory footprint */
+#define SHARE_ENV_ALLOCATOR     true    // all sessions use one registered CPU arena allocator
+#define SHARE_PREPACKED_WEIGHTS true    // one prepacked weights container across all models
+#define SHARE_INITIALIZERS      true    // reuse the weights exported by tools/export_shared_initializers.py
+#define ARENA_EXTEND_STRATEGY   1       // 0: kNextPowerOfTwo, 1: kSameAsRequested
+#define ARENA_MAX_MEMORY        0       // bytes, 0: no limit
+#define ARENA_INITIAL_CHUNK     -1      // bytes, -1: ORT default
+#define ARENA_MAX_DEAD_BYTES    -1      // bytes, -1: ORT default
+#define ENABLE_MEM_PATTERN      false   // pre-allocate the memory pattern of every input shape
+
 /* ************************************************************************************************
  * Declaration for each approach
  * ************************************************************************************************
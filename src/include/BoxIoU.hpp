@@ -0,0 +1,41 @@
+/**
+ * \name    BoxIoU.hpp
+ *
+ * \brief   Declare the intersection over union shared by the box types of the engines and the
+ *          obstacle tracker
+ *
+ * \date    Oct 18, 2026
+ */
+
+#ifndef _BOX_IOU_HPP_
+#define _BOX_IOU_HPP_
+
+/* ************************************************************************************************
+ * Include Library
+ * ************************************************************************************************
+ */
+#include <algorithm>
+
+using namespace std;
+
+
+/** ===============================================================================================
+ * \name    boxIoU
+ *
+ * \brief   The intersection over union of two boxes
+ *
+ * \param   Box any box with the float members left, top, right and bottom
+ * ================================================================================================
+ */
+template <typename Box>
+inline float boxIoU (const Box& a, const Box& b)
+{
+    float width  = max(0.0f, min(a.right, b.right) - max(a.left, b.left));
+    float height = max(0.0f, min(a.bottom, b.bottom) - max(a.top, b.top));
+    float inter  = width * height;
+    float unionArea = (a.right - a.left) * (a.bottom - a.top) + (b.right - b.left) * (b.bottom - b.top) - inter;
+
+    return unionArea > 0 ? inter / unionArea : 0;
+}
+
+#endif
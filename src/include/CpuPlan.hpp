@@ -0,0 +1,79 @@
+/**
+ * \name    CpuPlan.hpp
+ *
+ * \brief   Declare the CPU plan of the process. Every thread role is pinned to its own core set, the
+ *          sensing and the scheduling threads could run under SCHED_FIFO, and the inference cores
+ *          could be partitioned into one isolated pool per model.
+ *
+ * \date    Oct 18, 2026
+ */
+
+#ifndef _CPU_PLAN_HPP_
+#define _CPU_PLAN_HPP_
+
+/* ************************************************************************************************
+ * Include Library
+ * ************************************************************************************************
+ */
+#include "App_config.hpp"
+#include "Log.hpp"
+
+#include <atomic>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <pthread.h>
+#include <sched.h>
+#include <string.h>
+#include <unistd.h>
+
+using namespace std;
+
+
+/* ************************************************************************************************
+ * Type Define
+ * ************************************************************************************************
+ */
+typedef enum {
+    CPU_ROLE_SENSING = 0,       // the sensing thread
+    CPU_ROLE_ENGINE,            // the engine loop, the dispatcher, the watchdog and the pipeline stages
+    CPU_ROLE_INFERENCE,         // the inference workers and the intra-op threads of the sessions
+}Cpu_Role_t;
+
+
+/** ===============================================================================================
+ * \name    CpuPlan
+ *
+ * \brief   The static CPU plan from the CPU_PLAN configuration. A core set is a list like "0-3,6",
+ *          an empty set leaves the threads of the role unpinned. The cores not online are dropped
+ *          from the sets.
+ * ================================================================================================
+ */
+class CpuPlan
+{
+/* ************************************************************************************************
+ * Functions
+ * ************************************************************************************************
+ */
+public:
+    static vector<int> cores (Cpu_Role_t role);
+    static vector<int> modelCores (void);
+    static string intraOpAffinities (const vector<int>& cores, int threadNum);
+
+    static bool pinThread (Cpu_Role_t role);
+    static bool pinThread (const vector<int>& cores, int fifoPriority = 0);
+
+private:
+    static vector<int> parse (const string& coreSet);
+
+/* ************************************************************************************************
+ * Parameter
+ * ************************************************************************************************
+ */
+private:
+    /* The next model pool of the inference cores */
+    static atomic<int> nextModelPool;
+};
+
+#endif
@@ -0,0 +1,102 @@
+/**
+ * \name    DetectionFusion.hpp
+ *
+ * \brief   Declare the cross-resolution detection fusion. The detections of all models in a frame are
+ *          mapped back to the source image and merged by class-aware NMS or weighted box fusion.
+ *
+ * \date    Oct 18, 2026
+ */
+
+#ifndef _DETECTION_FUSION_HPP_
+#define _DETECTION_FUSION_HPP_
+
+/* ************************************************************************************************
+ * Include Library
+ * ************************************************************************************************
+ */
+#include "App_config.hpp"
+#include "Log.hpp"
+#include "OnnxModels.hpp"
+#include "ResultBuffer.hpp"
+
+#include <algorithm>
+#include <vector>
+
+#include <stdint.h>
+#include <string.h>
+#include <sys/time.h>
+
+using namespace std;
+
+
+/** ===============================================================================================
+ * \name    DetectionFusion
+ *
+ * \brief   Fuse the detections of one frame. The boxes are kept as structure of arrays sorted by
+ *          class and score, so the IoU of one box against a whole class is a contiguous SIMD loop.
+ * ================================================================================================
+ */
+class DetectionFusion
+{
+/* ************************************************************************************************
+ * Class Constructor
+ * ************************************************************************************************
+ */
+public:
+    DetectionFusion (int method = FUSION_METHOD, float iouThreshold = FUSION_IOU_THRESHOLD,
+                     float scoreThreshold = FUSION_SCORE_THRESHOLD);
+
+/* ************************************************************************************************
+ * Functions
+ * ************************************************************************************************
+ */
+public:
+    float fuse (const ResultBuffer& resultBuffer, const vector<OnnxModel*>& models, int imgWidth, int imgHeight);
+    void logResults (void);
+    void offset (float dx, float dy);
+    void append (const vector<Inference_Result_t>& results);
+
+    const vector<Inference_Result_t>& results (void) const {return fused;}
+
+private:
+    void collect (const ResultBuffer& resultBuffer, const vector<OnnxModel*>& models, int imgWidth, int imgHeight);
+    void sortByClass (void);
+    void fuseClass (int begin, int end);
+
+/* ************************************************************************************************
+ * Parameter
+ * ************************************************************************************************
+ */
+private:
+    int method;
+    float iouThreshold;
+    float scoreThreshold;
+
+    /* Number of the models contributed to the frame, the WBF confidence is normalized by it */
+    int modelNum;
+
+    /* The candidate boxes in the source image coordinates */
+    vector<float> x0, y0, x1, y1, area, score;
+    vector<int> classId;
+    vector<OnnxModel*> source;
+
+    /* The scratch of the fusion, reused across frames */
+    vector<uint64_t> keys;
+    vector<int> order;
+    vector<uint8_t> suppressed;
+    vector<uint8_t> matched;
+    vector<int> members;
+
+    /* The fused detections of the last frame */
+    vector<Inference_Result_t> fused;
+};
+
+
+/* ************************************************************************************************
+ * IoU kernel
+ * ************************************************************************************************
+ */
+int simdIouMatch (const float* x0, const float* y0, const float* x1, const float* y1, const float* area,
+                  int length, const float box[4], float boxArea, float threshold, uint8_t* mask);
+
+#endif
@@ -0,0 +1,138 @@
+/**
+ * \name    EdfDispatcher.hpp
+ *
+ * \brief   Declare the earliest-deadline-first dispatcher of the pipelined execution. The tasks of
+ *          several in-flight frames are dispatched into the inference workers by their absolute
+ *          deadlines, so the sensing of the next frame overlaps the inference of the current one.
+ *
+ * \date    Oct 18, 2026
+ */
+
+#ifndef _EDF_DISPATCHER_HPP_
+#define _EDF_DISPATCHER_HPP_
+
+/* ************************************************************************************************
+ * Include Library
+ * ************************************************************************************************
+ */
+#include "App_config.hpp"
+#include "InferenceExecutor.hpp"
+#include "Log.hpp"
+#include "OnnxModels.hpp"
+#include "ResultBuffer.hpp"
+#include "TaskQueue.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <vector>
+
+#include <pthread.h>
+#include <semaphore.h>
+#include <sys/time.h>
+
+using namespace std;
+
+
+/** ===============================================================================================
+ * \name    EdfDispatcher
+ *
+ * \brief   Keep one deadline heap per model and dispatch the earliest deadline batch whenever a
+ *          worker of the model is free. A batch holds the tasks of one frame only.
+ * ================================================================================================
+ */
+class EdfDispatcher
+{
+    /* Check the heap order in tests/test_EdfDispatcher.cpp */
+    friend class EdfDispatcherTest;
+
+/* ************************************************************************************************
+ * Class Constructor
+ * ************************************************************************************************
+ */
+public:
+    EdfDispatcher (InferenceExecutor* executor);
+    ~EdfDispatcher (void);
+
+/* ************************************************************************************************
+ * Type Define
+ * ************************************************************************************************
+ */
+private:
+    typedef struct {
+        Inference_Task_t    task;
+        int                 frameId;
+        timeval             deadline;
+        vector<float>       input;      // preprocessed at admission, the source data may be replaced by the next frame
+    }Edf_Task_t;
+
+    typedef struct {
+        int                 taskNum;
+        int                 doneNum;
+        int                 missNum;
+        timeval             release;
+        timeval             deadline;
+        ResultBuffer*       results;
+    }Frame_Stat_t;
+
+    typedef struct {
+        OnnxModel*              model;
+        vector<Edf_Task_t*>     heap;       // the earliest deadline on the top
+        int                     slots;      // the free workers
+    }Model_Slot_t;
+
+    typedef struct {
+        InferenceJob*           job;
+        Model_Slot_t*           slot;
+        int                     frameId;
+        int                     taskNum;
+        timeval                 deadline;
+    }Inflight_Batch_t;
+
+/* ************************************************************************************************
+ * Functions
+ * ************************************************************************************************
+ */
+public:
+    void addModel (OnnxModel* model, int slotNum = EXECUTOR_WORKERS_PER_MODEL);
+    void start (void);
+    void stop (void);
+    void submitFrame (int frameId, const timeval& release, const vector<Inference_Task_t>& tasks);
+    void report (void);
+
+private:
+    static void* threadDispatcher (void* arg);
+    static bool laterDeadline (const Edf_Task_t* x, const Edf_Task_t* y);
+
+    void reapBatches (void);
+    void dropExpired (void);
+    void dispatchBatches (void);
+    void closeFrames (bool flush);
+
+/* ************************************************************************************************
+ * Parameter
+ * ************************************************************************************************
+ */
+private:
+    InferenceExecutor* executor;
+    pthread_t mthread;
+    atomic<bool> running;
+
+    /* Posted on the frame submission and the job completion */
+    sem_t event;
+
+    /* Protect the heaps and the frame stats */
+    pthread_mutex_t mutex;
+
+    vector<Model_Slot_t*> slots;
+    vector<Inflight_Batch_t> inflight;
+    map<int, Frame_Stat_t> frames;
+
+    /* The totals of the run */
+    int totalFrames;
+    int totalTasks;
+    int totalDone;
+    int totalMiss;
+};
+
+#endif
@@ -0,0 +1,94 @@
+/**
+ * \name    FrameDifferencer.hpp
+ *
+ * \brief   Declare the temporal frame differencing. Consecutive camera frames are compared block by
+ *          block with a SIMD SAD kernel, so the engine could skip an unchanged frame or restrict the
+ *          inference to the changed region.
+ *
+ * \date    Oct 18, 2026
+ */
+
+#ifndef _FRAME_DIFFERENCER_HPP_
+#define _FRAME_DIFFERENCER_HPP_
+
+/* ************************************************************************************************
+ * Include Library
+ * ************************************************************************************************
+ */
+#include "App_config.hpp"
+#include "Log.hpp"
+
+#include <algorithm>
+#include <vector>
+
+#include <stdint.h>
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include <opencv2/opencv.hpp>
+
+using namespace std;
+
+
+/** ===============================================================================================
+ * \name    FrameDifferencer
+ *
+ * \brief   Keep the reference frame, i.e. the pixels last inferred, and mark a block changed if its
+ *          mean absolute difference per byte to the reference is above the threshold. The frames
+ *          must be 8-bit, the first frame and a frame of another size are changed everywhere.
+ * ================================================================================================
+ */
+class FrameDifferencer
+{
+/* ************************************************************************************************
+ * Class Constructor
+ * ************************************************************************************************
+ */
+public:
+    FrameDifferencer (int blockSize = DIFF_BLOCK_SIZE, float threshold = DIFF_BLOCK_THRESHOLD);
+
+/* ************************************************************************************************
+ * Functions
+ * ************************************************************************************************
+ */
+public:
+    int update (const cv::Mat& img);
+    void updateReference (const cv::Mat& img, const cv::Rect& region);
+    cv::Rect changedRegion (int marginBlocks) const;
+
+    float changedRatio (void) const {return changed.empty() ? 1 : (float)changedNum / changed.size();}
+
+/* ************************************************************************************************
+ * Parameter
+ * ************************************************************************************************
+ */
+private:
+    int blockSize;
+    float threshold;
+
+    /* Only the inferred regions are copied in, a skipped frame leaves it unchanged */
+    cv::Mat reference;
+
+    /* The size of the last updated frame */
+    int frameCols;
+    int frameRows;
+
+    /* The block map of the last update in row-major order */
+    vector<uint8_t> changed;
+    int blockCols;
+    int blockRows;
+    int changedNum;
+};
+
+
+/* ************************************************************************************************
+ * SAD kernel
+ * ************************************************************************************************
+ */
+uint32_t simdSad (const uint8_t* a, const uint8_t* b, int length);
+
+#endif
@@ -15,18 +15,33 @@
  */
 
 #include "App_config.hpp"
+#include "BoxIoU.hpp"
+#include "DetectionFusion.hpp"
+#include "EdfDispatcher.hpp"
+#include "FrameDifferencer.hpp"
+#include "InferenceExecutor.hpp"
+#include "KnapsackSolver.hpp"
 #include "Log.hpp"
+#include "ModelPool.hpp"
+#include "MosaicPacker.hpp"
+#include "ObstacleTracker.hpp"
 #include "OnnxModels.hpp"
+#include "OverloadController.hpp"
+#include "Pipeline.hpp"
 #include "SensingEngine.hpp"
+#include "TaskQueue.hpp"
+#include "Trace.hpp"
 
 #include <algorithm>
 // #include <cstring>
 #include <fstream>
 #include <iostream>
+#include <map>
 #include <vector>
 
 #include <assert.h>
 #include <sys/time.h>
+#include <unistd.h>
 #include <onnxruntime/session/onnxruntime_cxx_api.h>
 
 #include <opencv2/opencv.hpp>
@@ -46,23 +61,44 @@ using namespace std;
  */
 class InferenceEngine
 {
+/* The multi-stream engine drives the steps of its stream engines */
+friend class MultiStreamEngine;
+
 /** ***********************************************************************************************
  * Class Constructor
  * ************************************************************************************************
  */ 
 public:
     InferenceEngine(SensingEngine* SE);
+    virtual ~InferenceEngine (void);
 
 /* ************************************************************************************************
  * Type Define
  * ************************************************************************************************
  */
 protected:
+    /* The state of one frame in the staged pipeline */
+    typedef struct {
+        int                                 frameId;
+        timeval                             release;
+        timeval                             deadline;
+        cv::Mat                             img;
+        vector<pair<pair<int, int>, float>> lidarPoints;
+        vector<Inference_Task_t>            tasks;
+        ResultBuffer*                       results;
+        atomic<int>                         pendingBatches;
+        atomic<int>                         cancelledBatches;
+    }Frame_Context_t;
+
+    /* One batch of a model in the staged pipeline */
     typedef struct {
-        void*           data;
-        float           priority;
-        OnnxModel*      model;
-    }Inference_Task_t;
+        Frame_Context_t*                    frame;
+        OnnxModel*                          model;
+        vector<Inference_Task_t>            tasks;
+        vector<float>                       inputs;
+        OnnxModel::Inference_Progress_t     progress;
+        bool                                cancelled;
+    }Batch_Context_t;
 
 /* ************************************************************************************************
  * Functions
@@ -73,12 +109,27 @@ public:
     void stop (void);
 
 protected:
-    void onSyncData (void);
-    static void* threadInference (void* arg);
+    void runSequential (void);
+    void runPipelined (void);
+    void runStaged (void);
+    bool onSyncData (void);
+    bool readSensing (cv::Mat* img, vector<pair<pair<int, int>, float>>* lidarPoints);
+    void controlOverload (void);
     virtual void registerModels (void);
     virtual void dataPreprocessor(void);
     virtual void Inference_sched (void);
     virtual void onInference (timeval frameStart);
+    virtual void postprocess (const ResultBuffer& results, const cv::Mat& img);
+    virtual void releaseTask (const Inference_Task_t& task);
+
+    /* The stages of the staged pipeline */
+    static void stageSync (void* item, Pipeline* pipeline, int stageId, void* arg);
+    static void stageSlice (void* item, Pipeline* pipeline, int stageId, void* arg);
+    static void stageSched (void* item, Pipeline* pipeline, int stageId, void* arg);
+    static void stagePreprocess (void* item, Pipeline* pipeline, int stageId, void* arg);
+    static void stageInference (void* item, Pipeline* pipeline, int stageId, void* arg);
+    static void stageDecode (void* item, Pipeline* pipeline, int stageId, void* arg);
+    void finishFrame (Frame_Context_t* frame);
 
 /* ************************************************************************************************
  * Parameter
@@ -91,7 +142,29 @@ protected:
     cv::Mat                                 mImg;
     vector<pair<pair<int, int>, float>>     mLidarPoints;
     vector<OnnxModel*>                      models;
-    vector<Inference_Task_t>                taskQueue;
+    TaskQueue                               taskQueue;
+    InferenceExecutor                       executor;
+
+    /* Dispatch the tasks of the in-flight frames under PIPELINED_EXECUTION */
+    EdfDispatcher                           dispatcher;
+
+    /* The absolute deadline of the current frame */
+    timeval                                 frameDeadline;
+
+    /* The decoded results of the current frame */
+    ResultBuffer                            frameResults;
+
+    /* The capture time and the dataset frame of the synced data */
+    timeval                                 captureTime;
+    int                                     sensedFrameId;
+
+    /* Bound the work of the frames under overload */
+    OverloadController                      overload;
+
+    /* The staged pipeline: the slicing and scheduling stages share the engine state, the finished
+     * frames share the postprocess */
+    pthread_mutex_t                         engineMutex;
+    pthread_mutex_t                         frameMutex;
 
 };
 
@@ -132,6 +205,38 @@ private:
         float bottom;
     } boundingBox_t;
 
+    /* The obstacle of a task, kept for the carry-over */
+    typedef struct {
+        boundingBox_t   box;
+        float           basePriority;
+        int             age;            // frames the task was carried over
+        int             trackId;        // the track of the obstacle, -1 if not tracked
+    } Task_Origin_t;
+
+    /* The obstacles packed in one mosaic canvas */
+    typedef struct {
+        vector<cv::Rect>        rects;      // the places in the canvas
+        vector<Task_Origin_t>   origins;
+        vector<OnnxModel*>      models;     // the models assigned by the crop shapes
+    } Mosaic_t;
+
+    /* A task held for a fuller batch of the next frame */
+    typedef struct {
+        Inference_Task_t    task;
+        Task_Origin_t       origin;
+        timeval             release;        // the start of the frame creating the task
+        int                 frames;         // frames the task was held
+    } Held_Task_t;
+
+    /* A speculative batch on the predicted boxes, started before the clustering */
+    typedef struct {
+        InferenceJob*           job;
+        ResultBuffer*           results;
+        vector<int>             trackIds;       // the track of every sample
+        vector<boundingBox_t>   boxes;          // the predicted box of every sample
+        vector<bool>            accepted;       // the sample serves a clustered obstacle
+    } Speculation_t;
+
 
 /* ************************************************************************************************
  * Functions
@@ -142,6 +247,23 @@ private:
     void dataPreprocessor(void) override;
     void Inference_sched (void) override;
     void onInference (timeval frameStart) override;
+    void releaseTask (const Inference_Task_t& task) override;
+
+    int scheduleGreedy (timeval frameStart);
+    int scheduleKnapsack (timeval frameStart);
+    int scheduleCascade (timeval frameStart);
+    bool inferenceBatch (OnnxModel* model, vector<Inference_Task_t>& tasks);
+
+    void packMosaics (vector<Inference_Task_t>& newTasks);
+    void decodeMosaics (const vector<Mosaic_t>& batchMosaics, const ResultBuffer& results, bool cache);
+    void accumulateTasks (timeval frameStart);
+    void carryOverTasks (void);
+    void speculate (void);
+    bool acceptSpeculation (int trackId, const boundingBox_t& box, OnnxModel* model);
+    void collectSpeculation (void);
+    int assignShape (const boundingBox_t& box);
+    void cacheResults (const vector<int>& trackIds, const ResultBuffer& results, size_t begin);
+    void mergeCarriedTasks (vector<Inference_Task_t>& newTasks);
 
 
 /* ************************************************************************************************
@@ -150,6 +272,49 @@ private:
  */
 private:
     vector<pair<int, int>> imgShapes;
+
+    /* The per-frame solver of the knapsack policy */
+    KnapsackSolver knapsack;
+
+    /* The obstacle of every task in the queue, keyed by the task data */
+    map<void*, Task_Origin_t> taskOrigins;
+
+    /* The unserved tasks carried into the next frame */
+    vector<pair<Task_Origin_t, OnnxModel*>> carriedTasks;
+
+    /* The tracks of the obstacles with their cached results, and the reuse over the run */
+    ObstacleTracker tracker;
+    long trackLookups;
+    long trackHits;
+    float savedTimeSum;
+
+    /* The speculative batches of the frame, and their outcome over the run */
+    vector<Speculation_t> speculations;
+    long speculatedSamples;
+    long acceptedSamples;
+    long revokedBatches;
+
+    /* The detection model of the mosaic canvases and the obstacles of every canvas in the queue */
+    OnnxModel* mosaicModel;
+    map<void*, Mosaic_t> mosaics;
+    ResultBuffer mosaicResults;
+
+    /* The partial batches held across frames, and the release of the held tasks in the queue */
+    vector<Held_Task_t> heldTasks;
+    map<void*, timeval> heldReleases;
+
+    /* The batch fill and the latency added by holding over the run */
+    long batchSamples;
+    long batchSlots;
+    long heldServed;
+    float addedLatencySum;
+
+    /* The results of one cascade batch, before they are accepted into the frame */
+    ResultBuffer cascadeResults;
+
+    /* The estimated latency of the fixed assignment and of the cascade over the run */
+    float fixedLatencySum;
+    float cascadeLatencySum;
 };
 
 
@@ -179,8 +344,128 @@ private:
     void dataPreprocessor(void) override;
     void Inference_sched (void) override;
     void onInference (timeval frameStart) override;
+    void postprocess (const ResultBuffer& results, const cv::Mat& img) override;
+
+    int inferenceCascade (timeval frameStart);
+    void* differenceFrame (vector<OnnxModel*>* frameModels);
+
+/* ************************************************************************************************
+ * Parameter
+ * ************************************************************************************************
+ */
+private:
+    /* Merge the detections of all resolutions */
+    DetectionFusion fusion;
+
+    /* The changed region inferred in the frame, the detections kept outside it, or the whole
+       frame skipped with all detections kept */
+    FrameDifferencer differencer;
+    cv::Mat regionImg;
+    cv::Rect inferredRegion;
+    bool frameSkipped;
+    vector<Inference_Result_t> reusedDetections;
+
+    /* The frame differencing over the run */
+    int diffFrames;
+    int skippedFrames;
+    int regionFrames;
+    int framesSinceFull;        // the frames since the whole frame was inferred
+    float diffSavedSum;
+
+    /* The per-frame solver of the resolution selection */
+    KnapsackSolver knapsack;
+
+    /* The observed frame time over the summed isolated latency of the launched resolutions */
+    float contentionFactor;
+
+    /* The summed isolated latency and the prediction of the scheduled resolutions */
+    float scheduledLatency;
+    float predictedTime;
+
+    /* The estimated latency of all resolutions and of the cascade over the run */
+    float fixedLatencySum;
+    float cascadeLatencySum;
+};
+
+
+/** ===============================================================================================
+ * \name    MultiStreamEngine
+ * 
+ * \brief   Serve several sensor streams on one shared model pool. Every stream is an engine with its
+ *          own SensingEngine, slicing and postprocess, while the tasks of all streams are admitted in
+ *          a fair order and batched across the streams on the shared executor.
+ * ================================================================================================
+ */
+class MultiStreamEngine
+{
+/* ************************************************************************************************
+ * Class Constructor
+ * ************************************************************************************************
+ */ 
+public:
+    MultiStreamEngine (void);
+    ~MultiStreamEngine (void);
+
+/* ************************************************************************************************
+ * Type Define
+ * ************************************************************************************************
+ */
+private:
+    typedef struct {
+        InferenceEngine*            engine;
+        bool                        active;
+
+        /* The tasks of the current frame in non-ascending order of priority */
+        vector<Inference_Task_t>    tasks;
+        timeval                     deadline;
+        int                         missNum;        // the missed tasks of the current frame
+
+        /* The deadline accounting of the run */
+        int                         frameNum;
+        int                         frameMet;
+        int                         taskNum;
+        int                         doneNum;
+        int                         shedNum;
+        float                       responseSum;
+    }Stream_t;
+
+    typedef struct {
+        InferenceJob*               job;
+        ResultBuffer*               results;
+        vector<int>                 streamIds;      // the stream of every sample
+    }Stream_Batch_t;
+
+/* ************************************************************************************************
+ * Functions
+ * ************************************************************************************************
+ */
+public:
+    void addStream (InferenceEngine* engine);
+    void run (void);
+
+private:
+    bool syncStreams (void);
+    void inferenceStreams (timeval frameStart);
+    void finishStreams (void);
+    void report (float elapsedTime);
+
+/* ************************************************************************************************
+ * Parameter
+ * ************************************************************************************************
+ */
+private:
+    vector<Stream_t> streams;
+
+    /* The distinct models of all streams and their shared workers */
+    vector<OnnxModel*> models;
+    InferenceExecutor executor;
+
+    /* The result buffers of the batches, reused across frames */
+    vector<ResultBuffer*> batchResults;
 
+    /* The stream admitted first in the frame, rotated every frame */
+    int firstStream;
 };
 
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,168 @@
+/**
+ * \name    InferenceExecutor.hpp
+ *
+ * \brief   Declare the persistent inference workers. Every model owns long-lived worker threads fed
+ *          through a lock-free submission queue, and every submitted batch returns a completion handle.
+ *
+ * \date    Oct 18, 2026
+ */
+
+#ifndef _INFERENCE_EXECUTOR_HPP_
+#define _INFERENCE_EXECUTOR_HPP_
+
+/* ************************************************************************************************
+ * Include Library
+ * ************************************************************************************************
+ */
+#include "App_config.hpp"
+#include "Log.hpp"
+#include "OnnxModels.hpp"
+#include "RingQueue.hpp"
+#include "Trace.hpp"
+
+#include <atomic>
+#include <map>
+#include <vector>
+
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <semaphore.h>
+#include <sys/time.h>
+
+using namespace std;
+
+
+/** ===============================================================================================
+ * \name    InferenceJob
+ *
+ * \brief   The completion handle of one submitted batch
+ * ================================================================================================
+ */
+class InferenceJob
+{
+/* ************************************************************************************************
+ * Class Constructor
+ * ************************************************************************************************
+ */
+public:
+    InferenceJob (OnnxModel* model);
+    ~InferenceJob (void);
+
+/* ************************************************************************************************
+ * Functions
+ * ************************************************************************************************
+ */
+public:
+    void wait (void);
+
+    /* Only a hint for polling, a done job is deleted after \b wait */
+    bool isDone (void) {return done.load(memory_order_acquire);}
+    bool isRevoked (void) {return revoked.load(memory_order_acquire);}
+    void revoke (void);
+    void finish (void);
+
+/* ************************************************************************************************
+ * Parameter
+ * ************************************************************************************************
+ */
+public:
+    /* The model to inference */
+    OnnxModel* model;
+
+    /* The preprocessed batch, moved from the model's stash at submission */
+    vector<float> inputStreams;
+
+    /* The inference spend time of this batch */
+    float spendTime;
+
+    /* The absolute deadline of this batch */
+    bool hasDeadline;
+    timeval deadline;
+
+    /* The batch is cancelled by the deadline */
+    bool cancelled;
+
+    /* The urgent batch preempts the running segmented batches */
+    bool urgent;
+
+    /* The decoded results are appended into, could be nullptr */
+    ResultBuffer* results;
+
+    /* Posted when the job is finished, could be nullptr */
+    sem_t* notify;
+
+    /* The resumable state if the batch is preempted */
+    OnnxModel::Inference_Progress_t progress;
+
+private:
+    atomic<bool> done;
+    atomic<bool> revoked;
+    sem_t completion;
+};
+
+
+/** ===============================================================================================
+ * \name    InferenceExecutor
+ *
+ * \brief   The long-lived inference workers of the registered models
+ * ================================================================================================
+ */
+class InferenceExecutor
+{
+/* ************************************************************************************************
+ * Class Constructor
+ * ************************************************************************************************
+ */
+public:
+    InferenceExecutor (void);
+    ~InferenceExecutor (void);
+
+/* ************************************************************************************************
+ * Type Define
+ * ************************************************************************************************
+ */
+private:
+    typedef struct {
+        OnnxModel*                  model;
+        RingQueue<InferenceJob*>*   jobs;
+        RingQueue<InferenceJob*>*   urgentJobs;
+        RingQueue<InferenceJob*>*   resumedJobs;
+        sem_t                       pending;
+        vector<pthread_t>           workers;
+        InferenceExecutor*          executor;
+
+        /* Number of the urgent jobs of this model not finished yet, the workers holding a
+           preempted job sleep on urgentDrained until it drops to 0 */
+        atomic<int>                 urgentPending;
+        pthread_mutex_t             urgentMutex;
+        pthread_cond_t              urgentDrained;
+    }Model_Queue_t;
+
+/* ************************************************************************************************
+ * Functions
+ * ************************************************************************************************
+ */
+public:
+    void addModel (OnnxModel* model, int workerNum = EXECUTOR_WORKERS_PER_MODEL);
+    InferenceJob* submit (OnnxModel* model, const timeval* deadline = nullptr, bool urgent = false, ResultBuffer* results = nullptr, sem_t* notify = nullptr);
+    void stop (void);
+
+private:
+    static void* threadWorker (void* arg);
+    static bool urgentWaiting (void* arg);
+    static void urgentFinished (Model_Queue_t* queue);
+    static void waitUrgentJobs (Model_Queue_t* queue);
+    static void cancelJob (Model_Queue_t* queue, InferenceJob* job);
+    static void cancelQueuedJobs (Model_Queue_t* queue);
+
+/* ************************************************************************************************
+ * Parameter
+ * ************************************************************************************************
+ */
+private:
+    atomic<bool> running;
+    map<OnnxModel*, Model_Queue_t*> queues;
+};
+
+#endif
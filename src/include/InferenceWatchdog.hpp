@@ -0,0 +1,84 @@
+/**
+ * \name    InferenceWatchdog.hpp
+ *
+ * \brief   Declare the watchdog which terminates the inference exceeding its absolute deadline
+ *
+ * \date    Oct 18, 2026
+ */
+
+#ifndef _INFERENCE_WATCHDOG_HPP_
+#define _INFERENCE_WATCHDOG_HPP_
+
+/* ************************************************************************************************
+ * Include Library
+ * ************************************************************************************************
+ */
+#include "App_config.hpp"
+#include "CpuPlan.hpp"
+#include "Log.hpp"
+
+#include <map>
+
+#include <pthread.h>
+#include <sys/time.h>
+#include <onnxruntime/session/onnxruntime_cxx_api.h>
+
+using namespace std;
+
+
+/** ===============================================================================================
+ * \name    InferenceWatchdog
+ *
+ * \brief   A process-wide thread sleeping until the earliest watched deadline, then calling
+ *          \b Ort::RunOptions::SetTerminate on the expired runs.
+ * ================================================================================================
+ */
+class InferenceWatchdog
+{
+/* ************************************************************************************************
+ * Class Constructor
+ * ************************************************************************************************
+ */
+private:
+    InferenceWatchdog (void);
+
+/* ************************************************************************************************
+ * Type Define
+ * ************************************************************************************************
+ */
+private:
+    typedef struct {
+        Ort::RunOptions*    runOptions;
+        timeval             deadline;
+        bool                terminated;
+    }Watch_Entry_t;
+
+/* ************************************************************************************************
+ * Functions
+ * ************************************************************************************************
+ */
+public:
+    static InferenceWatchdog* instance (void);
+    static bool expired (const timeval& deadline);
+
+    int watch (Ort::RunOptions* runOptions, const timeval& deadline);
+    bool unwatch (int watchId);
+    bool fired (int watchId);
+
+private:
+    static void* threadWatchdog (void* arg);
+
+/* ************************************************************************************************
+ * Parameter
+ * ************************************************************************************************
+ */
+private:
+    int nextId;
+    map<int, Watch_Entry_t> entries;
+
+    pthread_t mthread;
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+};
+
+#endif
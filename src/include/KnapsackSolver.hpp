@@ -0,0 +1,80 @@
+/**
+ * \name    KnapsackSolver.hpp
+ *
+ * \brief   Declare the multiple-choice knapsack solver used by the schedulers. Every group offers
+ *          several options with a latency cost and a priority value, at most one option of each
+ *          group is picked to maximize the total value within the time budget.
+ *
+ * \date    Oct 18, 2026
+ */
+
+#ifndef _KNAPSACK_SOLVER_HPP_
+#define _KNAPSACK_SOLVER_HPP_
+
+/* ************************************************************************************************
+ * Include Library
+ * ************************************************************************************************
+ */
+#include "App_config.hpp"
+
+#include <algorithm>
+#include <vector>
+
+#include <math.h>
+
+using namespace std;
+
+
+/** ===============================================================================================
+ * \name    KnapsackSolver
+ *
+ * \brief   Dynamic programming over the budget quantized into KNAPSACK_TIME_RESOLUTION units. The
+ *          tables are reused across frames, so solving allocates nothing after the first frames.
+ * ================================================================================================
+ */
+class KnapsackSolver
+{
+/* ************************************************************************************************
+ * Class Constructor
+ * ************************************************************************************************
+ */
+public:
+    KnapsackSolver (float resolution = KNAPSACK_TIME_RESOLUTION);
+
+/* ************************************************************************************************
+ * Type Define
+ * ************************************************************************************************
+ */
+private:
+    typedef struct {
+        int     cost;       // in resolution units, rounded up
+        float   value;
+    }Option_t;
+
+/* ************************************************************************************************
+ * Functions
+ * ************************************************************************************************
+ */
+public:
+    void clear (void);
+    int addGroup (void);
+    void addOption (int group, float cost, float value);
+    float solve (float budget, vector<int>* choices);
+
+/* ************************************************************************************************
+ * Parameter
+ * ************************************************************************************************
+ */
+private:
+    float resolution;
+    vector<vector<Option_t>> groups;
+
+    /* best[c] is the best value of the solved groups within c units */
+    vector<float> best;
+    vector<float> next;
+
+    /* picked[g * (capacity + 1) + c] is the option of group g for the budget c, -1 for none */
+    vector<int> picked;
+};
+
+#endif
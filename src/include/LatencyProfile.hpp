@@ -0,0 +1,138 @@
+/**
+ * \name    LatencyProfile.hpp
+ *
+ * \brief   Declare the latency profile of the models, which is recorded per batch size and used as
+ *          the WCET-style estimation for the schedulers.
+ *
+ * \date    Oct 18, 2026
+ */
+
+#ifndef _LATENCY_PROFILE_HPP_
+#define _LATENCY_PROFILE_HPP_
+
+/* ************************************************************************************************
+ * Include Library
+ * ************************************************************************************************
+ */
+#include "App_config.hpp"
+#include "Log.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <vector>
+
+#include <math.h>
+#include <pthread.h>
+#include <stdint.h>
+
+using namespace std;
+
+
+/** ===============================================================================================
+ * \name    LatencyHistogram
+ *
+ * \brief   A streaming histogram with logarithmic buckets. Bucket \b i covers the latency range
+ *          [LATENCY_BUCKET_MIN * LATENCY_BUCKET_GROWTH^i, LATENCY_BUCKET_MIN * LATENCY_BUCKET_GROWTH^(i+1)),
+ *          so the relative error of the percentile is bounded by the growth rate.
+ * ================================================================================================
+ */
+class LatencyHistogram
+{
+/* ************************************************************************************************
+ * Local Configureation
+ * ************************************************************************************************
+ */
+    #define LATENCY_BUCKET_MIN              0.01    // ms
+    #define LATENCY_BUCKET_GROWTH           1.05
+    #define LATENCY_BUCKET_NUM              300
+
+/* ************************************************************************************************
+ * Class Constructor
+ * ************************************************************************************************
+ */
+public:
+    LatencyHistogram (void);
+
+/* ************************************************************************************************
+ * Functions
+ * ************************************************************************************************
+ */
+public:
+    void record (float latency);
+    float percentile (float p) const;
+    float mean (void) const {return count ? sum / count : 0;}
+
+    string serialize (void) const;
+    bool deserialize (istringstream& stream);
+
+private:
+    static int bucketOf (float latency);
+    static float bucketUpper (int bucket);
+
+/* ************************************************************************************************
+ * Parameter
+ * ************************************************************************************************
+ */
+public:
+    /* Number of recorded samples */
+    uint64_t count;
+
+    /* The worst observed latency */
+    float maxLatency;
+
+private:
+    double sum;
+    vector<uint32_t> buckets;
+};
+
+
+/** ===============================================================================================
+ * \name    LatencyProfile
+ *
+ * \brief   The latency histograms of one model, indexed by the executed batch size. The profile is
+ *          loaded from \b LATENCY_PROFILE_PATH at setup and saved back when the model is destroyed.
+ * ================================================================================================
+ */
+class LatencyProfile
+{
+/* ************************************************************************************************
+ * Class Constructor
+ * ************************************************************************************************
+ */
+public:
+    LatencyProfile (string model_name);
+    ~LatencyProfile (void);
+
+/* ************************************************************************************************
+ * Functions
+ * ************************************************************************************************
+ */
+public:
+    void record (int batchSize, float latency);
+    float getPercentile (int batchSize, float p);
+    float getMax (int batchSize);
+    bool isProfiled (int batchSize);
+
+    bool load (void);
+    bool save (void);
+    void report (void);
+
+private:
+    LatencyHistogram* findHistogram (int batchSize);
+
+/* ************************************************************************************************
+ * Parameter
+ * ************************************************************************************************
+ */
+private:
+    string modelName;
+    string filePath;
+
+    map<int, LatencyHistogram> histograms;
+    pthread_mutex_t mutex;
+};
+
+#endif
@@ -1,8 +1,10 @@
-/** 
+/**
  * \name    Log.hpp
- * 
- * \brief   Log the information of the application
- * 
+ *
+ * \brief   Log the information of the application. A call writes a fixed-size record into the
+ *          lock-free ring of its thread, a background thread drains the rings, formats the records
+ *          and writes them out. The calls below LOG_LEVEL are compiled out with their arguments.
+ *
  * \date    Mar 6, 2023
  */
 
@@ -15,8 +17,16 @@
  */
 #include "App_config.hpp"
 
+#include <atomic>
 #include <iostream>
 #include <fstream>
+#include <string>
+#include <vector>
+
+#include <pthread.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
 
 /* ************************************************************************************************
  * Enumeration
@@ -25,11 +35,39 @@
 typedef enum {
     ONNX_SETUPMODEL_START               = 0x00,
     ONNX_SETUPMODEL_WARMUP              = 0x01,
+    ONNX_SETUPMODEL_CALIBRATE           = 0x02,
 
     ONNX_INFERENCE_INPUTSIZE_ZERO       = 0x10,
-    ONNX_INFERENCE_INPUTSIZE_WRONG      = 0x11
+    ONNX_INFERENCE_INPUTSIZE_WRONG      = 0x11,
+    ONNX_INFERENCE_CANCELLED            = 0x12
 }Log_t;
 
+/* ************************************************************************************************
+ * Type Define
+ * ************************************************************************************************
+ */
+typedef struct {
+    char    type;                           // 'i' integer, 'f' floating point, 's' string literal
+    union {
+        long            i;
+        double          f;
+        const char*     s;
+    };
+}Log_Arg_t;
+
+typedef struct {
+    uint64_t        timestamp;              // ns of CLOCK_MONOTONIC, orders the records of all threads
+    uint8_t         level;
+    uint8_t         argNum;
+    bool            more;                   // the text continues in the next record
+    const char*     format;                 // a string literal with {} placeholders, nullptr for the text
+    char            tag[LOG_TAG_SIZE];
+    union {
+        Log_Arg_t   args[LOG_MAX_ARGS];
+        char        text[LOG_TEXT_SIZE];
+    };
+}Log_Record_t;
+
 /* ************************************************************************************************
  * Global Resource
  * ************************************************************************************************
@@ -46,55 +84,104 @@ void logDestory (void);
 
 void log (std::string tag, Log_t logType);
 
-/* ERROR */
-inline void log_E (std::string tag, std::string logInfo)
+/* The backend of the macros, write one record into the ring of the calling thread */
+Log_Record_t* logAcquire (int level, const char* tag);
+void logCommit (Log_Record_t* record);
+void logText (int level, const char* tag, const char* text, size_t length);
+
+inline const char* logCString (const char* str) {return str;}
+inline const char* logCString (const std::string& str) {return str.c_str();}
+inline size_t logLength (const char* str) {return strlen(str);}
+inline size_t logLength (const std::string& str) {return str.size();}
+
+inline void logArg (Log_Arg_t* arg, int value) {arg->type = 'i'; arg->i = value;}
+inline void logArg (Log_Arg_t* arg, long value) {arg->type = 'i'; arg->i = value;}
+inline void logArg (Log_Arg_t* arg, unsigned int value) {arg->type = 'i'; arg->i = value;}
+inline void logArg (Log_Arg_t* arg, unsigned long value) {arg->type = 'i'; arg->i = value;}
+inline void logArg (Log_Arg_t* arg, long long value) {arg->type = 'i'; arg->i = value;}
+inline void logArg (Log_Arg_t* arg, unsigned long long value) {arg->type = 'i'; arg->i = value;}
+inline void logArg (Log_Arg_t* arg, float value) {arg->type = 'f'; arg->f = value;}
+inline void logArg (Log_Arg_t* arg, double value) {arg->type = 'f'; arg->f = value;}
+inline void logArg (Log_Arg_t* arg, const char* value) {arg->type = 's'; arg->s = value;}
+
+inline void logArgs (Log_Record_t* record) {}
+
+template <typename T, typename... Rest>
+inline void logArgs (Log_Record_t* record, T value, Rest... rest)
+{
+    if (record->argNum < LOG_MAX_ARGS) logArg(&record->args[record->argNum++], value);
+    logArgs(record, rest...);
+}
+
+/* Keep a preformatted message */
+template <typename Tag, typename Text>
+inline void logMessage (int level, const Tag& tag, const Text& text)
+{
+    logText(level, logCString(tag), logCString(text), logLength(text));
+}
+
+/* Keep the format and the arguments, the message is formatted by the drainer. The string
+   arguments must outlive the drain, e.g. string literals. */
+template <typename Tag, typename... Args>
+inline void logFormat (int level, const Tag& tag, const char* format, Args... args)
 {
+    Log_Record_t* record = logAcquire(level, logCString(tag));
+    record->format = format;
+    logArgs(record, args...);
+    logCommit(record);
+}
+
+/* ************************************************************************************************
+ * Log Macros
+ *
+ * log_X(tag, text) logs a preformatted message, logf_X(tag, format, args...) a format with {}
+ * placeholders and up to LOG_MAX_ARGS numeric arguments, for the hot paths. Below LOG_LEVEL the
+ * calls are dead code, still referencing their arguments
+ * ************************************************************************************************
+ */
+/* ERROR */
 #if LOG_LEVEL >= ERROR
-    pthread_mutex_lock(&ioMutex);
-    std::cout << "\033[1;31mLogE:\033[0m Tag: " << tag << ": " << logInfo << std::endl;
-    pthread_mutex_unlock(&ioMutex);
+#define log_E(tag, logInfo)         logMessage(ERROR, tag, logInfo)
+#define logf_E(tag, ...)            logFormat(ERROR, tag, __VA_ARGS__)
+#else
+#define log_E(tag, logInfo)         do { if (0) logMessage(ERROR, tag, logInfo); } while (0)
+#define logf_E(tag, ...)            do { if (0) logFormat(ERROR, tag, __VA_ARGS__); } while (0)
 #endif
-}
 
 /* WARNNING */
-inline void log_W (std::string tag, std::string logInfo)
-{
 #if LOG_LEVEL >= WARNNING
-    pthread_mutex_lock(&ioMutex);
-    std::cout << "\033[1;34mLogW:\033[0m Tag: " << tag << ": " << logInfo << std::endl;
-    pthread_mutex_unlock(&ioMutex);
+#define log_W(tag, logInfo)         logMessage(WARNNING, tag, logInfo)
+#define logf_W(tag, ...)            logFormat(WARNNING, tag, __VA_ARGS__)
+#else
+#define log_W(tag, logInfo)         do { if (0) logMessage(WARNNING, tag, logInfo); } while (0)
+#define logf_W(tag, ...)            do { if (0) logFormat(WARNNING, tag, __VA_ARGS__); } while (0)
 #endif
-}
 
 /* INFO */
-inline void log_I (std::string tag, std::string logInfo)
-{
 #if LOG_LEVEL >= INFO
-    pthread_mutex_lock(&ioMutex);
-    std::cout << "\033[1;32mLogI:\033[0m Tag: " << tag << ": " << logInfo << std::endl;
-    logFile << "Tag: " << tag << ": " << logInfo << std::endl;
-    pthread_mutex_unlock(&ioMutex);
+#define log_I(tag, logInfo)         logMessage(INFO, tag, logInfo)
+#define logf_I(tag, ...)            logFormat(INFO, tag, __VA_ARGS__)
+#else
+#define log_I(tag, logInfo)         do { if (0) logMessage(INFO, tag, logInfo); } while (0)
+#define logf_I(tag, ...)            do { if (0) logFormat(INFO, tag, __VA_ARGS__); } while (0)
 #endif
-}
 
 /* DEBUG */
-inline void log_D (std::string tag, std::string logInfo)
-{
 #if LOG_LEVEL >= DEBUG
-    pthread_mutex_lock(&ioMutex);
-    std::cout << "\033[1;36mLogD:\033[0m Tag: " << tag << ": " << logInfo << std::endl;
-    pthread_mutex_unlock(&ioMutex);
+#define log_D(tag, logInfo)         logMessage(DEBUG, tag, logInfo)
+#define logf_D(tag, ...)            logFormat(DEBUG, tag, __VA_ARGS__)
+#else
+#define log_D(tag, logInfo)         do { if (0) logMessage(DEBUG, tag, logInfo); } while (0)
+#define logf_D(tag, ...)            do { if (0) logFormat(DEBUG, tag, __VA_ARGS__); } while (0)
 #endif
-}
 
 /* VERBOSE */
-inline void log_V (std::string tag, std::string logInfo)
-{
 #if LOG_LEVEL >= VERBOSE
-    pthread_mutex_lock(&ioMutex);
-    std::cout << "LogV: Tag: " << tag << ": " << logInfo << std::endl;
-    pthread_mutex_unlock(&ioMutex);
+#define log_V(tag, logInfo)         logMessage(VERBOSE, tag, logInfo)
+#define logf_V(tag, ...)            logFormat(VERBOSE, tag, __VA_ARGS__)
+#else
+#define log_V(tag, logInfo)         do { if (0) logMessage(VERBOSE, tag, logInfo); } while (0)
+#define logf_V(tag, ...)            do { if (0) logFormat(VERBOSE, tag, __VA_ARGS__); } while (0)
 #endif
-}
 
-#endif
\ No newline at end of file
+#endif
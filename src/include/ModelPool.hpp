@@ -0,0 +1,87 @@
+/**
+ * \name    ModelPool.hpp
+ *
+ * \brief   Declare the model pool shared by the engines of one process. A model is loaded once by
+ *          its name and reference counted, so the engines of several streams share its sessions.
+ *
+ * \date    Oct 18, 2026
+ */
+
+#ifndef _MODEL_POOL_HPP_
+#define _MODEL_POOL_HPP_
+
+/* ************************************************************************************************
+ * Include Library
+ * ************************************************************************************************
+ */
+#include "App_config.hpp"
+#include "Log.hpp"
+#include "OnnxModels.hpp"
+
+#include <map>
+#include <string>
+
+#include <pthread.h>
+
+using namespace std;
+
+
+/** ===============================================================================================
+ * \name    ModelPool
+ *
+ * \brief   The process-wide pool of the loaded models
+ * ================================================================================================
+ */
+class ModelPool
+{
+/* ************************************************************************************************
+ * Type Define
+ * ************************************************************************************************
+ */
+private:
+    typedef struct {
+        OnnxModel*      model;
+        int             references;
+    }Pooled_Model_t;
+
+/* ************************************************************************************************
+ * Functions
+ * ************************************************************************************************
+ */
+public:
+    /** 
+     * \brief   Take the model of the name, load it on the first acquisition
+     * 
+     * \param   model_name the model you want to load
+     * \param   batch_limit the constraint of batch inference, the first acquisition decides it
+     */
+    template <class Model>
+    static OnnxModel* acquire (string model_name, int batch_limit)
+    {
+        pthread_mutex_lock(&mutex);
+            auto it = models.find(model_name);
+            if (it == models.end())
+            {
+                it = models.insert(make_pair(model_name, Pooled_Model_t{new Model(model_name, batch_limit), 0})).first;
+            } else {
+                log_D("ModelPool", "Share model: " + model_name);
+            }
+            it->second.references++;
+            OnnxModel* model = it->second.model;
+        pthread_mutex_unlock(&mutex);
+
+        return model;
+    }
+
+    static void release (OnnxModel* model);
+
+/* ************************************************************************************************
+ * Parameter
+ * ************************************************************************************************
+ */
+private:
+    static map<string, Pooled_Model_t> models;
+    static pthread_mutex_t mutex;
+};
+
+#endif
@@ -0,0 +1,56 @@
+/**
+ * \name    MosaicPacker.hpp
+ *
+ * \brief   Declare the mosaic packer, which bin-packs the small crops with margins into canvases of
+ *          a detection model, so one detection pass serves several obstacles.
+ *
+ * \date    Oct 18, 2026
+ */
+
+#ifndef _MOSAIC_PACKER_HPP_
+#define _MOSAIC_PACKER_HPP_
+
+/* ************************************************************************************************
+ * Include Library
+ * ************************************************************************************************
+ */
+#include "App_config.hpp"
+
+#include <algorithm>
+#include <vector>
+
+#include <opencv2/opencv.hpp>
+
+using namespace std;
+
+
+/* ************************************************************************************************
+ * Type Define
+ * ************************************************************************************************
+ */
+typedef struct {
+    int         canvas;     // the canvas of the crop, -1 if not packed
+    cv::Rect    rect;       // the place of the crop in the canvas
+}Mosaic_Place_t;
+
+
+/** ===============================================================================================
+ * \name    MosaicPacker
+ *
+ * \brief   Shelf packing in the order of decreasing height. The crops fill a shelf from the left,
+ *          a new shelf starts below the highest crop of the last one, and a new canvas starts once
+ *          a crop does not fit under the last shelf.
+ * ================================================================================================
+ */
+class MosaicPacker
+{
+/* ************************************************************************************************
+ * Functions
+ * ************************************************************************************************
+ */
+public:
+    static int pack (const vector<cv::Size>& sizes, cv::Size canvasSize, int margin, int maxCanvas, vector<Mosaic_Place_t>* places);
+    static int locate (const vector<cv::Rect>& rects, float x, float y);
+};
+
+#endif
@@ -0,0 +1,103 @@
+/**
+ * \name    ObstacleTracker.hpp
+ *
+ * \brief   Declare the obstacle tracker. The lidar boxes of consecutive frames are associated by IoU
+ *          and depth, every track caches the last inference results of its obstacle so a stable
+ *          track could reuse them instead of inferring again.
+ *
+ * \date    Oct 18, 2026
+ */
+
+#ifndef _OBSTACLE_TRACKER_HPP_
+#define _OBSTACLE_TRACKER_HPP_
+
+/* ************************************************************************************************
+ * Include Library
+ * ************************************************************************************************
+ */
+#include "App_config.hpp"
+#include "BoxIoU.hpp"
+#include "Log.hpp"
+#include "ResultBuffer.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+using namespace std;
+
+
+/* ************************************************************************************************
+ * Type Define
+ * ************************************************************************************************
+ */
+typedef struct {
+    float left;
+    float top;
+    float right;
+    float bottom;
+}Track_Box_t;
+
+
+/** ===============================================================================================
+ * \name    ObstacleTracker
+ *
+ * \brief   Greedy association in the order of decreasing IoU. A box matches a track if their IoU is
+ *          above TRACK_IOU and their depths differ less than TRACK_DEPTH_GATE, the unmatched boxes
+ *          start new tracks and a track missed for TRACK_MAX_MISSED frames is dropped.
+ * ================================================================================================
+ */
+class ObstacleTracker
+{
+/* ************************************************************************************************
+ * Class Constructor
+ * ************************************************************************************************
+ */
+public:
+    ObstacleTracker (void);
+
+/* ************************************************************************************************
+ * Type Define
+ * ************************************************************************************************
+ */
+private:
+    typedef struct {
+        int                         id;
+        Track_Box_t                 box;
+        float                       depth;
+        float                       dx;             // the last motion of the box
+        float                       dy;
+        int                         stableFrames;   // consecutive matches with the box moved less than TRACK_STABLE_IOU
+        int                         missed;         // consecutive frames without a match
+
+        /* The cached results and the box they were inferred on */
+        bool                        cached;
+        int                         resultAge;      // frames since the results were inferred
+        Track_Box_t                 resultBox;
+        vector<Inference_Result_t>  results;
+    }Track_t;
+
+/* ************************************************************************************************
+ * Functions
+ * ************************************************************************************************
+ */
+public:
+    void update (const vector<Track_Box_t>& boxes, const vector<float>& depths, vector<int>* trackIds);
+    bool lookup (int trackId, vector<Inference_Result_t>* results);
+    void predict (vector<int>* trackIds, vector<Track_Box_t>* boxes);
+    void store (int trackId, const vector<Inference_Result_t>& results);
+
+private:
+    Track_t* find (int trackId);
+    bool reusable (const Track_t& track, const Track_Box_t& box);
+
+/* ************************************************************************************************
+ * Parameter
+ * ************************************************************************************************
+ */
+private:
+    vector<Track_t> tracks;
+    int nextId;
+};
+
+#endif
@@ -18,14 +18,22 @@
  * ************************************************************************************************
  */
 #include "App_config.hpp"
+#include "CpuPlan.hpp"
+#include "InferenceWatchdog.hpp"
+#include "LatencyProfile.hpp"
 #include "Log.hpp"
+#include "ResultBuffer.hpp"
+#include "Trace.hpp"
 
 // #include <cstring>
+#include <atomic>
 #include <fstream>
 #include <iostream>
+#include <map>
 #include <vector>
 
 #include <assert.h>
+#include <pthread.h>
 #include <sys/time.h>
 #include <onnxruntime/session/onnxruntime_cxx_api.h>
 
@@ -55,7 +63,32 @@ class OnnxModel
  */ 
 public:
     OnnxModel (string model_name, int batch_limit);
-    ~OnnxModel (void);
+    virtual ~OnnxModel (void);
+
+/* ************************************************************************************************
+ * Type Define
+ * ************************************************************************************************
+ */
+public:
+    /* The resumable state of a preempted inference */
+    typedef struct {
+        int                     nextSegment;        // 0 for a new inference
+        int                     batchSize;
+        int                     sampleNum;
+        bool                    keepOutputs;        // keep the outputs in values for Onnx_decode instead of decoding
+        float                   spendTime;
+        vector<Ort::Value>      values;             // the intermediate tensors
+        bool                    preempted;
+        bool                    (*shouldYield) (void* arg);
+        void*                   yieldArg;
+    }Inference_Progress_t;
+
+private:
+    typedef struct {
+        vector<string>          names;
+        vector<vector<float>>   buffers;
+        vector<Ort::Value>      values;
+    }Shared_Initializers_t;
 
 /* ************************************************************************************************
  * Functions
@@ -63,12 +96,27 @@ public:
  */
 public:
     void Onnx_addInput (vector<float> dataStream);
+    void Onnx_popInputs (vector<float>* inputs);
     void Onnx_inference (void);
+    float Onnx_inference (vector<float>& inputData, const timeval* deadline = nullptr, bool* cancelled = nullptr, Inference_Progress_t* progress = nullptr, ResultBuffer* resultBuffer = nullptr);
+    float Onnx_estimateLatency (int batchSize, float percentile = SCHED_LATENCY_PERCENTILE);
+    void Onnx_decode (vector<Ort::Value>& outputs, ResultBuffer* resultBuffer, int sampleNum);
     virtual void dataPreprocess (void* data, vector<float>* preprocessData);
+    virtual void logResults (const ResultBuffer& resultBuffer);
+
+    /* The width and height of the model input, same as the resize in dataPreprocess */
+    int Onnx_inputWidth (void) const {return inputNodeDims[2];}
+    int Onnx_inputHeight (void) const {return inputNodeDims[3];}
 
 private:
     void Onnx_modelSetup (void);
-    virtual void decodeResult (vector<Ort::Value> results);
+    int Onnx_acquireReplica (void);
+    void Onnx_releaseReplica (int replicaId);
+
+    static Ort::Env* Onnx_sharedEnv (void);
+    static Shared_Initializers_t* Onnx_loadSharedInitializers (string family);
+    static float Onnx_readRSS (void);
+    virtual void decodeResult (vector<Ort::Value>& results, ResultBuffer* resultBuffer, int sampleNum);
 
 
 /* ************************************************************************************************
@@ -85,18 +133,27 @@ public:
     /* The inputStreams already filly the batchLimit? */
     bool fullyBatch;
 
-    /* Model is inferencing? */
-    bool busyFlag;
+    /* Number of session replicas are inferencing */
+    atomic<int> busyReplicas;
 
-    /* Last inference spend time */
-    float spendTime;
+    /* Number of inference cancelled by the deadline */
+    atomic<int> cancelCount;
 
-    /* The thread instance of this model, use for inference in thread */
-    pthread_t mthread;
+    /* Last inference spend time, written by the concurrent inference threads */
+    atomic<float> spendTime;
+
+    /* The latency histograms per batch size, use for the schedulers */
+    LatencyProfile* latencyProfile;
+
+    /* The cores of the inference workers and the intra-op threads */
+    vector<int> cpuCores;
 
     /* The model name */
     string modelName;
 
+    /* The model name of the trace events */
+    const char* traceName;
+
 protected:
     /* Stash the input data before inference */
     vector<float> inputStreams;
@@ -109,8 +166,29 @@ protected:
 private:
     /* Used for optimizing the model in setup phase,  */
     Ort::Env *env;
-    Ort::Session *session;
     vector<Ort::AllocatedStringPtr> namesPtr;
+
+    /* The resources shared by all models */
+    static Ort::Env* sharedEnv;
+    static Ort::PrepackedWeightsContainer* sharedPrepackedWeights;
+    static map<string, Shared_Initializers_t*> sharedInitializers;
+
+    /* The session replicas share the prepacked weights of this model, each replica holds the sessions of all segments */
+    vector<vector<Ort::Session*>> sessions;
+    Ort::PrepackedWeightsContainer *prepackedWeights;
+
+    /* The preemptible segments, 1 for the whole model */
+    int segmentNum;
+    vector<vector<const char*>> segmentInputNames;
+    vector<vector<const char*>> segmentOutputNames;
+
+    /* Dispatcher of the idle replicas */
+    vector<int> idleReplicas;
+    pthread_mutex_t replicaMutex;
+    pthread_cond_t replicaCond;
+
+    /* Protect the inputStreams and fullyBatch */
+    pthread_mutex_t stashMutex;
 };
 
 
@@ -140,10 +218,11 @@ public:
 public:
     /* Implement virtual functions */
     void dataPreprocess (void* data, vector<float>* preprocessData) override;
+    void logResults (const ResultBuffer& resultBuffer) override;
 
 private:
     /* Implement virtual functions */
-    void decodeResult (vector<Ort::Value> results) override;
+    void decodeResult (vector<Ort::Value>& results, ResultBuffer* resultBuffer, int sampleNum) override;
 
     /* local functions */
     void loadLabels (void);
@@ -185,10 +264,11 @@ public:
 public:
     /* Implement virtual functions */
     void dataPreprocess (void* data, vector<float>* preprocessData) override;
+    void logResults (const ResultBuffer& resultBuffer) override;
 
 private:
     /* Implement virtual functions */
-    void decodeResult (vector<Ort::Value> results) override;
+    void decodeResult (vector<Ort::Value>& results, ResultBuffer* resultBuffer, int sampleNum) override;
 
     /* local functions */
     void loadLabels (void);
@@ -0,0 +1,79 @@
+/**
+ * \name    OverloadController.hpp
+ *
+ * \brief   Declare the overload controller of the engines. The end-to-end lag from the capture to the
+ *          end of the inference is tracked every frame, and under overload the work of a frame is
+ *          bounded by the policies of OVERLOAD_POLICY instead of accumulating.
+ *
+ * \date    Oct 18, 2026
+ */
+
+#ifndef _OVERLOAD_CONTROLLER_HPP_
+#define _OVERLOAD_CONTROLLER_HPP_
+
+/* ************************************************************************************************
+ * Include Library
+ * ************************************************************************************************
+ */
+#include "App_config.hpp"
+#include "Log.hpp"
+#include "OnnxModels.hpp"
+#include "TaskQueue.hpp"
+
+#include <algorithm>
+#include <vector>
+
+#include <sys/time.h>
+
+using namespace std;
+
+
+/** ===============================================================================================
+ * \name    OverloadController
+ *
+ * \brief   Enter the overload once the smoothed lag exceeds OVERLOAD_LAG_THRESHOLD, leave it once the
+ *          lag drops below OVERLOAD_RECOVER_RATIO of the threshold. The shed work is counted.
+ * ================================================================================================
+ */
+class OverloadController
+{
+/* ************************************************************************************************
+ * Class Constructor
+ * ************************************************************************************************
+ */
+public:
+    OverloadController (void);
+
+/* ************************************************************************************************
+ * Functions
+ * ************************************************************************************************
+ */
+public:
+    void frameSynced (int sensedFrameId);
+    void frameFinished (const timeval& captureTime);
+    bool overloaded (void) const {return overload;}
+
+    int shedTasks (TaskQueue* queue, const vector<OnnxModel*>& models, float budget, vector<Inference_Task_t>* shed);
+    int downgradeTasks (TaskQueue* queue, const vector<OnnxModel*>& models, vector<Inference_Task_t>* shed);
+    void report (void);
+
+/* ************************************************************************************************
+ * Parameter
+ * ************************************************************************************************
+ */
+private:
+    /* The smoothed end-to-end lag in ms */
+    float lag;
+    bool overload;
+    int lastFrameId;
+
+    /* The counters of the run */
+    int frameNum;
+    int overloadFrames;
+    int skippedFrames;
+    int shedTaskNum;
+    int downgradedTaskNum;
+    float maxLag;
+};
+
+#endif
@@ -0,0 +1,107 @@
+/**
+ * \name    Pipeline.hpp
+ *
+ * \brief   Declare the staged pipeline. Every stage owns a bounded lock-free input queue and a pool
+ *          of threads, a stage emits its items into the queue of the next stage and blocks while
+ *          that queue is full.
+ *
+ * \date    Oct 18, 2026
+ */
+
+#ifndef _PIPELINE_HPP_
+#define _PIPELINE_HPP_
+
+/* ************************************************************************************************
+ * Include Library
+ * ************************************************************************************************
+ */
+#include "App_config.hpp"
+#include "Log.hpp"
+#include "RingQueue.hpp"
+#include "Trace.hpp"
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include <pthread.h>
+#include <sched.h>
+#include <semaphore.h>
+#include <sys/time.h>
+
+using namespace std;
+
+
+/** ===============================================================================================
+ * \name    Pipeline
+ *
+ * \brief   A chain of stages. The items are opaque pointers owned by the stage functions, an item
+ *          is passed on by \b emit, or released by the stage function itself.
+ * ================================================================================================
+ */
+class Pipeline
+{
+/* ************************************************************************************************
+ * Type Define
+ * ************************************************************************************************
+ */
+public:
+    /* Process one item, call \b emit to pass it (or new items) to the next stage */
+    typedef void (*Stage_Func_t)(void* item, Pipeline* pipeline, int stageId, void* arg);
+
+private:
+    typedef struct {
+        string                  name;
+        int                     id;
+        Stage_Func_t            func;
+        void*                   arg;
+        Pipeline*               pipeline;
+
+        RingQueue<void*>*       queue;
+        sem_t                   pending;
+        atomic<bool>            closed;
+        vector<pthread_t>       threads;
+
+        /* Statistics */
+        atomic<long>            items;
+        atomic<long>            busyUs;         // in the stage function
+        atomic<long>            blockedUs;      // waiting for the next stage by backpressure
+        atomic<long>            depthSum;       // the queue depth sampled on every push
+        atomic<long>            depthSamples;
+    }Stage_t;
+
+/* ************************************************************************************************
+ * Class Constructor
+ * ************************************************************************************************
+ */
+public:
+    Pipeline (void);
+    ~Pipeline (void);
+
+/* ************************************************************************************************
+ * Functions
+ * ************************************************************************************************
+ */
+public:
+    int addStage (string name, Stage_Func_t func, void* arg, int threadNum = 1, int queueSize = STAGE_QUEUE_SIZE);
+    void start (void);
+    void push (void* item);
+    void emit (int stageId, void* item);
+    void stop (void);
+    void report (void);
+
+private:
+    static void* threadStage (void* arg);
+    void enqueue (int stageId, void* item, Stage_t* producer);
+
+/* ************************************************************************************************
+ * Parameter
+ * ************************************************************************************************
+ */
+private:
+    vector<Stage_t*> stages;
+    bool running;
+    timeval startTime;
+};
+
+#endif
@@ -0,0 +1,96 @@
+/**
+ * \name    ResultBuffer.hpp
+ *
+ * \brief   Declare the typed inference result buffer and the vectorized decode kernels
+ *
+ * \date    Oct 18, 2026
+ */
+
+#ifndef _RESULT_BUFFER_HPP_
+#define _RESULT_BUFFER_HPP_
+
+/* ************************************************************************************************
+ * Include Library
+ * ************************************************************************************************
+ */
+#include "App_config.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+#include <math.h>
+#include <stddef.h>
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+using namespace std;
+
+class OnnxModel;
+
+
+/* ************************************************************************************************
+ * Type Define
+ * ************************************************************************************************
+ */
+typedef struct {
+    OnnxModel*      model;      // the model produced the result
+    int             sampleId;   // the index in the batch
+    int             classId;
+    float           score;
+    float           box[4];     // left, top, right, bottom in the model input coordinates, zero for classification
+}Inference_Result_t;
+
+
+/** ===============================================================================================
+ * \name    ResultBuffer
+ *
+ * \brief   A preallocated result buffer of one frame. The workers append concurrently by reserving
+ *          the slots through an atomic counter, so there is no lock and no reallocation.
+ * ================================================================================================
+ */
+class ResultBuffer
+{
+/* ************************************************************************************************
+ * Class Constructor
+ * ************************************************************************************************
+ */
+public:
+    ResultBuffer (size_t capacity = RESULT_BUFFER_SIZE);
+
+/* ************************************************************************************************
+ * Functions
+ * ************************************************************************************************
+ */
+public:
+    Inference_Result_t* reserve (size_t num);
+    void clear (void) {count.store(0);}
+
+    size_t size (void) const {return min(count.load(), results.size());}
+    Inference_Result_t& operator[] (size_t i) {return results[i];}
+    const Inference_Result_t& operator[] (size_t i) const {return results[i];}
+
+/* ************************************************************************************************
+ * Parameter
+ * ************************************************************************************************
+ */
+private:
+    vector<Inference_Result_t> results;
+    atomic<size_t> count;
+};
+
+
+/* ************************************************************************************************
+ * Decode kernels
+ * ************************************************************************************************
+ */
+int simdArgmax (const float* data, int length);
+float simdMax (const float* data, int length);
+float softmaxScore (const float* data, int length, float maxValue);
+int simdTopK (const float* data, int length, int k, int* indices);
+
+#endif
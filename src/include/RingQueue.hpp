@@ -0,0 +1,151 @@
+/**
+ * \name    RingQueue.hpp
+ *
+ * \brief   Declare a bounded lock-free multi-producer multi-consumer ring queue
+ *
+ * \note    The algorithm follows the Dmitry Vyukov's bounded MPMC queue, every slot carries a
+ *          sequence number so producers and consumers only contend on one atomic counter each.
+ *
+ * \date    Oct 18, 2026
+ */
+
+#ifndef _RING_QUEUE_HPP_
+#define _RING_QUEUE_HPP_
+
+/* ************************************************************************************************
+ * Include Library
+ * ************************************************************************************************
+ */
+#include <atomic>
+#include <vector>
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+
+using namespace std;
+
+
+/** ===============================================================================================
+ * \name    RingQueue
+ *
+ * \brief   A bounded lock-free MPMC queue. The capacity is rounded up to the power of 2.
+ *
+ * \param   T the element type, should be cheap to move (e.g. pointer)
+ * ================================================================================================
+ */
+template <typename T>
+class RingQueue
+{
+/* ************************************************************************************************
+ * Class Constructor
+ * ************************************************************************************************
+ */
+public:
+    RingQueue (size_t capacity) : enqueuePos(0), dequeuePos(0)
+    {
+        size_t size = 2;
+        while (size < capacity) size <<= 1;
+
+        mask = size - 1;
+        slots = vector<Slot_t>(size);
+        for (size_t i = 0; i < size; i++)
+        {
+            slots[i].sequence.store(i, memory_order_relaxed);
+        }
+    }
+
+/* ************************************************************************************************
+ * Type Define
+ * ************************************************************************************************
+ */
+private:
+    typedef struct Slot_t {
+        atomic<size_t>  sequence;
+        T               data;
+
+        Slot_t (void) : sequence(0), data() {}
+        Slot_t (const Slot_t& slot) : sequence(slot.sequence.load()), data(slot.data) {}
+    } Slot_t;
+
+/* ************************************************************************************************
+ * Functions
+ * ************************************************************************************************
+ */
+public:
+    /* Return false if the queue is full */
+    bool push (const T& data)
+    {
+        size_t pos = enqueuePos.load(memory_order_relaxed);
+        for (;;)
+        {
+            Slot_t& slot = slots[pos & mask];
+            size_t sequence = slot.sequence.load(memory_order_acquire);
+            intptr_t diff = (intptr_t) sequence - (intptr_t) pos;
+            if (diff == 0)
+            {
+                if (enqueuePos.compare_exchange_weak(pos, pos + 1, memory_order_relaxed))
+                {
+                    slot.data = data;
+                    slot.sequence.store(pos + 1, memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = enqueuePos.load(memory_order_relaxed);
+            }
+        }
+    }
+
+    /* Return false if the queue is empty */
+    bool pop (T& data)
+    {
+        size_t pos = dequeuePos.load(memory_order_relaxed);
+        for (;;)
+        {
+            Slot_t& slot = slots[pos & mask];
+            size_t sequence = slot.sequence.load(memory_order_acquire);
+            intptr_t diff = (intptr_t) sequence - (intptr_t) (pos + 1);
+            if (diff == 0)
+            {
+                if (dequeuePos.compare_exchange_weak(pos, pos + 1, memory_order_relaxed))
+                {
+                    data = slot.data;
+                    slot.sequence.store(pos + mask + 1, memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = dequeuePos.load(memory_order_relaxed);
+            }
+        }
+    }
+
+    /* Approximate number of elements, only for reporting */
+    size_t size (void) const
+    {
+        size_t head = dequeuePos.load(memory_order_relaxed);
+        size_t tail = enqueuePos.load(memory_order_relaxed);
+        return tail > head ? tail - head : 0;
+    }
+
+    size_t capacity (void) const {return mask + 1;}
+
+/* ************************************************************************************************
+ * Parameter
+ * ************************************************************************************************
+ */
+private:
+    size_t              mask;
+    vector<Slot_t>      slots;
+
+    /* Separate the producer and consumer counters to avoid false sharing */
+    char                padding0[64];
+    atomic<size_t>      enqueuePos;
+    char                padding1[64];
+    atomic<size_t>      dequeuePos;
+};
+
+#endif
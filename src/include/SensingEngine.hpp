@@ -13,8 +13,12 @@
  * Include Library
  * ************************************************************************************************
  */
+#include "App_config.hpp"
+#include "CpuPlan.hpp"
 #include "Log.hpp"
+#include "Trace.hpp"
 
+#include <atomic>
 #include <cstring>
 #include <fstream>
 #include <iostream>
@@ -46,7 +50,7 @@ class SensingEngine
  * ************************************************************************************************
  */ 
 public:
-    SensingEngine ();
+    SensingEngine (string datasetPath = DATASET_PATH);
 
 /* ************************************************************************************************
  * Functions
@@ -58,13 +62,16 @@ public:
     void startNextSensing (void);
 
     bool readyToSync (void) {return dataReadyToSync;}
+    bool finished (void) {return sensingDone;}
+    void takeData (cv::Mat* img, vector<pair<pair<int, int>, float>>* lidarPoints, timeval* capture, int* frameId);
     cv::Mat getCameraData (void) {return cameraData;}
     vector<pair<pair<int, int>, float>> getLidarData (void) {return LidarData;}
 
 private:
     static void* threadSensing (void* arg);
-    void Sensing_Camera (string filePath);
-    void Sensing_Lidar (string filePath);
+    void sense (int frameID);
+    void Sensing_Camera (string filePath, cv::Mat* img);
+    void Sensing_Lidar (string filePath, vector<pair<pair<int, int>, float>>* lidarPoints);
 
 
 /* ************************************************************************************************
@@ -72,7 +79,18 @@ private:
  * ************************************************************************************************
  */
 private:
-    bool dataReadyToSync;
+    atomic<bool> dataReadyToSync;
+    atomic<bool> sensingDone;
+
+    /* Protect the data while the sensing may overwrite an unsynced frame, only held to swap in a loaded frame */
+    pthread_mutex_t dataMutex;
+
+    /* The replayed dataset */
+    string datasetPath;
+
+    /* The capture time and the dataset frame of the data */
+    timeval captureTime;
+    int sensedFrameId;
 
     pthread_t mthread;
 
@@ -0,0 +1,91 @@
+/**
+ * \name    TaskQueue.hpp
+ *
+ * \brief   Declare the inference task queue of the engines. The tasks are kept in one priority heap
+ *          per model, and the summed priority of every model is maintained on push and pop.
+ *
+ * \date    Oct 18, 2026
+ */
+
+#ifndef _TASK_QUEUE_HPP_
+#define _TASK_QUEUE_HPP_
+
+/* ************************************************************************************************
+ * Include Library
+ * ************************************************************************************************
+ */
+#include "App_config.hpp"
+#include "OnnxModels.hpp"
+
+#include <algorithm>
+#include <vector>
+
+using namespace std;
+
+
+/* ************************************************************************************************
+ * Type Define
+ * ************************************************************************************************
+ */
+typedef struct {
+    void*           data;
+    float           priority;
+    OnnxModel*      model;
+}Inference_Task_t;
+
+
+/** ===============================================================================================
+ * \name    TaskQueue
+ *
+ * \brief   Per-model indexed max-heaps of the inference tasks. Push and pop are O(log n), the
+ *          summed priority and the size of a model are O(1).
+ * ================================================================================================
+ */
+class TaskQueue
+{
+/* ************************************************************************************************
+ * Class Constructor
+ * ************************************************************************************************
+ */
+public:
+    TaskQueue (void);
+
+/* ************************************************************************************************
+ * Functions
+ * ************************************************************************************************
+ */
+public:
+    int addModel (OnnxModel* model);
+
+    void push (const Inference_Task_t& task);
+    Inference_Task_t pop (void);
+    Inference_Task_t pop (OnnxModel* model);
+    const Inference_Task_t& top (OnnxModel* model) const;
+
+    float priority (OnnxModel* model) const;
+    size_t size (OnnxModel* model) const;
+    size_t size (void) const {return taskNum;}
+    bool empty (void) const {return taskNum == 0;}
+
+    void snapshot (vector<Inference_Task_t>* tasks) const;
+    void clear (void);
+
+private:
+    int modelIndex (OnnxModel* model) const;
+    static bool lowerPriority (const Inference_Task_t& x, const Inference_Task_t& y) {return x.priority < y.priority;}
+
+/* ************************************************************************************************
+ * Parameter
+ * ************************************************************************************************
+ */
+private:
+    vector<OnnxModel*> models;
+    vector<vector<Inference_Task_t>> heaps;
+
+    /* The summed priority of each model, reset when its heap becomes empty to drop the rounding drift */
+    vector<float> priorities;
+
+    size_t taskNum;
+};
+
+#endif
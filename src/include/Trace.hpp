@@ -0,0 +1,108 @@
+/**
+ * \name    Trace.hpp
+ *
+ * \brief   Trace the timeline of the application. A span writes one event into the buffer of its
+ *          thread without locking, the buffers are exported as Chrome trace events at the end, so
+ *          the overlap of the stages and the threads could be seen in chrome://tracing or Perfetto.
+ *          The macros are compiled out without TRACE_ENABLE.
+ *
+ * \date    Oct 18, 2026
+ */
+
+#ifndef _TRACE_HPP_
+#define _TRACE_HPP_
+
+/* ************************************************************************************************
+ * Include Library
+ * ************************************************************************************************
+ */
+#include "App_config.hpp"
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include <stdint.h>
+#include <time.h>
+
+/* ************************************************************************************************
+ * Type Define
+ * ************************************************************************************************
+ */
+typedef struct {
+    const char*     category;               // string literals or interned by traceIntern
+    const char*     name;
+    uint64_t        start;                  // ns of CLOCK_MONOTONIC
+    uint64_t        duration;               // ns, zero for the instants and the counters
+    long            arg;                    // the frame, the batch size or the counter value
+    char            phase;                  // 'X' complete span, 'i' instant, 'C' counter
+}Trace_Event_t;
+
+/* ************************************************************************************************
+ * Functions
+ * ************************************************************************************************
+ */
+void traceInit (void);
+void traceDestory (void);
+
+void traceThread (const char* name);
+void traceRecord (char phase, const char* category, const char* name, uint64_t start, uint64_t duration, long arg);
+const char* traceIntern (const std::string& str);
+
+inline uint64_t traceNow (void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000000000ull + now.tv_nsec;
+}
+
+
+/** ===============================================================================================
+ * \name    TraceSpan
+ *
+ * \brief   Record a complete event from the construction to the destruction of the scope
+ * ================================================================================================
+ */
+class TraceSpan
+{
+public:
+    TraceSpan (const char* category, const char* name, long arg = -1)
+        : category(category), name(name), arg(arg), start(traceNow()) {}
+
+    ~TraceSpan (void)
+    {
+        traceRecord('X', category, name, start, traceNow() - start, arg);
+    }
+
+private:
+    const char* category;
+    const char* name;
+    long arg;
+    uint64_t start;
+};
+
+/* ************************************************************************************************
+ * Trace Macros
+ *
+ * TRACE_SCOPE spans the rest of the enclosing scope, the arg shows up in the event as "arg" and
+ * is omitted if negative. The names must outlive the export, e.g. string literals.
+ * ************************************************************************************************
+ */
+#define TRACE_CONCAT_(a, b)                         a##b
+#define TRACE_CONCAT(a, b)                          TRACE_CONCAT_(a, b)
+
+#if TRACE_ENABLE
+#define TRACE_SCOPE(category, name)                 TraceSpan TRACE_CONCAT(traceSpan, __LINE__)(category, name)
+#define TRACE_SCOPE_ARG(category, name, arg)        TraceSpan TRACE_CONCAT(traceSpan, __LINE__)(category, name, (long)(arg))
+#define TRACE_INSTANT(category, name, arg)          traceRecord('i', category, name, traceNow(), 0, (long)(arg))
+#define TRACE_COUNTER(category, name, value)        traceRecord('C', category, name, traceNow(), 0, (long)(value))
+#define TRACE_THREAD(name)                          traceThread(name)
+#else
+#define TRACE_SCOPE(category, name)                 ((void)0)
+#define TRACE_SCOPE_ARG(category, name, arg)        ((void)0)
+#define TRACE_INSTANT(category, name, arg)          ((void)0)
+#define TRACE_COUNTER(category, name, value)        ((void)0)
+#define TRACE_THREAD(name)                          ((void)0)
+#endif
+
+#endif
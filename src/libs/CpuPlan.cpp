@@ -0,0 +1,182 @@
+/**
+ * \name    CpuPlan.cpp
+ *
+ * \brief   Implement the API
+ *
+ * \date    Oct 18, 2026
+ */
+
+#include "../include/CpuPlan.hpp"
+
+atomic<int> CpuPlan::nextModelPool(0);
+
+/** ===============================================================================================
+ * \name    cores
+ *
+ * \brief   The core set of a role, empty if the plan is disabled
+ * ================================================================================================
+ */
+vector<int>
+CpuPlan::cores (Cpu_Role_t role)
+{
+#if CPU_PLAN
+    switch (role)
+    {
+        case CPU_ROLE_SENSING:      return parse(CPU_SET_SENSING);
+        case CPU_ROLE_ENGINE:       return parse(CPU_SET_ENGINE);
+        case CPU_ROLE_INFERENCE:    return parse(CPU_SET_INFERENCE);
+    }
+#endif
+    return vector<int>();
+}
+
+
+/** ===============================================================================================
+ * \name    modelCores
+ *
+ * \brief   Take the core pool of the next model. With CPU_ISOLATE_MODELS the inference cores are
+ *          split evenly into CPU_MODEL_POOLS disjoint pools, otherwise every model shares all of
+ *          them. Called once per model at setup.
+ * ================================================================================================
+ */
+vector<int>
+CpuPlan::modelCores (void)
+{
+    vector<int> inferenceCores = cores(CPU_ROLE_INFERENCE);
+#if CPU_ISOLATE_MODELS
+    int poolNum = max(1, min((int)CPU_MODEL_POOLS, (int)inferenceCores.size()));
+    int pool = nextModelPool++ % poolNum;
+
+    /* pool p takes the cores [p * n / poolNum, (p + 1) * n / poolNum) */
+    int n = inferenceCores.size();
+    return vector<int>(inferenceCores.begin() + pool * n / poolNum, inferenceCores.begin() + (pool + 1) * n / poolNum);
+#else
+    return inferenceCores;
+#endif
+}
+
+
+/** ===============================================================================================
+ * \name    intraOpAffinities
+ *
+ * \brief   The value of the session config "session.intra_op_thread_affinities". The first intra-op
+ *          thread is the calling worker, each of the other threads is pinned to one core. ORT takes
+ *          1-based logical processor ids.
+ *
+ * \param   cores the cores of the model
+ * \param   threadNum the intra-op threads of the session
+ * ================================================================================================
+ */
+string
+CpuPlan::intraOpAffinities (const vector<int>& cores, int threadNum)
+{
+    string affinities;
+    for (int i = 1; i < threadNum && !cores.empty(); i++)
+    {
+        if (i > 1) affinities += ";";
+        affinities += to_string(cores[i % cores.size()] + 1);
+    }
+    return affinities;
+}
+
+
+/** ===============================================================================================
+ * \name    pinThread
+ *
+ * \brief   Pin the calling thread by its role
+ * ================================================================================================
+ */
+bool
+CpuPlan::pinThread (Cpu_Role_t role)
+{
+#if CPU_PLAN
+    switch (role)
+    {
+        case CPU_ROLE_SENSING:      return pinThread(cores(role), CPU_FIFO_SENSING);
+        case CPU_ROLE_ENGINE:       return pinThread(cores(role), CPU_FIFO_ENGINE);
+        case CPU_ROLE_INFERENCE:    return pinThread(cores(role), 0);
+    }
+#endif
+    return true;
+}
+
+
+/** ===============================================================================================
+ * \name    pinThread
+ *
+ * \brief   Pin the calling thread onto the cores and set its scheduling policy. The threads inherit
+ *          the policy of their creator, so a zero priority resets to SCHED_OTHER explicitly.
+ *
+ * \param   cores the cores, empty to keep the affinity
+ * \param   fifoPriority the SCHED_FIFO priority, 0 for SCHED_OTHER
+ *
+ * \return  false if the affinity or the policy is not applied, e.g. without CAP_SYS_NICE
+ * ================================================================================================
+ */
+bool
+CpuPlan::pinThread (const vector<int>& cores, int fifoPriority)
+{
+    bool applied = true;
+
+    if (!cores.empty())
+    {
+        cpu_set_t cpuset;
+        CPU_ZERO(&cpuset);
+        for (auto core : cores) CPU_SET(core, &cpuset);
+
+        int error = pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuset);
+        if (error)
+        {
+            log_W("CpuPlan", "Set affinity failed: " + string(strerror(error)));
+            applied = false;
+        }
+    }
+
+    struct sched_param param;
+    param.sched_priority = fifoPriority;
+    int error = pthread_setschedparam(pthread_self(), fifoPriority > 0 ? SCHED_FIFO : SCHED_OTHER, &param);
+    if (error)
+    {
+        log_W("CpuPlan", "Set SCHED_FIFO " + to_string(fifoPriority) + " failed: " + string(strerror(error)));
+        applied = false;
+    }
+
+    return applied;
+}
+
+
+/** ===============================================================================================
+ * \name    parse
+ *
+ * \brief   Parse a core set like "0-3,6" into the core list, without the cores not online
+ * ================================================================================================
+ */
+vector<int>
+CpuPlan::parse (const string& coreSet)
+{
+    long onlineCores = sysconf(_SC_NPROCESSORS_ONLN);
+    if (onlineCores <= 0) onlineCores = CPU_SETSIZE;
+
+    vector<int> cores;
+    stringstream stream(coreSet);
+    string range;
+
+    while (getline(stream, range, ','))
+    {
+        if (range.empty()) continue;
+
+        size_t dash = range.find('-');
+        int first = stoi(range.substr(0, dash));
+        int last = dash == string::npos ? first : stoi(range.substr(dash + 1));
+        for (int core = first; core <= last && core < CPU_SETSIZE; core++)
+        {
+            if (core >= onlineCores)
+            {
+                log_W("CpuPlan", "Core " + to_string(core) + " of \"" + coreSet + "\" is not online, dropped");
+                continue;
+            }
+            cores.push_back(core);
+        }
+    }
+    return cores;
+}
@@ -0,0 +1,375 @@
+/**
+ * \name    DetectionFusion.cpp
+ *
+ * \brief   Implement the API
+ *
+ * \date    Oct 18, 2026
+ */
+
+#include "../include/DetectionFusion.hpp"
+
+/** ===============================================================================================
+ * \name    permute
+ *
+ * \brief   Reorder the array by the indices
+ * ================================================================================================
+ */
+template <typename T>
+static void
+permute (vector<T>& values, const vector<int>& order)
+{
+    vector<T> sorted(values.size());
+    for (size_t i = 0; i < order.size(); i++) sorted[i] = values[order[i]];
+    values.swap(sorted);
+}
+
+
+/** ===============================================================================================
+ * \name    DetectionFusion
+ *
+ * \brief   Construct the detection fusion
+ *
+ * \param   method FUSION_NMS or FUSION_WBF
+ * \param   iouThreshold the boxes of the same class above it are merged
+ * \param   scoreThreshold the detections below it are dropped before fusion
+ * ================================================================================================
+ */
+DetectionFusion::DetectionFusion (int method, float iouThreshold, float scoreThreshold)
+    : method(method), iouThreshold(iouThreshold), scoreThreshold(scoreThreshold), modelNum(0)
+{
+
+}
+
+
+/** ===============================================================================================
+ * \name    fuse
+ *
+ * \brief   Fuse the detections of the frame into \b results
+ *
+ * \param   resultBuffer the decoded results of the frame
+ * \param   models the detection models to fuse, the results of other models are ignored
+ * \param   imgWidth the width of the source image
+ * \param   imgHeight the height of the source image
+ *
+ * \return  the spend time of the fusion in ms
+ * ================================================================================================
+ */
+float
+DetectionFusion::fuse (const ResultBuffer& resultBuffer, const vector<OnnxModel*>& models, int imgWidth, int imgHeight)
+{
+    struct timeval start, end;
+    gettimeofday(&start, NULL);
+
+    fused.clear();
+    collect(resultBuffer, models, imgWidth, imgHeight);
+    sortByClass();
+
+    /* ******************************************
+     * Fuse the boxes of each class
+     * ******************************************
+     */
+    int boxNum = classId.size();
+    suppressed.assign(boxNum, 0);
+    members.reserve(boxNum);
+
+    for (int begin = 0; begin < boxNum;)
+    {
+        int end = begin + 1;
+        while (end < boxNum && classId[end] == classId[begin]) end++;
+
+        fuseClass(begin, end);
+        begin = end;
+    }
+
+    gettimeofday(&end, NULL);
+    float spendTime = (1000000 * (end.tv_sec - start.tv_sec) + (end.tv_usec - start.tv_usec)) * 0.001;
+    log_D("DetectionFusion", "Fuse " + to_string(boxNum) + " boxes into " + to_string(fused.size()) +
+                             " in " + to_string(spendTime) + " ms");
+
+    return spendTime;
+}
+
+
+/** ===============================================================================================
+ * \name    logResults
+ *
+ * \brief   Log the fused detections
+ * ================================================================================================
+ */
+void
+DetectionFusion::logResults (void)
+{
+    log_I("DetectionFusion", "Model, x0, y0, x1, y1, class id, confidence");
+    for (auto& result: fused)
+    {
+        string logInfo;
+        logInfo  = result.model->modelName + ", ";
+        logInfo += to_string(result.box[0]) + ", ";
+        logInfo += to_string(result.box[1]) + ", ";
+        logInfo += to_string(result.box[2]) + ", ";
+        logInfo += to_string(result.box[3]) + ", ";
+        logInfo += to_string(result.classId) + ", ";
+        logInfo += to_string(result.score);
+
+        log_I("DetectionFusion", logInfo);
+    }
+}
+
+
+/** ===============================================================================================
+ * \name    offset
+ *
+ * \brief   Move the fused detections, the source image was a region of the frame
+ *
+ * \param   dx the left of the region in the frame
+ * \param   dy the top of the region in the frame
+ * ================================================================================================
+ */
+void
+DetectionFusion::offset (float dx, float dy)
+{
+    for (auto& result : fused)
+    {
+        result.box[0] += dx;
+        result.box[1] += dy;
+        result.box[2] += dx;
+        result.box[3] += dy;
+    }
+}
+
+
+/** ===============================================================================================
+ * \name    append
+ *
+ * \brief   Add the detections kept from the last frame into the fused detections
+ * ================================================================================================
+ */
+void
+DetectionFusion::append (const vector<Inference_Result_t>& results)
+{
+    fused.insert(fused.end(), results.begin(), results.end());
+}
+
+
+/** ===============================================================================================
+ * \name    collect
+ *
+ * \brief   Gather the detections above the score threshold and scale the boxes from the model input
+ *          to the source image
+ * ================================================================================================
+ */
+void
+DetectionFusion::collect (const ResultBuffer& resultBuffer, const vector<OnnxModel*>& models, int imgWidth, int imgHeight)
+{
+    x0.clear(); y0.clear(); x1.clear(); y1.clear(); area.clear(); score.clear();
+    classId.clear(); source.clear();
+
+    /* the scale of each model, the preprocess resizes the whole image without letterbox */
+    vector<pair<float, float>> scales;
+    for (auto model: models)
+    {
+        scales.emplace_back((float)imgWidth / model->Onnx_inputWidth(), (float)imgHeight / model->Onnx_inputHeight());
+    }
+
+    vector<bool> contributed(models.size(), false);
+    for (size_t i = 0; i < resultBuffer.size(); i++)
+    {
+        const Inference_Result_t& result = resultBuffer[i];
+        if (result.score < scoreThreshold) continue;
+
+        /* the sort key holds 16-bit indices */
+        if (classId.size() > 0xFFFF)
+        {
+            log_W("DetectionFusion", "Too many detections, the rest are dropped");
+            break;
+        }
+
+        size_t m = find(models.begin(), models.end(), result.model) - models.begin();
+        if (m == models.size()) continue;
+        contributed[m] = true;
+
+        float left   = result.box[0] * scales[m].first;
+        float top    = result.box[1] * scales[m].second;
+        float right  = result.box[2] * scales[m].first;
+        float bottom = result.box[3] * scales[m].second;
+
+        x0.push_back(left);
+        y0.push_back(top);
+        x1.push_back(right);
+        y1.push_back(bottom);
+        area.push_back((right - left) * (bottom - top));
+        score.push_back(result.score);
+        classId.push_back(result.classId);
+        source.push_back(result.model);
+    }
+
+    modelNum = count(contributed.begin(), contributed.end(), true);
+}
+
+
+/** ===============================================================================================
+ * \name    sortByClass
+ *
+ * \brief   Reorder the boxes by class, then by descending score. The class, the inverted score bits
+ *          and the index are packed into one 64-bit key, so the sort compares plain integers instead
+ *          of chasing the indices. The bits of a non-negative float keep its order.
+ * ================================================================================================
+ */
+void
+DetectionFusion::sortByClass (void)
+{
+    int boxNum = classId.size();
+    keys.resize(boxNum);
+    for (int i = 0; i < boxNum; i++)
+    {
+        uint32_t scoreBits;
+        memcpy(&scoreBits, &score[i], sizeof(scoreBits));
+        keys[i] = ((uint64_t)(uint16_t)classId[i] << 48) | ((uint64_t)(~scoreBits) << 16) | (uint16_t)i;
+    }
+    sort(keys.begin(), keys.end());
+
+    order.resize(boxNum);
+    for (int i = 0; i < boxNum; i++) order[i] = keys[i] & 0xFFFF;
+
+    permute(x0, order); permute(y0, order); permute(x1, order); permute(y1, order);
+    permute(area, order); permute(score, order); permute(classId, order); permute(source, order);
+}
+
+
+/** ===============================================================================================
+ * \name    fuseClass
+ *
+ * \brief   Greedy clustering of one class in descending score. Every unsuppressed box starts a
+ *          cluster with all the remaining boxes above the IoU threshold. NMS keeps the first box,
+ *          WBF averages the cluster by the scores.
+ *
+ * \param   begin the first box of the class
+ * \param   end past the last box of the class
+ * ================================================================================================
+ */
+void
+DetectionFusion::fuseClass (int begin, int end)
+{
+    matched.resize(end - begin);
+
+    for (int i = begin; i < end; i++)
+    {
+        if (suppressed[i]) continue;
+        suppressed[i] = 1;
+
+        float box[4] = {x0[i], y0[i], x1[i], y1[i]};
+        int rest = end - i - 1;
+        int matchNum = simdIouMatch(x0.data() + i + 1, y0.data() + i + 1, x1.data() + i + 1, y1.data() + i + 1, area.data() + i + 1,
+                                    rest, box, area[i], iouThreshold, matched.data());
+
+        members.clear();
+        members.push_back(i);
+        for (int j = 0; j < rest && matchNum > 0; j++)
+        {
+            if (!matched[j]) continue;
+            matchNum--;
+            if (suppressed[i + 1 + j]) continue;
+            suppressed[i + 1 + j] = 1;
+            members.push_back(i + 1 + j);
+        }
+
+        Inference_Result_t result;
+        result.model    = source[i];
+        result.sampleId = 0;
+        result.classId  = classId[i];
+        result.score    = score[i];
+        copy(box, box + 4, result.box);
+
+        if (method == FUSION_WBF && members.size() > 1)
+        {
+            float weight = 0;
+            float fusedBox[4] = {0, 0, 0, 0};
+            for (int m: members)
+            {
+                fusedBox[0] += x0[m] * score[m];
+                fusedBox[1] += y0[m] * score[m];
+                fusedBox[2] += x1[m] * score[m];
+                fusedBox[3] += y1[m] * score[m];
+                weight += score[m];
+            }
+            for (int k = 0; k < 4; k++) result.box[k] = fusedBox[k] / weight;
+
+            /* the objects found by fewer models are less confident */
+            int clusterSize = members.size();
+            result.score = weight / clusterSize * min(clusterSize, modelNum) / modelNum;
+        }
+
+        fused.push_back(result);
+    }
+}
+
+
+/** ===============================================================================================
+ * \name    simdIouMatch
+ *
+ * \brief   Compare one box against an array of boxes. The IoU test is rewritten without division as
+ *          inter * (1 + threshold) > threshold * (area + boxArea).
+ *
+ * \param   mask the output flags, 1 if the IoU is above the threshold
+ *
+ * \return  the number of matched boxes
+ * ================================================================================================
+ */
+int
+simdIouMatch (const float* x0, const float* y0, const float* x1, const float* y1, const float* area,
+              int length, const float box[4], float boxArea, float threshold, uint8_t* mask)
+{
+    int i = 0;
+    int matchNum = 0;
+
+#if defined(__ARM_NEON)
+    float32x4_t bx0 = vdupq_n_f32(box[0]), by0 = vdupq_n_f32(box[1]);
+    float32x4_t bx1 = vdupq_n_f32(box[2]), by1 = vdupq_n_f32(box[3]);
+    float32x4_t barea = vdupq_n_f32(boxArea), zero = vdupq_n_f32(0);
+    float32x4_t scale = vdupq_n_f32(1 + threshold), thr = vdupq_n_f32(threshold);
+    for (; i + 4 <= length; i += 4)
+    {
+        float32x4_t w = vmaxq_f32(vsubq_f32(vminq_f32(vld1q_f32(x1 + i), bx1), vmaxq_f32(vld1q_f32(x0 + i), bx0)), zero);
+        float32x4_t h = vmaxq_f32(vsubq_f32(vminq_f32(vld1q_f32(y1 + i), by1), vmaxq_f32(vld1q_f32(y0 + i), by0)), zero);
+        float32x4_t inter = vmulq_f32(w, h);
+        uint32x4_t hit = vcgtq_f32(vmulq_f32(inter, scale), vmulq_f32(thr, vaddq_f32(vld1q_f32(area + i), barea)));
+
+        uint32_t lanes[4];
+        vst1q_u32(lanes, hit);
+        for (int k = 0; k < 4; k++)
+        {
+            mask[i + k] = lanes[k] & 1;
+            matchNum += mask[i + k];
+        }
+    }
+#elif defined(__SSE2__)
+    __m128 bx0 = _mm_set1_ps(box[0]), by0 = _mm_set1_ps(box[1]);
+    __m128 bx1 = _mm_set1_ps(box[2]), by1 = _mm_set1_ps(box[3]);
+    __m128 barea = _mm_set1_ps(boxArea), zero = _mm_setzero_ps();
+    __m128 scale = _mm_set1_ps(1 + threshold), thr = _mm_set1_ps(threshold);
+    for (; i + 4 <= length; i += 4)
+    {
+        __m128 w = _mm_max_ps(_mm_sub_ps(_mm_min_ps(_mm_loadu_ps(x1 + i), bx1), _mm_max_ps(_mm_loadu_ps(x0 + i), bx0)), zero);
+        __m128 h = _mm_max_ps(_mm_sub_ps(_mm_min_ps(_mm_loadu_ps(y1 + i), by1), _mm_max_ps(_mm_loadu_ps(y0 + i), by0)), zero);
+        __m128 inter = _mm_mul_ps(w, h);
+        int hit = _mm_movemask_ps(_mm_cmpgt_ps(_mm_mul_ps(inter, scale), _mm_mul_ps(thr, _mm_add_ps(_mm_loadu_ps(area + i), barea))));
+
+        for (int k = 0; k < 4; k++)
+        {
+            mask[i + k] = (hit >> k) & 1;
+            matchNum += mask[i + k];
+        }
+    }
+#endif
+
+    /* the tail, or the whole array without SIMD */
+    for (; i < length; i++)
+    {
+        float w = max(min(x1[i], box[2]) - max(x0[i], box[0]), 0.0f);
+        float h = max(min(y1[i], box[3]) - max(y0[i], box[1]), 0.0f);
+        mask[i] = w * h * (1 + threshold) > threshold * (area[i] + boxArea);
+        matchNum += mask[i];
+    }
+
+    return matchNum;
+}
@@ -0,0 +1,388 @@
+/**
+ * \name    EdfDispatcher.cpp
+ *
+ * \brief   Implement the API
+ *
+ * \date    Oct 18, 2026
+ */
+
+#include "../include/EdfDispatcher.hpp"
+
+/** ===============================================================================================
+ * \name    EdfDispatcher
+ *
+ * \brief   Construct the dispatcher on the inference workers of the executor
+ *
+ * \param   executor the executor with the models added
+ * ================================================================================================
+ */
+EdfDispatcher::EdfDispatcher (InferenceExecutor* executor)
+    : executor(executor), running(false), totalFrames(0), totalTasks(0), totalDone(0), totalMiss(0)
+{
+    sem_init(&event, 0, 0);
+    pthread_mutex_init(&mutex, NULL);
+}
+
+
+/** ===============================================================================================
+ * \name    ~EdfDispatcher
+ *
+ * \brief   Stop the dispatcher and release the model slots
+ * ================================================================================================
+ */
+EdfDispatcher::~EdfDispatcher (void)
+{
+    stop();
+
+    for (auto slot : slots)
+    {
+        delete slot;
+    }
+    sem_destroy(&event);
+    pthread_mutex_destroy(&mutex);
+}
+
+
+/** ===============================================================================================
+ * \name    addModel
+ *
+ * \param   model the model added into the executor
+ * \param   slotNum the number of batches of the model in flight, the workers of the model
+ * ================================================================================================
+ */
+void
+EdfDispatcher::addModel (OnnxModel* model, int slotNum)
+{
+    Model_Slot_t* slot = new Model_Slot_t();
+    slot->model = model;
+    slot->slots = slotNum;
+    slots.push_back(slot);
+}
+
+
+/** ===============================================================================================
+ * \name    start
+ *
+ * \brief   Start the dispatching thread
+ * ================================================================================================
+ */
+void
+EdfDispatcher::start (void)
+{
+    if (running.exchange(true)) return;
+    pthread_create(&mthread, NULL, EdfDispatcher::threadDispatcher, this);
+}
+
+
+/** ===============================================================================================
+ * \name    stop
+ *
+ * \brief   Drop the pending tasks as deadline misses, wait for the in-flight batches and join the
+ *          dispatching thread
+ * ================================================================================================
+ */
+void
+EdfDispatcher::stop (void)
+{
+    if (!running.exchange(false)) return;
+
+    sem_post(&event);
+    pthread_join(mthread, NULL);
+}
+
+
+/** ===============================================================================================
+ * \name    submitFrame
+ *
+ * \brief   Admit the tasks of a frame. The tasks are preprocessed here in the caller thread, and
+ *          carry the absolute deadline release + SENSING_PERIOD * PIPELINE_DEADLINE_PERIODS.
+ *
+ * \param   frameId the id of the frame
+ * \param   release the release time of the frame
+ * \param   tasks the tasks of the frame
+ * ================================================================================================
+ */
+void
+EdfDispatcher::submitFrame (int frameId, const timeval& release, const vector<Inference_Task_t>& tasks)
+{
+    int relativeDeadline = SENSING_PERIOD * PIPELINE_DEADLINE_PERIODS;
+    struct timeval period = {relativeDeadline / 1000, (relativeDeadline % 1000) * 1000};
+
+    Frame_Stat_t frame;
+    frame.taskNum   = tasks.size();
+    frame.doneNum   = 0;
+    frame.missNum   = 0;
+    frame.release   = release;
+    frame.results   = new ResultBuffer();
+    timeradd(&release, &period, &frame.deadline);
+
+    /* ******************************************
+     * Preprocess outside the lock
+     * ******************************************
+     */
+    vector<Edf_Task_t*> edfTasks;
+    for (auto& task : tasks)
+    {
+        Edf_Task_t* edfTask = new Edf_Task_t();
+        edfTask->task       = task;
+        edfTask->frameId    = frameId;
+        edfTask->deadline   = frame.deadline;
+        edfTask->input.resize(task.model->singleInputSize);
+        task.model->dataPreprocess(task.data, &edfTask->input);
+        edfTasks.push_back(edfTask);
+    }
+
+    pthread_mutex_lock(&mutex);
+        frames[frameId] = frame;
+        for (auto edfTask : edfTasks)
+        {
+            auto slot = find_if(slots.begin(), slots.end(), [edfTask](Model_Slot_t* s) {return s->model == edfTask->task.model;});
+            if (slot == slots.end())
+            {
+                frames[frameId].missNum++;
+                delete edfTask;
+                continue;
+            }
+            (*slot)->heap.push_back(edfTask);
+            push_heap((*slot)->heap.begin(), (*slot)->heap.end(), laterDeadline);
+        }
+    pthread_mutex_unlock(&mutex);
+
+    sem_post(&event);
+    log_D("EdfDispatcher", "Admit frame " + to_string(frameId) + " with " + to_string(tasks.size()) + " tasks");
+}
+
+
+/** ===============================================================================================
+ * \name    report
+ *
+ * \brief   Log the totals of the run
+ * ================================================================================================
+ */
+void
+EdfDispatcher::report (void)
+{
+    pthread_mutex_lock(&mutex);
+        float missRatio = totalTasks ? (float)totalMiss / totalTasks : 0;
+        log_I("EdfDispatcher", "Frames: " + to_string(totalFrames) + ", tasks: " + to_string(totalTasks) +
+                               ", done: " + to_string(totalDone) + ", deadline misses: " + to_string(totalMiss) +
+                               " (" + to_string(missRatio * 100) + "%)");
+    pthread_mutex_unlock(&mutex);
+}
+
+
+/** ===============================================================================================
+ * \name    laterDeadline
+ *
+ * \brief   The heap order, the earliest deadline then the most priority on the top
+ * ================================================================================================
+ */
+bool
+EdfDispatcher::laterDeadline (const Edf_Task_t* x, const Edf_Task_t* y)
+{
+    if (timercmp(&x->deadline, &y->deadline, !=)) return timercmp(&x->deadline, &y->deadline, >);
+    return x->task.priority < y->task.priority;
+}
+
+
+/** ===============================================================================================
+ * \name    reapBatches
+ *
+ * \brief   Account the finished batches into their frames and free the model slots
+ * ================================================================================================
+ */
+void
+EdfDispatcher::reapBatches (void)
+{
+    struct timeval now;
+    gettimeofday(&now, NULL);
+
+    for (auto it = inflight.begin(); it != inflight.end();)
+    {
+        if (!it->job->isDone())
+        {
+            it++;
+            continue;
+        }
+
+        /* consume the completion, the worker could still be posting it */
+        it->job->wait();
+
+        Frame_Stat_t& frame = frames[it->frameId];
+        if (it->job->cancelled || timercmp(&now, &it->deadline, >))
+        {
+            frame.missNum += it->taskNum;
+        } else {
+            frame.doneNum += it->taskNum;
+        }
+
+        it->slot->slots++;
+        delete it->job;
+        it = inflight.erase(it);
+    }
+}
+
+
+/** ===============================================================================================
+ * \name    dropExpired
+ *
+ * \brief   Drop the pending tasks already passed their deadline, or all pending tasks once stopped
+ * ================================================================================================
+ */
+void
+EdfDispatcher::dropExpired (void)
+{
+    bool dropAll = !running.load();
+
+    for (auto slot : slots)
+    {
+        while (!slot->heap.empty() && (dropAll || InferenceWatchdog::expired(slot->heap.front()->deadline)))
+        {
+            pop_heap(slot->heap.begin(), slot->heap.end(), laterDeadline);
+            Edf_Task_t* edfTask = slot->heap.back();
+            slot->heap.pop_back();
+
+            frames[edfTask->frameId].missNum++;
+            delete edfTask;
+        }
+    }
+}
+
+
+/** ===============================================================================================
+ * \name    dispatchBatches
+ *
+ * \brief   While any model has a free worker, dispatch the earliest deadline batch of these models
+ * ================================================================================================
+ */
+void
+EdfDispatcher::dispatchBatches (void)
+{
+    TRACE_SCOPE("dispatcher", "dispatch");
+    for (;;)
+    {
+        Model_Slot_t* best = nullptr;
+        for (auto slot : slots)
+        {
+            if (slot->slots <= 0 || slot->heap.empty()) continue;
+            if (!best || laterDeadline(best->heap.front(), slot->heap.front())) best = slot;
+        }
+        if (!best) break;
+
+        /* ******************************************
+         * Batch the tasks of the same frame
+         * ******************************************
+         */
+        OnnxModel* model = best->model;
+        int frameId = best->heap.front()->frameId;
+        timeval deadline = best->heap.front()->deadline;
+
+        int taskNum = 0;
+        bool urgent = false;
+        while (!best->heap.empty() && taskNum < model->batchLimit && best->heap.front()->frameId == frameId)
+        {
+            pop_heap(best->heap.begin(), best->heap.end(), laterDeadline);
+            Edf_Task_t* edfTask = best->heap.back();
+            best->heap.pop_back();
+
+            urgent |= edfTask->task.priority >= URGENT_TASK_PRIORITY;
+            model->Onnx_addInput(move(edfTask->input));
+            taskNum++;
+            delete edfTask;
+        }
+
+        InferenceJob* job = executor->submit(model, &deadline, urgent, frames[frameId].results, &event);
+        inflight.push_back({job, best, frameId, taskNum, deadline});
+        best->slots--;
+
+        log_V("EdfDispatcher", "Dispatch " + to_string(taskNum) + " tasks of frame " + to_string(frameId) + " to " + model->modelName);
+    }
+}
+
+
+/** ===============================================================================================
+ * \name    closeFrames
+ *
+ * \brief   Report the frames with all tasks accounted
+ *
+ * \param   flush close all frames, the unaccounted tasks are deadline misses
+ * ================================================================================================
+ */
+void
+EdfDispatcher::closeFrames (bool flush)
+{
+    struct timeval now;
+    gettimeofday(&now, NULL);
+
+    for (auto it = frames.begin(); it != frames.end();)
+    {
+        Frame_Stat_t& frame = it->second;
+        if (!flush && frame.doneNum + frame.missNum < frame.taskNum)
+        {
+            it++;
+            continue;
+        }
+        frame.missNum = frame.taskNum - frame.doneNum;
+
+        float responseTime = (1000000 * (now.tv_sec - frame.release.tv_sec) + (now.tv_usec - frame.release.tv_usec)) * 0.001;
+        log_I("EdfDispatcher", "Frame " + to_string(it->first) + ": done " + to_string(frame.doneNum) + "/" + to_string(frame.taskNum) +
+                               ", deadline misses: " + to_string(frame.missNum) + ", response: " + to_string(responseTime) + " ms");
+
+#if LOG_RESULTS
+        for (auto slot : slots)
+        {
+            slot->model->logResults(*frame.results);
+        }
+#endif
+
+        totalFrames++;
+        totalTasks += frame.taskNum;
+        totalDone  += frame.doneNum;
+        totalMiss  += frame.missNum;
+
+        delete frame.results;
+        it = frames.erase(it);
+    }
+}
+
+
+/** ===============================================================================================
+ * \name    threadDispatcher
+ *
+ * \brief   Wake up on the frame submission, the job completion or every SENSING_PERIOD, then reap,
+ *          drop and dispatch
+ *
+ * \param   arg the pointer of the EdfDispatcher
+ * ================================================================================================
+ */
+void*
+EdfDispatcher::threadDispatcher (void* arg)
+{
+    EdfDispatcher* dispatcher = (EdfDispatcher*) arg;
+    CpuPlan::pinThread(CPU_ROLE_ENGINE);
+    TRACE_THREAD("dispatcher");
+
+    log_D("EdfDispatcher", "Dispatcher start");
+    for (;;)
+    {
+        struct timeval now, period = {SENSING_PERIOD / 1000, (SENSING_PERIOD % 1000) * 1000}, wakeUp;
+        gettimeofday(&now, NULL);
+        timeradd(&now, &period, &wakeUp);
+        struct timespec timeout = {wakeUp.tv_sec, wakeUp.tv_usec * 1000};
+        sem_timedwait(&dispatcher->event, &timeout);
+
+        pthread_mutex_lock(&dispatcher->mutex);
+            dispatcher->reapBatches();
+            dispatcher->dropExpired();
+            dispatcher->dispatchBatches();
+
+            bool finished = !dispatcher->running.load() && dispatcher->inflight.empty();
+            dispatcher->closeFrames(finished);
+        pthread_mutex_unlock(&dispatcher->mutex);
+
+        if (finished) break;
+    }
+    log_D("EdfDispatcher", "Dispatcher stop");
+
+    pthread_exit(nullptr);
+}
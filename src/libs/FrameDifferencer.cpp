@@ -0,0 +1,200 @@
+/**
+ * \name    FrameDifferencer.cpp
+ *
+ * \brief   Implement the API
+ *
+ * \date    Oct 18, 2026
+ */
+
+#include "../include/FrameDifferencer.hpp"
+
+/** ===============================================================================================
+ * \name    FrameDifferencer
+ *
+ * \param   blockSize the side of a block in pixels
+ * \param   threshold the mean absolute difference per byte above which a block is changed
+ * ================================================================================================
+ */
+FrameDifferencer::FrameDifferencer (int blockSize, float threshold)
+    : blockSize(blockSize), threshold(threshold), frameCols(0), frameRows(0), blockCols(0), blockRows(0), changedNum(0)
+{
+
+}
+
+
+/** ===============================================================================================
+ * \name    update
+ *
+ * \brief   Compare the frame with the reference, the frame is kept by \b updateReference only if it
+ *          is inferred
+ *
+ * \param   img the 8-bit frame
+ *
+ * \return  the number of changed blocks
+ * ================================================================================================
+ */
+int
+FrameDifferencer::update (const cv::Mat& img)
+{
+    int cols = (img.cols + blockSize - 1) / blockSize;
+    int rows = (img.rows + blockSize - 1) / blockSize;
+    int channels = img.channels();
+    frameCols = img.cols;
+    frameRows = img.rows;
+
+    /* ******************************************
+     * Changed everywhere without a comparable
+     * reference
+     * ******************************************
+     */
+    if (reference.empty() || reference.rows != img.rows || reference.cols != img.cols || reference.type() != img.type())
+    {
+        blockCols = cols;
+        blockRows = rows;
+        changed.assign(cols * rows, 1);
+        changedNum = changed.size();
+        return changedNum;
+    }
+
+    /* ******************************************
+     * Sum the SAD of every block row by row
+     * ******************************************
+     */
+    vector<uint32_t> blockSad(cols);
+    changedNum = 0;
+    for (int by = 0; by < rows; by++)
+    {
+        int top = by * blockSize;
+        int bottom = min(img.rows, top + blockSize);
+        blockSad.assign(cols, 0);
+
+        for (int y = top; y < bottom; y++)
+        {
+            const uint8_t* current = img.ptr<uint8_t>(y);
+            const uint8_t* last = reference.ptr<uint8_t>(y);
+            for (int bx = 0; bx < cols; bx++)
+            {
+                int left = bx * blockSize;
+                int width = min(img.cols, left + blockSize) - left;
+                blockSad[bx] += simdSad(current + left * channels, last + left * channels, width * channels);
+            }
+        }
+
+        for (int bx = 0; bx < cols; bx++)
+        {
+            int width = min(img.cols, (bx + 1) * blockSize) - bx * blockSize;
+            float meanDiff = (float)blockSad[bx] / (width * (bottom - top) * channels);
+            changed[by * cols + bx] = meanDiff > threshold;
+            changedNum += changed[by * cols + bx];
+        }
+    }
+
+    return changedNum;
+}
+
+
+/** ===============================================================================================
+ * \name    updateReference
+ *
+ * \brief   Copy the inferred region of the frame into the reference, so the slow motion piles up
+ *          against the last inferred pixels instead of fading between consecutive frames
+ *
+ * \param   img the frame of the last update
+ * \param   region the inferred region in pixels, the whole frame for a full inference
+ * ================================================================================================
+ */
+void
+FrameDifferencer::updateReference (const cv::Mat& img, const cv::Rect& region)
+{
+    cv::Rect clipped = region & cv::Rect(0, 0, img.cols, img.rows);
+    bool whole = clipped.area() == img.cols * img.rows;
+
+    if (whole || reference.rows != img.rows || reference.cols != img.cols || reference.type() != img.type())
+    {
+        /* a partial region could not seed a reference of another size */
+        if (whole) img.copyTo(reference);
+        return;
+    }
+
+    img(clipped).copyTo(reference(clipped));
+}
+
+
+/** ===============================================================================================
+ * \name    changedRegion
+ *
+ * \brief   The bounding rectangle of the changed blocks of the last update
+ *
+ * \param   marginBlocks the blocks added around the changed ones, the objects crossing the border of
+ *          the changed blocks are kept whole
+ *
+ * \return  the region in pixels, empty if nothing changed
+ * ================================================================================================
+ */
+cv::Rect
+FrameDifferencer::changedRegion (int marginBlocks) const
+{
+    int left = blockCols, top = blockRows, right = -1, bottom = -1;
+    for (int by = 0; by < blockRows; by++)
+    {
+        for (int bx = 0; bx < blockCols; bx++)
+        {
+            if (!changed[by * blockCols + bx]) continue;
+            left = min(left, bx);
+            right = max(right, bx);
+            top = min(top, by);
+            bottom = max(bottom, by);
+        }
+    }
+    if (right < 0) return cv::Rect(0, 0, 0, 0);
+
+    left = max(0, left - marginBlocks) * blockSize;
+    top = max(0, top - marginBlocks) * blockSize;
+    right = min(frameCols, (right + 1 + marginBlocks) * blockSize);
+    bottom = min(frameRows, (bottom + 1 + marginBlocks) * blockSize);
+
+    return cv::Rect(left, top, right - left, bottom - top);
+}
+
+
+/** ===============================================================================================
+ * \name    simdSad
+ *
+ * \brief   The sum of absolute differences of two byte arrays
+ * ================================================================================================
+ */
+uint32_t
+simdSad (const uint8_t* a, const uint8_t* b, int length)
+{
+    int i = 0;
+    uint32_t sad = 0;
+
+#if defined(__ARM_NEON)
+    uint32x4_t acc = vdupq_n_u32(0);
+    for (; i + 16 <= length; i += 16)
+    {
+        uint8x16_t diff = vabdq_u8(vld1q_u8(a + i), vld1q_u8(b + i));
+        acc = vpadalq_u16(acc, vpaddlq_u8(diff));
+    }
+    uint32_t lanes[4];
+    vst1q_u32(lanes, acc);
+    sad = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+#elif defined(__SSE2__)
+    __m128i acc = _mm_setzero_si128();
+    for (; i + 16 <= length; i += 16)
+    {
+        __m128i va = _mm_loadu_si128((const __m128i*)(a + i));
+        __m128i vb = _mm_loadu_si128((const __m128i*)(b + i));
+        acc = _mm_add_epi64(acc, _mm_sad_epu8(va, vb));
+    }
+    sad = _mm_cvtsi128_si32(acc) + _mm_cvtsi128_si32(_mm_srli_si128(acc, 8));
+#endif
+
+    /* the tail, or the whole array without SIMD */
+    for (; i < length; i++)
+    {
+        sad += a[i] > b[i] ? a[i] - b[i] : b[i] - a[i];
+    }
+
+    return sad;
+}
@@ -0,0 +1,421 @@
+/**
+ * \name    InferenceExecutor.cpp
+ *
+ * \brief   Implement the API
+ *
+ * \date    Oct 18, 2026
+ */
+
+#include "../include/InferenceExecutor.hpp"
+
+/** ===============================================================================================
+ * \name    InferenceJob
+ *
+ * \brief   Construct the completion handle of a batch
+ *
+ * \param   model the model to inference
+ * ================================================================================================
+ */
+InferenceJob::InferenceJob (OnnxModel* model) : model(model), spendTime(0), hasDeadline(false), cancelled(false), urgent(false), results(nullptr), notify(nullptr), done(false), revoked(false)
+{
+    progress.nextSegment    = 0;
+    progress.batchSize      = 0;
+    progress.spendTime      = 0;
+    progress.preempted      = false;
+    progress.keepOutputs    = false;
+    progress.shouldYield    = nullptr;
+    progress.yieldArg       = nullptr;
+
+    sem_init(&completion, 0, 0);
+}
+
+
+/** ===============================================================================================
+ * \name    ~InferenceJob
+ *
+ * \brief   Destruct the completion handle, the job should be finished
+ * ================================================================================================
+ */
+InferenceJob::~InferenceJob (void)
+{
+    sem_destroy(&completion);
+}
+
+
+/** ===============================================================================================
+ * \name    wait
+ *
+ * \brief   Block until the worker finish the batch and leave the job. Call exactly once, even if
+ *          \b isDone, the job could be deleted after it returns.
+ * ================================================================================================
+ */
+void
+InferenceJob::wait (void)
+{
+    while (sem_wait(&completion) != 0 && errno == EINTR);
+}
+
+
+/** ===============================================================================================
+ * \name    revoke
+ *
+ * \brief   Withdraw the job, a job not started yet is finished as cancelled without inference. A 
+ *          started job runs to the end.
+ * ================================================================================================
+ */
+void
+InferenceJob::revoke (void)
+{
+    revoked.store(true, memory_order_release);
+}
+
+
+/** ===============================================================================================
+ * \name    finish
+ *
+ * \brief   Mark the job as finished and wake up the waiter, called by the worker
+ * ================================================================================================
+ */
+void
+InferenceJob::finish (void)
+{
+    /* the job could be deleted once the completion is posted, it is the last access */
+    sem_t* finishNotify = notify;
+
+    done.store(true, memory_order_release);
+    sem_post(&completion);
+    if (finishNotify) sem_post(finishNotify);
+}
+
+
+
+/** ===============================================================================================
+ * \name    InferenceExecutor
+ *
+ * \brief   Construct an executor without any worker
+ * ================================================================================================
+ */
+InferenceExecutor::InferenceExecutor (void) : running(true)
+{
+
+}
+
+
+/** ===============================================================================================
+ * \name    ~InferenceExecutor
+ *
+ * \brief   Join all workers
+ * ================================================================================================
+ */
+InferenceExecutor::~InferenceExecutor (void)
+{
+    stop();
+}
+
+
+/** ===============================================================================================
+ * \name    addModel
+ *
+ * \brief   Create the submission queue and the long-lived workers of the model
+ *
+ * \param   model the model served by the workers
+ * \param   workerNum the number of workers
+ * ================================================================================================
+ */
+void
+InferenceExecutor::addModel (OnnxModel* model, int workerNum)
+{
+    if (queues.count(model)) return;
+
+    Model_Queue_t* queue = new Model_Queue_t();
+    queue->model    = model;
+    queue->jobs         = new RingQueue<InferenceJob*>(EXECUTOR_QUEUE_SIZE);
+    queue->urgentJobs   = new RingQueue<InferenceJob*>(EXECUTOR_QUEUE_SIZE);
+    queue->resumedJobs  = new RingQueue<InferenceJob*>(EXECUTOR_QUEUE_SIZE);
+    queue->executor     = this;
+    queue->urgentPending = 0;
+    sem_init(&queue->pending, 0, 0);
+    pthread_mutex_init(&queue->urgentMutex, NULL);
+    pthread_cond_init(&queue->urgentDrained, NULL);
+
+    queue->workers.resize(workerNum);
+    for (auto& worker : queue->workers)
+    {
+        pthread_create(&worker, NULL, InferenceExecutor::threadWorker, (void*)queue);
+    }
+    queues[model] = queue;
+
+    log_D("InferenceExecutor", "Create " + to_string(workerNum) + " workers for " + model->modelName);
+}
+
+
+/** ===============================================================================================
+ * \name    submit
+ *
+ * \brief   Submit the stashed inputs of the model as one batch
+ *
+ * \param   model the model with stashed inputs through \b Onnx_addInput
+ * \param   deadline the absolute deadline of the batch, nullptr for no deadline
+ * \param   urgent the batch preempts the running segmented batches at their next segment boundary
+ * \param   results the result buffer for the decoded results, nullptr to skip decoding
+ * \param   notify the semaphore posted when the job is finished, nullptr for none
+ *
+ * \return  the completion handle, the caller should delete it after \b wait
+ * ================================================================================================
+ */
+InferenceJob*
+InferenceExecutor::submit (OnnxModel* model, const timeval* deadline, bool urgent, ResultBuffer* results, sem_t* notify)
+{
+    assert(queues.count(model) && "model is not added into the executor");
+    Model_Queue_t* queue = queues[model];
+
+    InferenceJob* job = new InferenceJob(model);
+    model->Onnx_popInputs(&job->inputStreams);
+    if (deadline)
+    {
+        job->hasDeadline = true;
+        job->deadline = *deadline;
+    }
+
+    job->urgent = urgent;
+    job->results = results;
+    job->notify = notify;
+    job->progress.shouldYield = urgent ? nullptr : InferenceExecutor::urgentWaiting;
+    job->progress.yieldArg = queue;
+    if (urgent) queue->urgentPending++;
+
+    /* backpressure: wait for the workers to drain the queue */
+    while (!(urgent ? queue->urgentJobs : queue->jobs)->push(job))
+    {
+        sched_yield();
+    }
+    sem_post(&queue->pending);
+
+    /* wake up the workers waiting to resume, one of them could take the urgent job */
+    if (urgent)
+    {
+        pthread_mutex_lock(&queue->urgentMutex);
+            pthread_cond_broadcast(&queue->urgentDrained);
+        pthread_mutex_unlock(&queue->urgentMutex);
+    }
+
+    return job;
+}
+
+
+/** ===============================================================================================
+ * \name    stop
+ *
+ * \brief   Cancel the queued jobs and join all workers. The running jobs are finished by their
+ *          workers, so no waiter is left blocked.
+ * ================================================================================================
+ */
+void
+InferenceExecutor::stop (void)
+{
+    if (!running.exchange(false)) return;
+
+    for (auto& it : queues)
+    {
+        Model_Queue_t* queue = it.second;
+        cancelQueuedJobs(queue);
+
+        pthread_mutex_lock(&queue->urgentMutex);
+            pthread_cond_broadcast(&queue->urgentDrained);
+        pthread_mutex_unlock(&queue->urgentMutex);
+
+        for (size_t i = 0; i < queue->workers.size(); i++)
+        {
+            sem_post(&queue->pending);
+        }
+        for (auto worker : queue->workers)
+        {
+            pthread_join(worker, NULL);
+        }
+
+        /* the jobs preempted while stopping are requeued by the workers */
+        cancelQueuedJobs(queue);
+
+        sem_destroy(&queue->pending);
+        pthread_mutex_destroy(&queue->urgentMutex);
+        pthread_cond_destroy(&queue->urgentDrained);
+        delete queue->jobs;
+        delete queue->urgentJobs;
+        delete queue->resumedJobs;
+        delete queue;
+    }
+    queues.clear();
+}
+
+
+/** ===============================================================================================
+ * \name    urgentWaiting
+ *
+ * \brief   The preemption check of the normal jobs, yield if any urgent job of the same model is
+ *          waiting. The other models keep running.
+ *
+ * \param   arg the pointer of the Model_Queue_t
+ * ================================================================================================
+ */
+bool
+InferenceExecutor::urgentWaiting (void* arg)
+{
+    return ((Model_Queue_t*) arg)->urgentPending.load() > 0;
+}
+
+
+/** ===============================================================================================
+ * \name    urgentFinished
+ *
+ * \brief   Count down a finished urgent job, the preempted jobs resume once none is left
+ *
+ * \param   queue the queue of the urgent job
+ * ================================================================================================
+ */
+void
+InferenceExecutor::urgentFinished (Model_Queue_t* queue)
+{
+    if (--queue->urgentPending > 0) return;
+
+    pthread_mutex_lock(&queue->urgentMutex);
+        pthread_cond_broadcast(&queue->urgentDrained);
+    pthread_mutex_unlock(&queue->urgentMutex);
+}
+
+
+/** ===============================================================================================
+ * \name    waitUrgentJobs
+ *
+ * \brief   Sleep until the urgent jobs of the model are finished, or until one of them is queued
+ *          and this worker could run it, or until the executor is stopped
+ *
+ * \param   queue the queue of the calling worker
+ * ================================================================================================
+ */
+void
+InferenceExecutor::waitUrgentJobs (Model_Queue_t* queue)
+{
+    pthread_mutex_lock(&queue->urgentMutex);
+        while (queue->urgentPending.load() > 0 && queue->urgentJobs->size() == 0 && queue->executor->running.load())
+        {
+            pthread_cond_wait(&queue->urgentDrained, &queue->urgentMutex);
+        }
+    pthread_mutex_unlock(&queue->urgentMutex);
+}
+
+
+/** ===============================================================================================
+ * \name    cancelJob
+ *
+ * \brief   Finish a job as cancelled without inference, a preempted job drops its progress
+ *
+ * \param   queue the queue of the job
+ * \param   job the job not running on any worker
+ * ================================================================================================
+ */
+void
+InferenceExecutor::cancelJob (Model_Queue_t* queue, InferenceJob* job)
+{
+    job->cancelled = true;
+    job->progress.nextSegment = 0;
+    job->progress.values.clear();
+
+    if (job->urgent) urgentFinished(queue);
+    job->finish();
+}
+
+
+/** ===============================================================================================
+ * \name    cancelQueuedJobs
+ *
+ * \brief   Cancel the jobs left in the urgent, resumed and normal queues of the model
+ *
+ * \param   queue the queue to drain
+ * ================================================================================================
+ */
+void
+InferenceExecutor::cancelQueuedJobs (Model_Queue_t* queue)
+{
+    int cancelNum = 0;
+    InferenceJob* job;
+    while (queue->urgentJobs->pop(job) || queue->resumedJobs->pop(job) || queue->jobs->pop(job))
+    {
+        cancelJob(queue, job);
+        cancelNum++;
+    }
+
+    if (cancelNum > 0) log_W(queue->model->modelName, "Cancel " + to_string(cancelNum) + " queued jobs at stop");
+}
+
+
+/** ===============================================================================================
+ * \name    threadWorker
+ *
+ * \brief   Keep inference the submitted batches of one model
+ *
+ * \param   arg the pointer of the Model_Queue_t
+ * ================================================================================================
+ */
+void*
+InferenceExecutor::threadWorker (void* arg)
+{
+    Model_Queue_t* queue = (Model_Queue_t*) arg;
+    OnnxModel* model = queue->model;
+    CpuPlan::pinThread(model->cpuCores);
+    TRACE_THREAD(traceIntern("worker " + model->modelName));
+
+    log_D(model->modelName, "Inference worker start");
+    for (;;)
+    {
+        sem_wait(&queue->pending);
+
+        /* ******************************************
+         * The urgent jobs go first, then the 
+         * preempted jobs, then the normal jobs
+         * ******************************************
+         */
+        InferenceJob* job;
+        if (queue->urgentJobs->pop(job)) {
+        } else if (queue->resumedJobs->pop(job)) {
+            /* ******************************************
+             * Let the urgent jobs of this model finish
+             * before resuming. If one is queued, run it
+             * first and requeue the preempted job.
+             * ******************************************
+             */
+            waitUrgentJobs(queue);
+            if (queue->urgentJobs->size() > 0)
+            {
+                while (!queue->resumedJobs->push(job)) sched_yield();
+                sem_post(&queue->pending);
+                continue;
+            }
+        } else if (!queue->jobs->pop(job)) {
+            /* woken up by stop() with nothing left to do */
+            if (!queue->executor->running.load()) break;
+            continue;
+        }
+
+        if (job->isRevoked() && job->progress.nextSegment == 0)
+        {
+            cancelJob(queue, job);
+            continue;
+        }
+
+        job->spendTime = model->Onnx_inference(job->inputStreams, job->hasDeadline ? &job->deadline : nullptr, &job->cancelled, &job->progress, job->results);
+        if (job->progress.preempted)
+        {
+            logf_D(model->modelName, "Preempted by urgent job, resume later");
+            while (!queue->resumedJobs->push(job)) sched_yield();
+            sem_post(&queue->pending);
+            continue;
+        }
+
+        if (!job->cancelled) model->spendTime = job->spendTime;
+        if (job->urgent) urgentFinished(queue);
+        job->finish();
+    }
+    log_D(model->modelName, "Inference worker stop");
+
+    pthread_exit(nullptr);
+}
@@ -0,0 +1,171 @@
+/**
+ * \name    InferenceWatchdog.cpp
+ *
+ * \brief   Implement the API
+ *
+ * \date    Oct 18, 2026
+ */
+
+#include "../include/InferenceWatchdog.hpp"
+
+/** ===============================================================================================
+ * \name    InferenceWatchdog
+ *
+ * \brief   Construct the watchdog and start the watching thread
+ * ================================================================================================
+ */
+InferenceWatchdog::InferenceWatchdog (void) : nextId(0)
+{
+    pthread_mutex_init(&mutex, NULL);
+    pthread_cond_init(&cond, NULL);
+    pthread_create(&mthread, NULL, InferenceWatchdog::threadWatchdog, this);
+}
+
+
+/** ===============================================================================================
+ * \name    instance
+ *
+ * \brief   The watchdog is shared by all models
+ * ================================================================================================
+ */
+InferenceWatchdog*
+InferenceWatchdog::instance (void)
+{
+    static InferenceWatchdog* watchdog = new InferenceWatchdog();
+    return watchdog;
+}
+
+
+/** ===============================================================================================
+ * \name    expired
+ *
+ * \brief   Check whether the absolute deadline is already passed
+ * ================================================================================================
+ */
+bool
+InferenceWatchdog::expired (const timeval& deadline)
+{
+    struct timeval now;
+    gettimeofday(&now, NULL);
+    return timercmp(&now, &deadline, >=);
+}
+
+
+/** ===============================================================================================
+ * \name    watch
+ *
+ * \brief   Start watching a run
+ *
+ * \param   runOptions the RunOptions passed into \b Ort::Session::Run
+ * \param   deadline the absolute deadline of the run
+ *
+ * \return  the watch id for \b unwatch
+ * ================================================================================================
+ */
+int
+InferenceWatchdog::watch (Ort::RunOptions* runOptions, const timeval& deadline)
+{
+    pthread_mutex_lock(&mutex);
+        int watchId = nextId++;
+        entries[watchId] = {runOptions, deadline, false};
+        pthread_cond_signal(&cond);
+    pthread_mutex_unlock(&mutex);
+
+    return watchId;
+}
+
+
+/** ===============================================================================================
+ * \name    unwatch
+ *
+ * \brief   Stop watching a run, must be called before the RunOptions is destroyed
+ *
+ * \return  true if the run was terminated by the watchdog
+ * ================================================================================================
+ */
+bool
+InferenceWatchdog::unwatch (int watchId)
+{
+    bool terminated = false;
+    pthread_mutex_lock(&mutex);
+        auto it = entries.find(watchId);
+        if (it != entries.end())
+        {
+            terminated = it->second.terminated;
+            entries.erase(it);
+        }
+    pthread_mutex_unlock(&mutex);
+
+    return terminated;
+}
+
+
+/** ===============================================================================================
+ * \name    fired
+ *
+ * \brief   Check whether the watchdog has terminated the run, the run keeps being watched
+ * ================================================================================================
+ */
+bool
+InferenceWatchdog::fired (int watchId)
+{
+    bool terminated = false;
+    pthread_mutex_lock(&mutex);
+        auto it = entries.find(watchId);
+        if (it != entries.end()) terminated = it->second.terminated;
+    pthread_mutex_unlock(&mutex);
+
+    return terminated;
+}
+
+
+/** ===============================================================================================
+ * \name    threadWatchdog
+ *
+ * \brief   Sleep until the earliest deadline, then terminate all expired runs
+ *
+ * \param   arg the pointer of the InferenceWatchdog
+ * ================================================================================================
+ */
+void*
+InferenceWatchdog::threadWatchdog (void* arg)
+{
+    InferenceWatchdog* watchdog = (InferenceWatchdog*) arg;
+    CpuPlan::pinThread(CPU_ROLE_ENGINE);
+
+    pthread_mutex_lock(&watchdog->mutex);
+    for (;;)
+    {
+        /* find the earliest deadline of the running inference */
+        bool hasDeadline = false;
+        timeval earliest;
+        for (auto& entry : watchdog->entries)
+        {
+            if (entry.second.terminated) continue;
+
+            if (expired(entry.second.deadline))
+            {
+                entry.second.runOptions->SetTerminate();
+                entry.second.terminated = true;
+                log_D("InferenceWatchdog", "Terminate inference " + to_string(entry.first));
+                continue;
+            }
+            if (!hasDeadline || timercmp(&entry.second.deadline, &earliest, <))
+            {
+                earliest = entry.second.deadline;
+                hasDeadline = true;
+            }
+        }
+
+        if (hasDeadline)
+        {
+            struct timespec wakeUp = {earliest.tv_sec, earliest.tv_usec * 1000};
+            pthread_cond_timedwait(&watchdog->cond, &watchdog->mutex, &wakeUp);
+        } else {
+            pthread_cond_wait(&watchdog->cond, &watchdog->mutex);
+        }
+    }
+    pthread_mutex_unlock(&watchdog->mutex);
+
+    pthread_exit(nullptr);
+}
@@ -0,0 +1,133 @@
+/**
+ * \name    KnapsackSolver.cpp
+ *
+ * \brief   Implement the API
+ *
+ * \date    Oct 18, 2026
+ */
+
+#include "../include/KnapsackSolver.hpp"
+
+/** ===============================================================================================
+ * \name    KnapsackSolver
+ *
+ * \brief   Construct the solver
+ *
+ * \param   resolution the budget unit in ms, the costs are rounded up to it
+ * ================================================================================================
+ */
+KnapsackSolver::KnapsackSolver (float resolution) : resolution(resolution)
+{
+
+}
+
+
+/** ===============================================================================================
+ * \name    clear
+ *
+ * \brief   Remove all groups, keep the tables for the next frame
+ * ================================================================================================
+ */
+void
+KnapsackSolver::clear (void)
+{
+    groups.clear();
+}
+
+
+/** ===============================================================================================
+ * \name    addGroup
+ *
+ * \return  the group id for \b addOption
+ * ================================================================================================
+ */
+int
+KnapsackSolver::addGroup (void)
+{
+    groups.emplace_back();
+    return groups.size() - 1;
+}
+
+
+/** ===============================================================================================
+ * \name    addOption
+ *
+ * \param   group the group id from \b addGroup
+ * \param   cost the latency of the option in ms
+ * \param   value the priority of the option
+ * ================================================================================================
+ */
+void
+KnapsackSolver::addOption (int group, float cost, float value)
+{
+    Option_t option = {(int)ceil(cost / resolution), value};
+    groups[group].push_back(option);
+}
+
+
+/** ===============================================================================================
+ * \name    solve
+ *
+ * \brief   Pick at most one option of each group, maximize the total value within the budget
+ *
+ * \param   budget the time budget in ms
+ * \param   choices the picked option index of each group, -1 for none
+ *
+ * \return  the total value of the picked options
+ * ================================================================================================
+ */
+float
+KnapsackSolver::solve (float budget, vector<int>* choices)
+{
+    int groupNum = groups.size();
+    choices->assign(groupNum, -1);
+    if (groupNum == 0 || budget <= 0) return 0;
+
+    int capacity = (int)floor(budget / resolution);
+    best.assign(capacity + 1, 0);
+    next.resize(capacity + 1);
+    picked.resize(groupNum * (capacity + 1));
+
+    /* ******************************************
+     * Fill the table group by group
+     * ******************************************
+     */
+    for (int g = 0; g < groupNum; g++)
+    {
+        int* pick = &picked[g * (capacity + 1)];
+        for (int c = 0; c <= capacity; c++)
+        {
+            next[c] = best[c];
+            pick[c] = -1;
+        }
+
+        for (int o = 0; o < (int)groups[g].size(); o++)
+        {
+            const Option_t& option = groups[g][o];
+            for (int c = option.cost; c <= capacity; c++)
+            {
+                float value = best[c - option.cost] + option.value;
+                if (value > next[c])
+                {
+                    next[c] = value;
+                    pick[c] = o;
+                }
+            }
+        }
+        best.swap(next);
+    }
+
+    /* ******************************************
+     * Trace back the picked options
+     * ******************************************
+     */
+    int c = capacity;
+    for (int g = groupNum - 1; g >= 0; g--)
+    {
+        int o = picked[g * (capacity + 1) + c];
+        (*choices)[g] = o;
+        if (o >= 0) c -= groups[g][o].cost;
+    }
+
+    return best[capacity];
+}
@@ -0,0 +1,374 @@
+/**
+ * \name    LatencyProfile.cpp
+ *
+ * \brief   Implement the API
+ *
+ * \date    Oct 18, 2026
+ */
+
+#include "../include/LatencyProfile.hpp"
+
+/** ===============================================================================================
+ * \name    LatencyHistogram
+ *
+ * \brief   Construct an empty histogram
+ * ================================================================================================
+ */
+LatencyHistogram::LatencyHistogram (void) : count(0), maxLatency(0), sum(0), buckets(LATENCY_BUCKET_NUM, 0)
+{
+
+}
+
+
+/** ===============================================================================================
+ * \name    record
+ *
+ * \brief   Add one latency sample into the histogram
+ *
+ * \param   latency the measured latency in ms
+ * ================================================================================================
+ */
+void
+LatencyHistogram::record (float latency)
+{
+    buckets[bucketOf(latency)]++;
+    count++;
+    sum += latency;
+    maxLatency = max(maxLatency, latency);
+}
+
+
+/** ===============================================================================================
+ * \name    percentile
+ *
+ * \brief   Estimate the latency percentile by the upper edge of the matched bucket
+ *
+ * \param   p the percentile in [0, 1]
+ *
+ * \return  the estimated latency in ms, or 0 if there is no sample
+ * ================================================================================================
+ */
+float
+LatencyHistogram::percentile (float p) const
+{
+    if (count == 0) return 0;
+
+    uint64_t rank = (uint64_t) ceil(p * count);
+    if (rank == 0) rank = 1;
+
+    uint64_t accumulate = 0;
+    for (int i = 0; i < LATENCY_BUCKET_NUM; i++)
+    {
+        accumulate += buckets[i];
+        if (accumulate >= rank)
+        {
+            /* never report more than the real worst case */
+            return min(bucketUpper(i), maxLatency);
+        }
+    }
+
+    return maxLatency;
+}
+
+
+/** ===============================================================================================
+ * \name    serialize
+ *
+ * \brief   Dump the histogram into one line: "count sum max n bucket:count ..."
+ * ================================================================================================
+ */
+string
+LatencyHistogram::serialize (void) const
+{
+    ostringstream stream;
+    int nonEmpty = 0;
+    for (auto bucket : buckets) nonEmpty += (bucket != 0);
+
+    stream << count << " " << sum << " " << maxLatency << " " << nonEmpty;
+    for (int i = 0; i < LATENCY_BUCKET_NUM; i++)
+    {
+        if (buckets[i]) stream << " " << i << ":" << buckets[i];
+    }
+
+    return stream.str();
+}
+
+
+/** ===============================================================================================
+ * \name    deserialize
+ *
+ * \brief   Restore the histogram from the format of \b serialize
+ *
+ * \return  false if the stream is broken
+ * ================================================================================================
+ */
+bool
+LatencyHistogram::deserialize (istringstream& stream)
+{
+    int nonEmpty;
+    if (!(stream >> count >> sum >> maxLatency >> nonEmpty)) return false;
+
+    for (int i = 0; i < nonEmpty; i++)
+    {
+        int bucket;
+        char colon;
+        uint32_t bucketCount;
+        if (!(stream >> bucket >> colon >> bucketCount) || bucket < 0 || bucket >= LATENCY_BUCKET_NUM) return false;
+        buckets[bucket] = bucketCount;
+    }
+
+    return true;
+}
+
+
+/** ===============================================================================================
+ * \name    bucketOf
+ *
+ * \brief   Map the latency into the logarithmic bucket index
+ * ================================================================================================
+ */
+int
+LatencyHistogram::bucketOf (float latency)
+{
+    if (latency <= LATENCY_BUCKET_MIN) return 0;
+
+    int bucket = (int) (log(latency / LATENCY_BUCKET_MIN) / log(LATENCY_BUCKET_GROWTH));
+    return min(bucket, LATENCY_BUCKET_NUM - 1);
+}
+
+
+/** ===============================================================================================
+ * \name    bucketUpper
+ *
+ * \brief   The upper edge of the bucket in ms
+ * ================================================================================================
+ */
+float
+LatencyHistogram::bucketUpper (int bucket)
+{
+    return LATENCY_BUCKET_MIN * pow(LATENCY_BUCKET_GROWTH, bucket + 1);
+}
+
+
+
+/** ===============================================================================================
+ * \name    LatencyProfile
+ *
+ * \brief   Construct the latency profile of a model
+ *
+ * \param   model_name the profile is stored as LATENCY_PROFILE_PATH + model_name + ".latency"
+ * ================================================================================================
+ */
+LatencyProfile::LatencyProfile (string model_name) : modelName(model_name)
+{
+    filePath = LATENCY_PROFILE_PATH + modelName + ".latency";
+    pthread_mutex_init(&mutex, NULL);
+}
+
+
+/** ===============================================================================================
+ * \name    ~LatencyProfile
+ *
+ * \brief   Destruct the latency profile
+ * ================================================================================================
+ */
+LatencyProfile::~LatencyProfile (void)
+{
+    pthread_mutex_destroy(&mutex);
+}
+
+
+/** ===============================================================================================
+ * \name    record
+ *
+ * \brief   Record the latency of one inference
+ *
+ * \param   batchSize the executed batch size
+ * \param   latency the measured latency in ms
+ * ================================================================================================
+ */
+void
+LatencyProfile::record (int batchSize, float latency)
+{
+    pthread_mutex_lock(&mutex);
+        histograms[batchSize].record(latency);
+    pthread_mutex_unlock(&mutex);
+}
+
+
+/** ===============================================================================================
+ * \name    getPercentile
+ *
+ * \brief   Query the latency percentile of the batch size
+ *
+ * \param   batchSize the batch size going to execute
+ * \param   p the percentile in [0, 1], e.g. 0.95 for the p95 latency
+ *
+ * \return  the estimated latency in ms, or 0 if the model is never profiled
+ * ================================================================================================
+ */
+float
+LatencyProfile::getPercentile (int batchSize, float p)
+{
+    float latency = 0;
+    pthread_mutex_lock(&mutex);
+        LatencyHistogram* histogram = findHistogram(batchSize);
+        if (histogram) latency = histogram->percentile(p);
+    pthread_mutex_unlock(&mutex);
+
+    return latency;
+}
+
+
+/** ===============================================================================================
+ * \name    getMax
+ *
+ * \brief   Query the worst observed latency of the batch size
+ * ================================================================================================
+ */
+float
+LatencyProfile::getMax (int batchSize)
+{
+    float latency = 0;
+    pthread_mutex_lock(&mutex);
+        LatencyHistogram* histogram = findHistogram(batchSize);
+        if (histogram) latency = histogram->maxLatency;
+    pthread_mutex_unlock(&mutex);
+
+    return latency;
+}
+
+
+/** ===============================================================================================
+ * \name    isProfiled
+ *
+ * \brief   Whether the batch size itself has any sample, without the fallback of the queries
+ * ================================================================================================
+ */
+bool
+LatencyProfile::isProfiled (int batchSize)
+{
+    pthread_mutex_lock(&mutex);
+        auto it = histograms.find(batchSize);
+        bool profiled = it != histograms.end() && it->second.count > 0;
+    pthread_mutex_unlock(&mutex);
+
+    return profiled;
+}
+
+
+/** ===============================================================================================
+ * \name    findHistogram
+ *
+ * \brief   Find the histogram of the batch size. If the batch size is never profiled, fall back to
+ *          the smallest larger batch size, otherwise the largest profiled one.
+ *
+ * \note    The caller should hold the mutex
+ * ================================================================================================
+ */
+LatencyHistogram*
+LatencyProfile::findHistogram (int batchSize)
+{
+    if (histograms.empty()) return nullptr;
+
+    auto it = histograms.lower_bound(batchSize);
+    if (it == histograms.end()) --it;
+
+    return &it->second;
+}
+
+
+/** ===============================================================================================
+ * \name    load
+ *
+ * \brief   Load the profile recorded by the previous runs
+ *
+ * \return  false if there is no profile
+ * ================================================================================================
+ */
+bool
+LatencyProfile::load (void)
+{
+    ifstream file(filePath);
+    if (!file.is_open())
+    {
+        log_D(modelName, "No latency profile: " + filePath);
+        return false;
+    }
+
+    pthread_mutex_lock(&mutex);
+        histograms.clear();
+        string readLine;
+        while (getline(file, readLine))
+        {
+            if (readLine.empty() || readLine[0] == '#') continue;
+
+            istringstream stream(readLine);
+            int batchSize;
+            LatencyHistogram histogram;
+            if (!(stream >> batchSize) || !histogram.deserialize(stream))
+            {
+                log_W(modelName, "Broken latency profile, ignore: " + filePath);
+                histograms.clear();
+                break;
+            }
+            histograms[batchSize] = histogram;
+        }
+    pthread_mutex_unlock(&mutex);
+    file.close();
+
+    log_D(modelName, "Load latency profile with " + to_string(histograms.size()) + " batch sizes");
+    return !histograms.empty();
+}
+
+
+/** ===============================================================================================
+ * \name    save
+ *
+ * \brief   Persist the profile for the next runs
+ * ================================================================================================
+ */
+bool
+LatencyProfile::save (void)
+{
+    ofstream file(filePath);
+    if (!file.is_open())
+    {
+        log_W(modelName, "Can't save latency profile: " + filePath);
+        return false;
+    }
+
+    pthread_mutex_lock(&mutex);
+        file << "# batch count sum max n bucket:count ..." << endl;
+        for (auto& histogram : histograms)
+        {
+            file << histogram.first << " " << histogram.second.serialize() << endl;
+        }
+    pthread_mutex_unlock(&mutex);
+    file.close();
+
+    return true;
+}
+
+
+/** ===============================================================================================
+ * \name    report
+ *
+ * \brief   Log the p50/p95/p99/max latency of each batch size
+ * ================================================================================================
+ */
+void
+LatencyProfile::report (void)
+{
+    pthread_mutex_lock(&mutex);
+        for (auto& histogram : histograms)
+        {
+            log_I(modelName, "Latency of " + to_string(histogram.first) + " batch, "
+                                + "count: " + to_string(histogram.second.count)
+                                + ", p50: " + to_string(histogram.second.percentile(0.50))
+                                + ", p95: " + to_string(histogram.second.percentile(0.95))
+                                + ", p99: " + to_string(histogram.second.percentile(0.99))
+                                + ", max: " + to_string(histogram.second.maxLatency) + " ms");
+        }
+    pthread_mutex_unlock(&mutex);
+}
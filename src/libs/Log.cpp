@@ -1,20 +1,56 @@
 /**
  * \name    Log.cpp
- * 
+ *
  * \brief   Passing the log information by the logType
- * 
+ *
  * \date    Mar 6, 2023
  */
 
 #include "../include/Log.hpp"
 
+#include <algorithm>
+
+#include <sched.h>
+#include <stdio.h>
+
+/* ************************************************************************************************
+ * Type Define
+ * ************************************************************************************************
+ */
+/* The ring of one thread, the thread produces and the drainer consumes */
+typedef struct {
+    std::vector<Log_Record_t>   records;
+    size_t                      mask;
+    std::atomic<size_t>         head;       // the next record to write
+    std::atomic<size_t>         tail;       // the next record to drain
+}Log_Ring_t;
+
 /* ************************************************************************************************
  * Global Resource
  * ************************************************************************************************
  */
-pthread_mutex_t ioMutex;
+pthread_mutex_t ioMutex = PTHREAD_MUTEX_INITIALIZER;
 std::ofstream logFile;
 
+/* The ring of the calling thread, unregistered and freed at the exit of the thread */
+typedef struct Log_Ring_Owner_t {
+    Log_Ring_t* ring = nullptr;
+    ~Log_Ring_Owner_t (void);
+}Log_Ring_Owner_t;
+
+/* The rings of all threads, registered once per thread under ioMutex */
+static std::vector<Log_Ring_t*> rings;
+static thread_local Log_Ring_Owner_t threadRing;
+
+static pthread_t drainer;
+static std::atomic<bool> draining(false);
+
+/* The record of a call without a running drainer, written out at once */
+static thread_local Log_Record_t directRecord;
+
+static void logDrain (void);
+static void* threadDrainer (void* arg);
+
 /* ************************************************************************************************
  * Global Resource
  * ************************************************************************************************
@@ -26,12 +62,47 @@ void logInit (void)
 
     /* Log file */
     logFile.open("log.txt");
+
+    draining = true;
+    pthread_create(&drainer, NULL, threadDrainer, nullptr);
 }
 
 void logDestory (void)
 {
-    pthread_mutex_destroy(&ioMutex);
-    logFile.close();
+    /* write out the rest records, the rings are freed by their threads */
+    draining = false;
+    pthread_join(drainer, NULL);
+    logDrain();
+
+    /* ioMutex stays valid, the later calls write synchronously */
+    pthread_mutex_lock(&ioMutex);
+        logFile.close();
+    pthread_mutex_unlock(&ioMutex);
+}
+
+
+/** ===============================================================================================
+ * \name    ~Log_Ring_Owner_t
+ *
+ * \brief   Wait for the drainer to take the records of the exiting thread, then free its ring
+ * ================================================================================================
+ */
+Log_Ring_Owner_t::~Log_Ring_Owner_t (void)
+{
+    if (!ring) return;
+
+    while (draining.load(std::memory_order_acquire) && 
+           ring->tail.load(std::memory_order_acquire) != ring->head.load(std::memory_order_relaxed))
+    {
+        sched_yield();
+    }
+
+    pthread_mutex_lock(&ioMutex);
+        rings.erase(std::remove(rings.begin(), rings.end(), ring), rings.end());
+    pthread_mutex_unlock(&ioMutex);
+
+    delete ring;
+    ring = nullptr;
 }
 
 
@@ -39,7 +110,7 @@ void logDestory (void)
  * \name    log
  *
  * \brief   Print the predefined information by the corresponding condition
- * 
+ *
  * \param   tag the group of information
  * \param   logType the element of enum Log_t
  * ================================================================================================
@@ -49,19 +120,286 @@ void log (std::string tag, Log_t logType)
     switch(logType)
     {
         case ONNX_SETUPMODEL_START:
-            log_I(tag, "Start up model...");
+            logf_I(tag, "Start up model...");
             break;
 
         case ONNX_SETUPMODEL_WARMUP:
-            log_I(tag, "Warm up model...");
+            logf_I(tag, "Warm up model...");
+            break;
+
+        case ONNX_SETUPMODEL_CALIBRATE:
+            logf_I(tag, "Calibrate latency profile...");
             break;
 
         case ONNX_INFERENCE_INPUTSIZE_ZERO:
-            log_D(tag, "Input size is zero, skip inference.");
+            logf_D(tag, "Input size is zero, skip inference.");
             break;
 
         case ONNX_INFERENCE_INPUTSIZE_WRONG:
-            log_E(tag, "Input size not match, skip inference.");
+            logf_E(tag, "Input size not match, skip inference.");
             break;
+
+        case ONNX_INFERENCE_CANCELLED:
+            logf_W(tag, "Inference exceeds the deadline, cancelled.");
+            break;
+    }
+}
+
+
+/** ===============================================================================================
+ * \name    logAcquire
+ *
+ * \brief   Take the next record of the ring of the calling thread, wait while the ring is full.
+ *          Without a running drainer, a thread-local record is written out at the commit.
+ *
+ * \param   level the log level
+ * \param   tag the group of information, truncated to LOG_TAG_SIZE
+ *
+ * \return  the record to fill, must be committed by \b logCommit
+ * ================================================================================================
+ */
+Log_Record_t*
+logAcquire (int level, const char* tag)
+{
+    Log_Record_t* record = &directRecord;
+    if (draining.load(std::memory_order_acquire))
+    {
+        if (!threadRing.ring)
+        {
+            Log_Ring_t* ring = new Log_Ring_t();
+            size_t size = 2;
+            while (size < LOG_RING_SIZE) size <<= 1;
+            ring->records.resize(size);
+            ring->mask = size - 1;
+            ring->head = 0;
+            ring->tail = 0;
+
+            pthread_mutex_lock(&ioMutex);
+                rings.push_back(ring);
+            pthread_mutex_unlock(&ioMutex);
+            threadRing.ring = ring;
+        }
+
+        Log_Ring_t* ring = threadRing.ring;
+        size_t head = ring->head.load(std::memory_order_relaxed);
+        while (head - ring->tail.load(std::memory_order_acquire) > ring->mask && draining.load(std::memory_order_acquire))
+        {
+            sched_yield();
+        }
+        if (head - ring->tail.load(std::memory_order_acquire) <= ring->mask) record = &ring->records[head & ring->mask];
     }
-}
\ No newline at end of file
+
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    record->timestamp   = now.tv_sec * 1000000000ull + now.tv_nsec;
+    record->level       = level;
+    record->argNum      = 0;
+    record->more        = false;
+    record->format      = nullptr;
+    strncpy(record->tag, tag, LOG_TAG_SIZE - 1);
+    record->tag[LOG_TAG_SIZE - 1] = '\0';
+
+    return record;
+}
+
+
+/** ===============================================================================================
+ * \name    logText
+ *
+ * \brief   Log a preformatted message, a long message is split into several records. A message is
+ *          drained whole, so it is truncated to the records of a ring.
+ * ================================================================================================
+ */
+void
+logText (int level, const char* tag, const char* text, size_t length)
+{
+    length = std::min(length, (size_t)LOG_RING_SIZE * (LOG_TEXT_SIZE - 1));
+    size_t offset = 0;
+    do {
+        Log_Record_t* record = logAcquire(level, tag);
+        size_t chunk = std::min(length - offset, (size_t)LOG_TEXT_SIZE - 1);
+        memcpy(record->text, text + offset, chunk);
+        record->text[chunk] = '\0';
+        offset += chunk;
+        record->more = offset < length;
+        logCommit(record);
+    } while (offset < length);
+}
+
+
+/** ===============================================================================================
+ * \name    logFormatRecord
+ *
+ * \brief   Format a record, the {} placeholders are replaced by the arguments in order
+ * ================================================================================================
+ */
+static void
+logFormatRecord (const Log_Record_t& record, std::string* out)
+{
+    if (!record.format)
+    {
+        out->append(record.text);
+        return;
+    }
+
+    int argId = 0;
+    char number[32];
+    for (const char* c = record.format; *c; c++)
+    {
+        if (c[0] != '{' || c[1] != '}' || argId >= record.argNum)
+        {
+            out->push_back(*c);
+            continue;
+        }
+
+        const Log_Arg_t& arg = record.args[argId++];
+        if (arg.type == 'i')
+        {
+            snprintf(number, sizeof(number), "%ld", arg.i);
+            out->append(number);
+        } else if (arg.type == 'f') {
+            snprintf(number, sizeof(number), "%f", arg.f);
+            out->append(number);
+        } else {
+            out->append(arg.s ? arg.s : "(null)");
+        }
+        c++;
+    }
+}
+
+
+/** ===============================================================================================
+ * \name    logWrite
+ *
+ * \brief   Write out one message in the format of its level, the caller holds ioMutex
+ * ================================================================================================
+ */
+static void
+logWrite (int level, const char* tag, const std::string& message)
+{
+    switch (level)
+    {
+        case ERROR:     std::cout << "\033[1;31mLogE:\033[0m Tag: "; break;
+        case WARNNING:  std::cout << "\033[1;34mLogW:\033[0m Tag: "; break;
+        case INFO:      std::cout << "\033[1;32mLogI:\033[0m Tag: "; break;
+        case DEBUG:     std::cout << "\033[1;36mLogD:\033[0m Tag: "; break;
+        default:        std::cout << "LogV: Tag: "; break;
+    }
+    std::cout << tag << ": " << message << '\n';
+
+    if (level == INFO)
+    {
+        logFile << "Tag: " << tag << ": " << message << '\n';
+    }
+}
+
+
+/** ===============================================================================================
+ * \name    logCommit
+ *
+ * \brief   Publish the record to the drainer, or write it out at once without a drainer
+ * ================================================================================================
+ */
+void
+logCommit (Log_Record_t* record)
+{
+    if (record != &directRecord)
+    {
+        threadRing.ring->head.fetch_add(1, std::memory_order_release);
+        return;
+    }
+
+    static thread_local std::string pending;
+    logFormatRecord(*record, &pending);
+    if (record->more) return;
+
+    pthread_mutex_lock(&ioMutex);
+        logWrite(record->level, record->tag, pending);
+        std::cout.flush();
+        logFile.flush();
+    pthread_mutex_unlock(&ioMutex);
+    pending.clear();
+}
+
+
+/** ===============================================================================================
+ * \name    logDrain
+ *
+ * \brief   Take the committed messages of all rings, write them out in the order of their time
+ * ================================================================================================
+ */
+static void
+logDrain (void)
+{
+    /* the time, the ring and the first record of every message */
+    typedef std::pair<uint64_t, std::pair<Log_Ring_t*, size_t>> Log_Message_t;
+    static std::vector<Log_Message_t> order;
+    order.clear();
+
+    pthread_mutex_lock(&ioMutex);
+        for (auto ring : rings)
+        {
+            size_t head = ring->head.load(std::memory_order_acquire);
+            size_t tail = ring->tail.load(std::memory_order_relaxed);
+
+            /* a split message is drained whole */
+            while (head > tail && ring->records[(head - 1) & ring->mask].more) head--;
+
+            for (size_t i = tail; i < head; i++)
+            {
+                order.push_back(std::make_pair(ring->records[i & ring->mask].timestamp, std::make_pair(ring, i)));
+                while (ring->records[i & ring->mask].more) i++;
+            }
+        }
+        std::stable_sort(order.begin(), order.end(), [](const Log_Message_t& x, const Log_Message_t& y) {return x.first < y.first;});
+
+        /* ******************************************
+         * Format and write out
+         * ******************************************
+         */
+        std::string message;
+        for (auto& entry : order)
+        {
+            Log_Ring_t* ring = entry.second.first;
+            size_t i = entry.second.second;
+            for (;; i++)
+            {
+                logFormatRecord(ring->records[i & ring->mask], &message);
+                if (!ring->records[i & ring->mask].more) break;
+            }
+
+            const Log_Record_t& record = ring->records[entry.second.second & ring->mask];
+            logWrite(record.level, record.tag, message);
+            message.clear();
+
+            /* release the records to the producer, the messages of a ring are in order */
+            ring->tail.store(i + 1, std::memory_order_release);
+        }
+        if (!order.empty())
+        {
+            std::cout.flush();
+            logFile.flush();
+        }
+    pthread_mutex_unlock(&ioMutex);
+}
+
+
+/** ===============================================================================================
+ * \name    threadDrainer
+ *
+ * \brief   Drain the rings every LOG_DRAIN_PERIOD until the log is destroyed
+ * ================================================================================================
+ */
+static void*
+threadDrainer (void* arg)
+{
+    while (draining.load(std::memory_order_acquire))
+    {
+        logDrain();
+
+        struct timespec period = {LOG_DRAIN_PERIOD / 1000000, (LOG_DRAIN_PERIOD % 1000000) * 1000};
+        nanosleep(&period, NULL);
+    }
+
+    pthread_exit(nullptr);
+}
@@ -0,0 +1,33 @@
+/**
+ * \name    ModelPool.cpp
+ *
+ * \brief   Implement the API
+ *
+ * \date    Oct 18, 2026
+ */
+
+#include "../include/ModelPool.hpp"
+
+map<string, ModelPool::Pooled_Model_t> ModelPool::models;
+pthread_mutex_t ModelPool::mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/** ===============================================================================================
+ * \name    release
+ *
+ * \brief   Drop a reference of the model, the last one destructs it
+ *
+ * \param   model the model taken by \b acquire
+ * ================================================================================================
+ */
+void
+ModelPool::release (OnnxModel* model)
+{
+    pthread_mutex_lock(&mutex);
+        auto it = models.find(model->modelName);
+        if (it != models.end() && --it->second.references == 0)
+        {
+            delete model;
+            models.erase(it);
+        }
+    pthread_mutex_unlock(&mutex);
+}
@@ -0,0 +1,86 @@
+/**
+ * \name    MosaicPacker.cpp
+ *
+ * \brief   Implement the API
+ *
+ * \date    Oct 18, 2026
+ */
+
+#include "../include/MosaicPacker.hpp"
+
+/** ===============================================================================================
+ * \name    pack
+ *
+ * \brief   Pack the crops into the canvases
+ *
+ * \param   sizes the sizes of the crops
+ * \param   canvasSize the size of the canvas, the input size of the detection model
+ * \param   margin the gap in pixels between the crops and to the canvas border
+ * \param   maxCanvas the maximum number of canvases
+ * \param   places the place of every crop, in the order of sizes
+ *
+ * \return  the number of used canvases
+ * ================================================================================================
+ */
+int
+MosaicPacker::pack (const vector<cv::Size>& sizes, cv::Size canvasSize, int margin, int maxCanvas, vector<Mosaic_Place_t>* places)
+{
+    places->assign(sizes.size(), Mosaic_Place_t{-1, cv::Rect()});
+
+    vector<int> order(sizes.size());
+    for (int i = 0; i < order.size(); i++) order[i] = i;
+    sort(order.begin(), order.end(), [&sizes](int x, int y) {return sizes[x].height > sizes[y].height;});
+
+    int canvas = 0, x = margin, y = margin, shelfHeight = 0;
+    for (auto i : order)
+    {
+        const cv::Size& size = sizes[i];
+        if (size.width + 2 * margin > canvasSize.width || size.height + 2 * margin > canvasSize.height) continue;
+
+        /* next shelf */
+        if (x + size.width + margin > canvasSize.width)
+        {
+            x = margin;
+            y += shelfHeight + margin;
+            shelfHeight = 0;
+        }
+
+        /* next canvas */
+        if (y + size.height + margin > canvasSize.height)
+        {
+            if (canvas + 1 >= maxCanvas) break;
+            canvas++;
+            x = margin;
+            y = margin;
+            shelfHeight = 0;
+        }
+
+        (*places)[i].canvas = canvas;
+        (*places)[i].rect = cv::Rect(x, y, size.width, size.height);
+        x += size.width + margin;
+        shelfHeight = max(shelfHeight, size.height);
+    }
+
+    return x == margin && y == margin ? canvas : canvas + 1;
+}
+
+
+/** ===============================================================================================
+ * \name    locate
+ *
+ * \brief   Find the crop containing the point, e.g. the center of a detection
+ *
+ * \param   rects the places of the crops in one canvas
+ *
+ * \return  the index of the crop, -1 for the margins
+ * ================================================================================================
+ */
+int
+MosaicPacker::locate (const vector<cv::Rect>& rects, float x, float y)
+{
+    for (int i = 0; i < rects.size(); i++)
+    {
+        if (x >= rects[i].x && x < rects[i].x + rects[i].width && y >= rects[i].y && y < rects[i].y + rects[i].height) return i;
+    }
+    return -1;
+}
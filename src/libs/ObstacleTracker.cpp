@@ -0,0 +1,237 @@
+/**
+ * \name    ObstacleTracker.cpp
+ *
+ * \brief   Implement the API
+ *
+ * \date    Oct 18, 2026
+ */
+
+#include "../include/ObstacleTracker.hpp"
+
+/** ===============================================================================================
+ * \name    ObstacleTracker
+ *
+ * \brief   Construct a tracker without tracks
+ * ================================================================================================
+ */
+ObstacleTracker::ObstacleTracker (void) : nextId(0)
+{
+
+}
+
+
+/** ===============================================================================================
+ * \name    update
+ *
+ * \brief   Associate the obstacles of a new frame with the tracks
+ *
+ * \param   boxes the obstacle boxes of the frame
+ * \param   depths the lidar depth of every obstacle
+ * \param   trackIds the track id of every obstacle, in the order of boxes
+ * ================================================================================================
+ */
+void
+ObstacleTracker::update (const vector<Track_Box_t>& boxes, const vector<float>& depths, vector<int>* trackIds)
+{
+    trackIds->assign(boxes.size(), -1);
+    for (auto& track : tracks)
+    {
+        track.resultAge++;
+    }
+
+    /* ******************************************
+     * Gate the pairs by IoU and depth
+     * ******************************************
+     */
+    vector<pair<float, pair<int, int>>> pairs;
+    for (int t = 0; t < tracks.size(); t++)
+    {
+        for (int b = 0; b < boxes.size(); b++)
+        {
+            if (abs(tracks[t].depth - depths[b]) >= TRACK_DEPTH_GATE) continue;
+
+            float iou = boxIoU(tracks[t].box, boxes[b]);
+            if (iou > TRACK_IOU) pairs.push_back(make_pair(iou, make_pair(t, b)));
+        }
+    }
+    sort(pairs.begin(), pairs.end(), [](const pair<float, pair<int, int>>& x, const pair<float, pair<int, int>>& y) {return x.first > y.first;});
+
+    /* ******************************************
+     * Greedy association
+     * ******************************************
+     */
+    vector<bool> matched(tracks.size(), false);
+    for (auto& entry : pairs)
+    {
+        int t = entry.second.first;
+        int b = entry.second.second;
+        if (matched[t] || (*trackIds)[b] >= 0) continue;
+
+        Track_t& track = tracks[t];
+        track.stableFrames = (entry.first >= TRACK_STABLE_IOU) ? track.stableFrames + 1 : 0;
+        track.missed = 0;
+        track.dx = boxes[b].left - track.box.left;
+        track.dy = boxes[b].top - track.box.top;
+        track.box = boxes[b];
+        track.depth = depths[b];
+
+        matched[t] = true;
+        (*trackIds)[b] = track.id;
+    }
+
+    /* ******************************************
+     * Drop the lost tracks, start the new ones
+     * ******************************************
+     */
+    vector<Track_t> kept;
+    for (int t = 0; t < tracks.size(); t++)
+    {
+        if (!matched[t])
+        {
+            tracks[t].stableFrames = 0;
+            if (++tracks[t].missed > TRACK_MAX_MISSED) continue;
+        }
+        kept.push_back(tracks[t]);
+    }
+    tracks.swap(kept);
+
+    for (int b = 0; b < boxes.size(); b++)
+    {
+        if ((*trackIds)[b] >= 0) continue;
+
+        Track_t track;
+        track.id            = nextId++;
+        track.box           = boxes[b];
+        track.depth         = depths[b];
+        track.dx            = 0;
+        track.dy            = 0;
+        track.stableFrames  = 0;
+        track.missed        = 0;
+        track.cached        = false;
+        track.resultAge     = 0;
+        track.resultBox     = boxes[b];
+        tracks.push_back(track);
+
+        (*trackIds)[b] = track.id;
+    }
+
+    log_V("ObstacleTracker", "Tracks: " + to_string(tracks.size()) + ", matched: " + to_string(count(matched.begin(), matched.end(), true)));
+}
+
+
+/** ===============================================================================================
+ * \name    lookup
+ *
+ * \brief   Reuse the cached results of a track. The track must be stable for TRACK_STABLE_FRAMES,
+ *          the results must be inferred within TRACK_RESULT_TTL frames on a box still overlapping
+ *          the current one above TRACK_STABLE_IOU. The detection boxes follow the track.
+ *
+ * \param   trackId the track of the obstacle
+ * \param   results the cached results
+ *
+ * \return  true if the cached results are reusable
+ * ================================================================================================
+ */
+bool
+ObstacleTracker::lookup (int trackId, vector<Inference_Result_t>* results)
+{
+    Track_t* track = find(trackId);
+    if (!track || !reusable(*track, track->box)) return false;
+
+    float dx = track->box.left - track->resultBox.left;
+    float dy = track->box.top - track->resultBox.top;
+    results->assign(track->results.begin(), track->results.end());
+    for (auto& result : *results)
+    {
+        /* the classification results carry no box */
+        if (result.box[2] <= result.box[0]) continue;
+
+        result.box[0] += dx;
+        result.box[1] += dy;
+        result.box[2] += dx;
+        result.box[3] += dy;
+    }
+    return true;
+}
+
+
+/** ===============================================================================================
+ * \name    predict
+ *
+ * \brief   Project the boxes of the tracks matched in the last frame by their last motion. The
+ *          tracks expected to reuse their cached results are left out.
+ *
+ * \param   trackIds the track of every predicted box
+ * \param   boxes the predicted boxes
+ * ================================================================================================
+ */
+void
+ObstacleTracker::predict (vector<int>* trackIds, vector<Track_Box_t>* boxes)
+{
+    trackIds->clear();
+    boxes->clear();
+    for (auto& track : tracks)
+    {
+        if (track.missed > 0) continue;
+
+        Track_Box_t box = {track.box.left + track.dx, track.box.top + track.dy, track.box.right + track.dx, track.box.bottom + track.dy};
+        if (TRACK_RESULT_REUSE && reusable(track, box)) continue;
+
+        trackIds->push_back(track.id);
+        boxes->push_back(box);
+    }
+}
+
+
+/** ===============================================================================================
+ * \name    store
+ *
+ * \brief   Cache the inference results of a track, inferred on its current box
+ *
+ * \param   trackId the track of the obstacle, ignored if the track is dropped
+ * \param   results the results of the obstacle, empty if nothing is recognized
+ * ================================================================================================
+ */
+void
+ObstacleTracker::store (int trackId, const vector<Inference_Result_t>& results)
+{
+    Track_t* track = find(trackId);
+    if (!track) return;
+
+    track->cached = true;
+    track->resultAge = 0;
+    track->resultBox = track->box;
+    track->results = results;
+}
+
+
+/** ===============================================================================================
+ * \name    find
+ *
+ * \return  the track of the id, nullptr if dropped
+ * ================================================================================================
+ */
+ObstacleTracker::Track_t*
+ObstacleTracker::find (int trackId)
+{
+    for (auto& track : tracks)
+    {
+        if (track.id == trackId) return &track;
+    }
+    return nullptr;
+}
+
+
+/** ===============================================================================================
+ * \name    reusable
+ *
+ * \return  true if the cached results of the track are reusable on the box
+ * ================================================================================================
+ */
+bool
+ObstacleTracker::reusable (const Track_t& track, const Track_Box_t& box)
+{
+    if (!track.cached) return false;
+    if (track.stableFrames < TRACK_STABLE_FRAMES || track.resultAge > TRACK_RESULT_TTL) return false;
+    return boxIoU(box, track.resultBox) >= TRACK_STABLE_IOU;
+}
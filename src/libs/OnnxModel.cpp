@@ -8,6 +8,15 @@
 
 #include "../include/OnnxModels.hpp"
 
+/* ************************************************************************************************
+ * Global Resource
+ * ************************************************************************************************
+ */
+Ort::Env* OnnxModel::sharedEnv = nullptr;
+Ort::PrepackedWeightsContainer* OnnxModel::sharedPrepackedWeights = nullptr;
+map<string, OnnxModel::Shared_Initializers_t*> OnnxModel::sharedInitializers;
+
+
 /** ===============================================================================================
  * \name    OnnxModel
  *
@@ -17,8 +26,12 @@
  * \param   batch_limit the constraint of batch inference
  * ================================================================================================
  */
-OnnxModel::OnnxModel (string model_name, int batch_limit) : modelName(model_name), batchLimit(batch_limit), fullyBatch(false), busyFlag(false)
+OnnxModel::OnnxModel (string model_name, int batch_limit) : modelName(model_name), batchLimit(batch_limit), fullyBatch(false), busyReplicas(0), cancelCount(0), spendTime(0), latencyProfile(nullptr), traceName(traceIntern(model_name)), prepackedWeights(nullptr)
 {
+    pthread_mutex_init(&replicaMutex, NULL);
+    pthread_cond_init(&replicaCond, NULL);
+    pthread_mutex_init(&stashMutex, NULL);
+
     Onnx_modelSetup();
 }
 
@@ -32,7 +45,35 @@ OnnxModel::OnnxModel (string model_name, int batch_limit) : modelName(model_name
 OnnxModel::~OnnxModel (void)
 {
     Ort::AllocatorWithDefaultOptions allocator;
-    session->EndProfilingAllocated(allocator);
+    for (auto& replica : sessions)
+    {
+        for (auto session : replica)
+        {
+            session->EndProfilingAllocated(allocator);
+            delete session;
+        }
+    }
+    sessions.clear();
+
+    /* the sessions using the container are gone, the shared one lives with the process */
+#if !SHARE_PREPACKED_WEIGHTS
+    delete prepackedWeights;
+#endif
+    prepackedWeights = nullptr;
+
+    log_I(modelName, "Cancelled inference by deadline: " + to_string(cancelCount.load()));
+
+    if (latencyProfile)
+    {
+        latencyProfile->report();
+        latencyProfile->save();
+        delete latencyProfile;
+        latencyProfile = nullptr;
+    }
+
+    pthread_mutex_destroy(&replicaMutex);
+    pthread_cond_destroy(&replicaCond);
+    pthread_mutex_destroy(&stashMutex);
 }
 
 
@@ -45,16 +86,49 @@ OnnxModel::~OnnxModel (void)
 void 
 OnnxModel::Onnx_inference (void) {
 
-    if (inputStreams.size() == 0)
+    vector<float> inputData;
+    Onnx_popInputs(&inputData);
+
+    spendTime = Onnx_inference(inputData);
+
+}
+
+
+/** ===============================================================================================
+ * \name    Onnx_inference
+ *
+ * \brief   Inference the given batch, could be called by the inference workers
+ * 
+ * \param   inputData the preprocessed batch
+ * \param   deadline the absolute deadline, the run is terminated once exceeded. nullptr for no deadline
+ * \param   cancelled set to true if the run is cancelled by the deadline
+ * \param   progress the resumable state of a segmented model, the run yields between two segments
+ *          if progress->shouldYield returns true. nullptr for non-preemptible run
+ * \param   resultBuffer the decoded results are appended into, nullptr to skip decoding. Not used
+ *          if progress->keepOutputs, the outputs are kept in progress->values instead.
+ * 
+ * \return  the inference spend time in ms
+ * ================================================================================================
+ */
+float 
+OnnxModel::Onnx_inference (vector<float>& inputData, const timeval* deadline, bool* cancelled, Inference_Progress_t* progress, ResultBuffer* resultBuffer) {
+
+    if (cancelled) *cancelled = false;
+
+    bool resume = progress && progress->nextSegment > 0;
+    if (progress) progress->preempted = false;
+    TRACE_SCOPE_ARG("inference", traceName, resume ? progress->sampleNum : inputData.size() / singleInputSize);
+
+    if (!resume && inputData.size() == 0)
     {
         log(modelName, ONNX_INFERENCE_INPUTSIZE_ZERO);
-        return;
+        return 0;
     }
     
-    if (inputStreams.size() % singleInputSize != 0)
+    if (!resume && inputData.size() % singleInputSize != 0)
     {
         log(modelName, ONNX_INFERENCE_INPUTSIZE_WRONG);
-        return;
+        return 0;
     }
 
     /* ******************************************
@@ -62,45 +136,233 @@ OnnxModel::Onnx_inference (void) {
      * not enough, fill up by 0 data.
      * ******************************************
      */
-    inputNodeDims[0] = batchLimit;
-    vector<float> inputTensorValues(batchLimit * singleInputSize, 0);
-    copy(inputStreams.begin(), inputStreams.begin() + inputTensorValues.size(), inputTensorValues.begin());
+    vector<int64_t> inputDims = inputNodeDims;
+    vector<float> inputTensorValues;
+    vector<Ort::Value> stageTensors;
+    int sampleNum;
+    if (resume)
+    {
+        /* resume from the intermediate tensors of the preempted segment */
+        inputDims[0] = progress->batchSize;
+        sampleNum = progress->sampleNum;
+        stageTensors = move(progress->values);
+    } else {
+        sampleNum = min((int)(inputData.size() / singleInputSize), batchLimit);
+#if PADDING_BATCH
+        inputDims[0] = batchLimit;
+#else
+        inputDims[0] = sampleNum;
+#endif
+        inputTensorValues = vector<float>(inputDims[0] * singleInputSize, 0);
+        copy(inputData.begin(), inputData.begin() + min(inputData.size(), inputTensorValues.size()), inputTensorValues.begin());
+
+        logf_D(modelName, "Input Tensor size: {}", inputTensorValues.size());
+
+        Ort::MemoryInfo memory_info = Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault);
+        stageTensors.push_back(Ort::Value::CreateTensor<float>( memory_info, 
+                                                                inputTensorValues.data(), 
+                                                                inputTensorValues.size(), 
+                                                                inputDims.data(), 
+                                                                inputDims.size()
+                                                              ));
+    }
+    
+    /* Wait for an idle replica */
+    int replicaId = Onnx_acquireReplica();
 
-    log_D(modelName, "Input Tensor size: " + to_string(inputTensorValues.size()));
+    /* ******************************************
+     * The watchdog terminates the run once it
+     * exceeds the absolute deadline
+     * ******************************************
+     */
+    Ort::RunOptions runOptions;
+    int watchId = -1;
+    if (deadline) 
+    {
+        if (InferenceWatchdog::expired(*deadline))
+        {
+            Onnx_releaseReplica(replicaId);
+            if (progress) progress->nextSegment = 0;
+            cancelCount++;
+            if (cancelled) *cancelled = true;
+            log(modelName, ONNX_INFERENCE_CANCELLED);
+            return 0;
+        }
+        watchId = InferenceWatchdog::instance()->watch(&runOptions, *deadline);
+    }
 
-    vector<Ort::Value> inputTensors;
-    Ort::MemoryInfo memory_info = Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault);
-    inputTensors.push_back(Ort::Value::CreateTensor<float>( memory_info, 
-                                                            inputTensorValues.data(), 
-                                                            inputTensorValues.size(), 
-                                                            inputNodeDims.data(), 
-                                                            inputNodeDims.size()
-                                                          ));
-    
+    /* ******************************************
+     * Run the segments in sequence, the outputs 
+     * of a segment are the inputs of the next.
+     * Between two segments is the preemption
+     * point.
+     * ******************************************
+     */
     struct timeval inference_start, inference_end;
-    gettimeofday(&inference_start, NULL);
-        busyFlag = true;
-        vector<Ort::Value> outputTensors = session->Run( Ort::RunOptions{nullptr}, 
-                                                         inputNodeNames.data(), 
-                                                         inputTensors.data(), 
-                                                         inputTensors.size(), 
-                                                         outputNodeNames.data(), 
-                                                         outputNodeNames.size()
-                                                       );
-        busyFlag = false;
-    gettimeofday(&inference_end, NULL);
-
-    spendTime = (1000000 * (inference_end.tv_sec - inference_start.tv_sec) + (inference_end.tv_usec - inference_start.tv_usec)) * 0.001;
-    log_I(modelName, "Inference " + to_string(inputNodeDims[0]) +  " batch spend: " + to_string(spendTime) + " ms");
-
-    decodeResult(move(outputTensors));
-
-    /* clear the resource */
-    inputStreams.clear();
-    fullyBatch = false;
-    
-    log_V(modelName, "Clear inputStreams, size: " + to_string(inputStreams.size()));
+    float spendTime = resume ? progress->spendTime : 0;
+    bool terminated = false;
+    int firstSegment = resume ? progress->nextSegment : 0;
+    int segment = firstSegment;
+    for (; segment < segmentNum; segment++)
+    {
+        if (progress && progress->shouldYield && segment > firstSegment && progress->shouldYield(progress->yieldArg))
+        {
+            progress->preempted = true;
+            break;
+        }
 
+        gettimeofday(&inference_start, NULL);
+            try {
+                stageTensors = sessions[replicaId][segment]->Run( runOptions, 
+                                                                  segmentInputNames[segment].data(), 
+                                                                  stageTensors.data(), 
+                                                                  stageTensors.size(), 
+                                                                  segmentOutputNames[segment].data(), 
+                                                                  segmentOutputNames[segment].size()
+                                                                );
+            } catch (const Ort::Exception& exception) {
+                /* a run failed by other reason is still an error */
+                if (watchId < 0 || !InferenceWatchdog::instance()->fired(watchId))
+                {
+                    if (watchId >= 0) InferenceWatchdog::instance()->unwatch(watchId);
+                    Onnx_releaseReplica(replicaId);
+                    throw;
+                }
+                terminated = true;
+            }
+        gettimeofday(&inference_end, NULL);
+        spendTime += (1000000 * (inference_end.tv_sec - inference_start.tv_sec) + (inference_end.tv_usec - inference_start.tv_usec)) * 0.001;
+
+        if (terminated) break;
+    }
+
+    /* the segments finished before the terminate request keep their outputs */
+    if (watchId >= 0) InferenceWatchdog::instance()->unwatch(watchId);
+    Onnx_releaseReplica(replicaId);
+
+    if (terminated)
+    {
+        if (progress) progress->nextSegment = 0;
+        cancelCount++;
+        if (cancelled) *cancelled = true;
+        log(modelName, ONNX_INFERENCE_CANCELLED);
+        logf_D(modelName, "Cancelled {} batch after: {} ms", inputDims[0], spendTime);
+        return spendTime;
+    }
+
+    if (progress && progress->preempted)
+    {
+        progress->nextSegment   = segment;
+        progress->batchSize     = inputDims[0];
+        progress->sampleNum     = sampleNum;
+        progress->spendTime     = spendTime;
+        progress->values        = move(stageTensors);
+        logf_D(modelName, "Preempted before segment {} after: {} ms", segment, spendTime);
+        return spendTime;
+    }
+    if (progress) progress->nextSegment = 0;
+
+    logf_I(modelName, "Inference {} batch on replica {} spend: {} ms", inputDims[0], replicaId, spendTime);
+
+    if (latencyProfile) latencyProfile->record(inputDims[0], spendTime);
+
+    if (progress && progress->keepOutputs)
+    {
+        /* decoded later by Onnx_decode, e.g. in the decode stage of the pipeline */
+        progress->sampleNum = sampleNum;
+        progress->values    = move(stageTensors);
+    } else if (resultBuffer) {
+        TRACE_SCOPE_ARG("decode", traceName, sampleNum);
+        decodeResult(stageTensors, resultBuffer, sampleNum);
+    }
+
+    return spendTime;
+}
+
+
+/** ===============================================================================================
+ * \name    Onnx_decode
+ *
+ * \brief   Decode the outputs kept by \b Onnx_inference with progress->keepOutputs
+ * 
+ * \param   outputs the output tensors in progress->values
+ * \param   resultBuffer the decoded results are appended into
+ * \param   sampleNum the number of real samples in progress->sampleNum
+ * ================================================================================================
+ */
+void
+OnnxModel::Onnx_decode (vector<Ort::Value>& outputs, ResultBuffer* resultBuffer, int sampleNum)
+{
+    if (outputs.empty() || !resultBuffer) return;
+    TRACE_SCOPE_ARG("decode", traceName, sampleNum);
+    decodeResult(outputs, resultBuffer, sampleNum);
+}
+
+
+/** ===============================================================================================
+ * \name    Onnx_acquireReplica
+ *
+ * \brief   Block until there is an idle session replica, and occupy it
+ * 
+ * \return  the index of the occupied replica
+ * ================================================================================================
+ */
+int 
+OnnxModel::Onnx_acquireReplica (void) 
+{
+    pthread_mutex_lock(&replicaMutex);
+        while (idleReplicas.empty())
+        {
+            pthread_cond_wait(&replicaCond, &replicaMutex);
+        }
+        int replicaId = idleReplicas.back();
+        idleReplicas.pop_back();
+        busyReplicas++;
+    pthread_mutex_unlock(&replicaMutex);
+
+    return replicaId;
+}
+
+
+/** ===============================================================================================
+ * \name    Onnx_releaseReplica
+ *
+ * \brief   Give back the session replica to the dispatcher
+ * 
+ * \param   replicaId the index returned by \b Onnx_acquireReplica
+ * ================================================================================================
+ */
+void 
+OnnxModel::Onnx_releaseReplica (int replicaId) 
+{
+    pthread_mutex_lock(&replicaMutex);
+        idleReplicas.push_back(replicaId);
+        busyReplicas--;
+        pthread_cond_signal(&replicaCond);
+    pthread_mutex_unlock(&replicaMutex);
+}
+
+
+/** ===============================================================================================
+ * \name    Onnx_estimateLatency
+ *
+ * \brief   Estimate the inference latency through the latency profile
+ * 
+ * \param   batchSize the number of input data going to inference
+ * \param   percentile the percentile of the latency distribution, e.g. 0.95 for p95
+ * 
+ * \return  the estimated latency in ms
+ * ================================================================================================
+ */
+float
+OnnxModel::Onnx_estimateLatency (int batchSize, float percentile)
+{
+#if PADDING_BATCH
+    batchSize = batchLimit;
+#endif
+    batchSize = max(1, min(batchSize, batchLimit));
+
+    return latencyProfile ? latencyProfile->getPercentile(batchSize, percentile) : spendTime.load();
 }
 
 
@@ -115,18 +377,42 @@ OnnxModel::Onnx_inference (void) {
 void 
 OnnxModel::Onnx_addInput (vector<float> dataStream) 
 {
-    inputStreams.insert(
-        inputStreams.end(), 
-        make_move_iterator(dataStream.begin()), 
-        make_move_iterator(dataStream.end())
-    );
-    if (inputStreams.size() == singleInputSize * batchLimit)
-    {
-        fullyBatch = true;
-    }
+    pthread_mutex_lock(&stashMutex);
+        inputStreams.insert(
+            inputStreams.end(), 
+            make_move_iterator(dataStream.begin()), 
+            make_move_iterator(dataStream.end())
+        );
+        if (inputStreams.size() == singleInputSize * batchLimit)
+        {
+            fullyBatch = true;
+        }
+        size_t stashedSize = inputStreams.size();
+    pthread_mutex_unlock(&stashMutex);
 
-    log_V(modelName, "Add input size: " + to_string(dataStream.size()));
-    log_V(modelName, "Stashed data size: " + to_string(inputStreams.size()));
+    logf_V(modelName, "Add input size: {}", dataStream.size());
+    logf_V(modelName, "Stashed data size: {}", stashedSize);
+}
+
+
+/** ===============================================================================================
+ * \name    Onnx_popInputs
+ *
+ * \brief   Move the stashed data out as one batch, and reset the stash
+ * 
+ * \param   inputs the container to receive the stashed data
+ * ================================================================================================
+ */
+void 
+OnnxModel::Onnx_popInputs (vector<float>* inputs) 
+{
+    inputs->clear();
+    pthread_mutex_lock(&stashMutex);
+        inputs->swap(inputStreams);
+        fullyBatch = false;
+    pthread_mutex_unlock(&stashMutex);
+
+    logf_V(modelName, "Pop stashed data size: {}", inputs->size());
 }
 
 
@@ -142,28 +428,94 @@ OnnxModel::Onnx_modelSetup ()
     struct timeval setup_start, setup_end;
     gettimeofday(&setup_start, NULL);
         log(modelName, ONNX_SETUPMODEL_START);
+        float rssBefore = Onnx_readRSS();
 
-        env = new Ort::Env(ORT_LOGGING_LEVEL_WARNING, "OnnxModel");
+        env = Onnx_sharedEnv();
         Ort::SessionOptions session_options;
         OrtCUDAProviderOptions cuda_options;
 
-        int cpu_threads = 8;
+        cpuCores = CpuPlan::modelCores();
+        int cpu_threads = INTRA_OP_THREADS ? INTRA_OP_THREADS : (cpuCores.empty() ? 8 : cpuCores.size());
         cuda_options.device_id = 0;
 #if PROFILE_MODEL
         session_options.EnableProfiling(("../profile/" + modelName).c_str());
 #endif
         cuda_options.gpu_mem_limit = 1 << 30;
+        cuda_options.arena_extend_strategy = ARENA_EXTEND_STRATEGY;
         session_options.SetIntraOpNumThreads(cpu_threads);
+        if (!cpuCores.empty() && cpu_threads > 1)
+        {
+            session_options.AddConfigEntry("session.intra_op_thread_affinities", CpuPlan::intraOpAffinities(cpuCores, cpu_threads).c_str());
+        }
         session_options.AppendExecutionProvider_CUDA(cuda_options);
         session_options.SetLogSeverityLevel(ORT_LOGGING_LEVEL_ERROR);
         session_options.SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_ENABLE_ALL);
 
-        string model_path = MODEL_PATH + modelName + ".onnx";
-        session = new Ort::Session(*env, model_path.c_str(), session_options);
+        /* ******************************************
+         * Reduce the resident memory of the model
+         * ******************************************
+         */
+#if ENABLE_MEM_PATTERN
+        session_options.EnableMemPattern();
+#else
+        session_options.DisableMemPattern();
+#endif
+#if SHARE_ENV_ALLOCATOR
+        session_options.AddConfigEntry("session.use_env_allocators", "1");
+#endif
+#if SHARE_INITIALIZERS
+        /* the resolution variants of a family share the same weights, e.g. resnet50_56_56 -> resnet50 */
+        Shared_Initializers_t* initializers = Onnx_loadSharedInitializers(modelName.substr(0, modelName.find('_')));
+        if (initializers)
+        {
+            for (size_t i = 0; i < initializers->names.size(); i++)
+            {
+                session_options.AddInitializer(initializers->names[i].c_str(), initializers->values[i]);
+            }
+        }
+#endif
+
+        /* ******************************************
+         * The model split by tools/split_onnx_model.py
+         * is loaded as sequential segments
+         * ******************************************
+         */
+        segmentNum = 1;
+#if PREEMPTIBLE_INFERENCE
+        ifstream segmentManifest(MODEL_PATH + modelName + ".segments");
+        if (segmentManifest.is_open() && !(segmentManifest >> segmentNum)) segmentNum = 1;
+        log_D(modelName, "Model segments: " + to_string(segmentNum));
+#endif
+
+        /* ******************************************
+         * Create the session replicas, the replicas
+         * reuse the prepacked weights of the first
+         * session instead of packing their own copy
+         * ******************************************
+         */
+#if SHARE_PREPACKED_WEIGHTS
+        if (!sharedPrepackedWeights) sharedPrepackedWeights = new Ort::PrepackedWeightsContainer();
+        prepackedWeights = sharedPrepackedWeights;
+#else
+        prepackedWeights = new Ort::PrepackedWeightsContainer();
+#endif
+        for (int replicaId = 0; replicaId < SESSION_REPLICAS; replicaId++)
+        {
+            vector<Ort::Session*> replica;
+            for (int segment = 0; segment < segmentNum; segment++)
+            {
+                string model_path = MODEL_PATH + modelName + (segmentNum > 1 ? "_seg" + to_string(segment) : "") + ".onnx";
+                replica.push_back(new Ort::Session(*env, model_path.c_str(), session_options, *prepackedWeights));
+            }
+            sessions.push_back(replica);
+            idleReplicas.push_back(replicaId);
+        }
+        Ort::Session* session = sessions[0].front();
+        Ort::Session* lastSession = sessions[0].back();
 
         /* get the number of model input/output nodes */
         const size_t num_input_nodes = session->GetInputCount();
-        const size_t num_output_nodes = session->GetOutputCount();
+        const size_t num_output_nodes = lastSession->GetOutputCount();
         inputNodeDims.reserve(num_input_nodes);
         outputNodeDims.reserve(num_output_nodes);
 
@@ -195,8 +547,8 @@ OnnxModel::Onnx_modelSetup ()
          */
         for (size_t i = 0; i < num_output_nodes; i++) {
             // print output node names
-            auto output_name = session->GetOutputNameAllocated(i, allocator);
-            auto type_info = session->GetOutputTypeInfo(i);
+            auto output_name = lastSession->GetOutputNameAllocated(i, allocator);
+            auto type_info = lastSession->GetOutputTypeInfo(i);
             auto tensor_info = type_info.GetTensorTypeAndShapeInfo();
 
             /* get the name of output nodes */
@@ -209,6 +561,30 @@ OnnxModel::Onnx_modelSetup ()
             outputNodeDims = tensor_info.GetShape();
         }
 
+        /* ******************************************
+         * Record the input/output names of each
+         * segment, the intermediate tensors are 
+         * handed over in order
+         * ******************************************
+         */
+        segmentInputNames = vector<vector<const char*>>(segmentNum);
+        segmentOutputNames = vector<vector<const char*>>(segmentNum);
+        segmentInputNames.front() = inputNodeNames;
+        segmentOutputNames.back() = outputNodeNames;
+        for (int segment = 0; segment < segmentNum; segment++) {
+            Ort::Session* segmentSession = sessions[0][segment];
+            for (size_t i = 0; segment > 0 && i < segmentSession->GetInputCount(); i++) {
+                auto input_name = segmentSession->GetInputNameAllocated(i, allocator);
+                segmentInputNames[segment].push_back(input_name.get());
+                namesPtr.push_back(move(input_name));
+            }
+            for (size_t i = 0; segment < segmentNum - 1 && i < segmentSession->GetOutputCount(); i++) {
+                auto output_name = segmentSession->GetOutputNameAllocated(i, allocator);
+                segmentOutputNames[segment].push_back(output_name.get());
+                namesPtr.push_back(move(output_name));
+            }
+        }
+
         /* ******************************************
          * Print out model detial
          * ******************************************
@@ -258,14 +634,165 @@ OnnxModel::Onnx_modelSetup ()
         inputStreams = vector<float>(batchLimit * singleInputSize, 0);
         Onnx_inference();   // for record the runtime inference time
 
+        /* ******************************************
+         * Seed the latency profile of the batch
+         * sizes not profiled by the previous runs,
+         * the saved profile keeps the real runs
+         * ******************************************
+         */
+        log(modelName, ONNX_SETUPMODEL_CALIBRATE);
+        latencyProfile = new LatencyProfile(modelName);
+        latencyProfile->load();
+#if PADDING_BATCH
+        for (int batchSize = batchLimit; batchSize <= batchLimit; batchSize++)
+#else
+        for (int batchSize = 1; batchSize <= batchLimit; batchSize++)
+#endif
+        {
+            if (latencyProfile->isProfiled(batchSize)) continue;
+
+            for (int run = 0; run < LATENCY_CALIBRATION_RUNS; run++)
+            {
+                inputStreams = vector<float>(batchSize * singleInputSize, 0);
+                Onnx_inference();
+            }
+        }
+
     gettimeofday(&setup_end, NULL);
 
     float spendTime = (1000000 * (setup_end.tv_sec - setup_start.tv_sec) + (setup_end.tv_usec - setup_start.tv_usec)) * 0.001;
     log_I(modelName, "Model setup with " + to_string(inputNodeDims[0]) +  " batch spend: " + to_string(spendTime) + " ms");
 
+    float rssAfter = Onnx_readRSS();
+    log_I(modelName, "Resident memory before: " + to_string(rssBefore) + " MB, after: " + to_string(rssAfter) + " MB, model: " + to_string(rssAfter - rssBefore) + " MB");
+
+}
+
+
+
+/** ===============================================================================================
+ * \name    Onnx_sharedEnv
+ *
+ * \brief   The environment shared by all models. The CPU arena allocator is registered into the
+ *          environment, so every session allocates from the same arena instead of its own.
+ * ================================================================================================
+ */
+Ort::Env*
+OnnxModel::Onnx_sharedEnv (void)
+{
+    if (sharedEnv) return sharedEnv;
+
+    sharedEnv = new Ort::Env(ORT_LOGGING_LEVEL_WARNING, "OnnxModel");
+
+#if SHARE_ENV_ALLOCATOR
+    Ort::MemoryInfo memory_info("Cpu", OrtArenaAllocator, 0, OrtMemTypeDefault);
+    Ort::ArenaCfg arena_cfg(ARENA_MAX_MEMORY, ARENA_EXTEND_STRATEGY, ARENA_INITIAL_CHUNK, ARENA_MAX_DEAD_BYTES);
+    sharedEnv->CreateAndRegisterAllocator(memory_info, arena_cfg);
+#endif
+
+    return sharedEnv;
+}
+
+
+/** ===============================================================================================
+ * \name    Onnx_loadSharedInitializers
+ *
+ * \brief   Load the initializers exported by tools/export_shared_initializers.py once per family
+ * 
+ * \param   family the model family, e.g. resnet50
+ * 
+ * \return  the loaded initializers, or nullptr if the family is not exported
+ * ================================================================================================
+ */
+OnnxModel::Shared_Initializers_t*
+OnnxModel::Onnx_loadSharedInitializers (string family)
+{
+    if (sharedInitializers.count(family)) return sharedInitializers[family];
+
+    string folder = MODEL_PATH + family + "_initializers/";
+    ifstream manifest(folder + "manifest.txt");
+    if (!manifest.is_open())
+    {
+        log_D(family, "No shared initializers: " + folder);
+        sharedInitializers[family] = nullptr;
+        return nullptr;
+    }
+
+    Shared_Initializers_t* initializers = new Shared_Initializers_t();
+    vector<vector<int64_t>> shapes;
+
+    /* manifest line: "<name> <file> <ndims> <dims...>" */
+    string name, fileName;
+    int ndims;
+    while (manifest >> name >> fileName >> ndims)
+    {
+        vector<int64_t> shape(ndims);
+        size_t elements = 1;
+        for (auto& dim : shape)
+        {
+            manifest >> dim;
+            elements *= dim;
+        }
+
+        vector<float> buffer(elements);
+        ifstream file(folder + fileName, ios::binary);
+        if (!file.read((char*)buffer.data(), elements * sizeof(float)))
+        {
+            log_W(family, "Broken shared initializer: " + name);
+            continue;
+        }
+
+        initializers->names.push_back(name);
+        initializers->buffers.push_back(move(buffer));
+        shapes.push_back(shape);
+    }
+    manifest.close();
+
+    /* the values refer to the buffers, create them after the buffers stop growing */
+    Ort::MemoryInfo memory_info = Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault);
+    size_t totalBytes = 0;
+    for (size_t i = 0; i < initializers->buffers.size(); i++)
+    {
+        initializers->values.push_back(Ort::Value::CreateTensor<float>( memory_info, 
+                                                                        initializers->buffers[i].data(), 
+                                                                        initializers->buffers[i].size(), 
+                                                                        shapes[i].data(), 
+                                                                        shapes[i].size()
+                                                                      ));
+        totalBytes += initializers->buffers[i].size() * sizeof(float);
+    }
+
+    log_I(family, "Load " + to_string(initializers->names.size()) + " shared initializers, " + to_string(totalBytes >> 20) + " MB");
+    sharedInitializers[family] = initializers;
+    return initializers;
 }
 
 
+/** ===============================================================================================
+ * \name    Onnx_readRSS
+ *
+ * \brief   Read the resident memory of the process
+ * 
+ * \return  the resident memory in MB
+ * ================================================================================================
+ */
+float
+OnnxModel::Onnx_readRSS (void)
+{
+    ifstream status("/proc/self/status");
+    string readLine;
+    while (getline(status, readLine))
+    {
+        /* e.g. "VmRSS:	  123456 kB" */
+        if (readLine.compare(0, 6, "VmRSS:") == 0)
+        {
+            return stol(readLine.substr(6)) / 1024.0;
+        }
+    }
+
+    return 0;
+}
+
 
 /** ===============================================================================================
  * \name    dataPreprocess
@@ -285,15 +812,30 @@ OnnxModel::dataPreprocess (void* data, vector<float> *precessedStream)
  * \name    decodeResult
  * 
  * \param   results the model result
+ * \param   resultBuffer the result buffer of the frame
+ * \param   sampleNum the number of real samples in the batch
  * ================================================================================================
  */
 void 
-OnnxModel::decodeResult (vector<Ort::Value> results) 
+OnnxModel::decodeResult (vector<Ort::Value>& results, ResultBuffer* resultBuffer, int sampleNum) 
 {
     log_D(modelName, "Base case not implement function: decodeResult");
 }
 
 
+/** ===============================================================================================
+ * \name    logResults
+ * 
+ * \param   resultBuffer the result buffer of the frame
+ * ================================================================================================
+ */
+void 
+OnnxModel::logResults (const ResultBuffer& resultBuffer) 
+{
+    log_D(modelName, "Base case not implement function: logResults");
+}
+
+
 /** ***********************************************************************************************
  * \name OnnxResNet
  * 
@@ -316,6 +858,7 @@ OnnxResNet::OnnxResNet (string model_name, int batch_limit) : OnnxModel(model_na
 void
 OnnxResNet::dataPreprocess (void* data, vector<float> *precessedStream)
 {
+    TRACE_SCOPE("preprocess", traceName);
     log_V("OnnxResNet", "dataPreprocess");
     cv::Mat* img = (cv::Mat*) data;
     float multiplier = 1.0 / 255;
@@ -348,55 +891,85 @@ OnnxResNet::dataPreprocess (void* data, vector<float> *precessedStream)
 /** ===============================================================================================
  * \name    decodeResult
  * 
+ * \brief   Decode the top-k classes of each sample into the result buffer, read the output tensor
+ *          in place
+ * 
  * \param   results the model result
+ * \param   resultBuffer the result buffer of the frame
+ * \param   sampleNum the number of real samples, the padding samples are skipped
  * ================================================================================================
  */
 void 
-OnnxResNet::decodeResult (vector<Ort::Value> results) 
+OnnxResNet::decodeResult (vector<Ort::Value>& results, ResultBuffer* resultBuffer, int sampleNum) 
 {
-    log_V("OnnxResNet", "decodeResult");
-    /* log the results informations */
-    vector<int64_t> outputNodeDims = results[0].GetTensorTypeAndShapeInfo().GetShape();
-    string logInfo = "Result dims = [";
-    for (int dim: outputNodeDims)
+    vector<int64_t> outputDims = results[0].GetTensorTypeAndShapeInfo().GetShape();
+    const float* outStream = results[0].GetTensorData<float>();
+
+    int classNum = outputDims[1];
+    int topK = min(RESULT_TOP_K, classNum);
+    sampleNum = min(sampleNum, (int)outputDims[0]);
+
+    Inference_Result_t* slots = resultBuffer->reserve(sampleNum * topK);
+    if (!slots)
     {
-        logInfo += to_string(dim) + ", ";
+        logf_W(modelName, "Result buffer is full, drop {} samples", sampleNum);
+        return;
     }
-    logInfo += "]";
-
-    log_D(modelName, logInfo);
 
     /* ******************************************
-    * Decode the results
-    * ******************************************
-    */
-    const float* outStream = results[0].GetTensorMutableData<float>();
+     * Decode the results
+     * ******************************************
+     */
+    vector<int> indices(topK);
+    for (int i = 0; i < sampleNum; i++) {
+        const float* logits = outStream + i * classNum;
         
-    log_I(modelName, "Num, id, label, confidence");
-    for (int i = 0; i < outputNodeDims[0]; i++) {
-        int id = 0;
-        float max_confidence = 0;
-
-        /* find the entry with max confidence */
-        for (int j = 0; j < outputNodeDims[1]; j++) {
-            float confidence = outStream[i * outputNodeDims[1] + j];
-            if (confidence > max_confidence)
-            {
-                max_confidence = confidence;
-                id = j;
-            }
+        /* the softmax probability of each top-k class */
+        float maxLogit = simdMax(logits, classNum);
+        float topScore = softmaxScore(logits, classNum, maxLogit);
+        simdTopK(logits, classNum, topK, indices.data());
+
+        for (int k = 0; k < topK; k++) {
+            Inference_Result_t& result = slots[i * topK + k];
+            result.model    = this;
+            result.sampleId = i;
+            result.classId  = indices[k];
+            result.score    = topScore * expf(logits[indices[k]] - maxLogit);
+            result.box[0]   = result.box[1] = result.box[2] = result.box[3] = 0;
         }
-        
-        /* log out result */
-        logInfo  = to_string(i) + ", ";
-        logInfo += to_string(id) + ", ";
-        logInfo += labels[id] + ", ";
-        logInfo += to_string(max_confidence);
+    }
+}
+
+
+/** ===============================================================================================
+ * \name    logResults
+ * 
+ * \brief   Log the classification results of this model
+ * 
+ * \param   resultBuffer the result buffer of the frame
+ * ================================================================================================
+ */
+void 
+OnnxResNet::logResults (const ResultBuffer& resultBuffer) 
+{
+    bool header = false;
+    for (size_t i = 0; i < resultBuffer.size(); i++) {
+        const Inference_Result_t& result = resultBuffer[i];
+        if (result.model != this) continue;
+
+        if (!header) {
+            log_I(modelName, "Num, id, label, confidence");
+            header = true;
+        }
+
+        string logInfo;
+        logInfo  = to_string(result.sampleId) + ", ";
+        logInfo += to_string(result.classId) + ", ";
+        logInfo += labels[result.classId] + ", ";
+        logInfo += to_string(result.score);
 
         log_I(modelName, logInfo);
     }
-
-    results.clear();
 }
 
 
@@ -443,9 +1016,10 @@ OnnxYoloNet::OnnxYoloNet (string model_name, int batch_limit) : OnnxModel(model_
 void
 OnnxYoloNet::dataPreprocess (void* data, vector<float> *precessedStream)
 {
+    TRACE_SCOPE("preprocess", traceName);
     log_V("OnnxYoloNet", "dataPreprocess");
     cv::Mat* img = (cv::Mat*) data;
-    log_D("dataPreprocess", "Image width: " + to_string(img->cols) + ", Image height: " + to_string(img->rows));
+    logf_D("dataPreprocess", "Image width: {}, Image height: {}", img->cols, img->rows);
 
     float multiplier = 1.0 / 255;
 
@@ -469,40 +1043,88 @@ OnnxYoloNet::dataPreprocess (void* data, vector<float> *precessedStream)
 /** ===============================================================================================
  * \name    decodeResult
  * 
+ * \brief   Decode the detections into the result buffer, read the output tensor in place. Each row
+ *          of the output is [batch id, x0, y0, x1, y1, class id, score].
+ * 
  * \param   results the model result
+ * \param   resultBuffer the result buffer of the frame
+ * \param   sampleNum the number of real samples, the detections of padding samples are skipped
  * ================================================================================================
  */
 void 
-OnnxYoloNet::decodeResult (vector<Ort::Value> results) 
+OnnxYoloNet::decodeResult (vector<Ort::Value>& results, ResultBuffer* resultBuffer, int sampleNum) 
 {
-    log_V("OnnxYoloNet", "decodeResult");
-    /* log the results informations */
-    vector<int64_t> output_node_dims = results[0].GetTensorTypeAndShapeInfo().GetShape();
-    string logInfo = "Result dims = [";
-    for (int dim: output_node_dims)
+    vector<int64_t> outputDims = results[0].GetTensorTypeAndShapeInfo().GetShape();
+    const float* outStream = results[0].GetTensorData<float>();
+
+    int rowNum = outputDims[0];
+    int rowSize = outputDims[1];
+
+    /* count the detections of the real samples */
+    int detectionNum = 0;
+    for (int i = 0; i < rowNum; i++)
     {
-        logInfo += to_string(dim) + ", ";
+        detectionNum += (int)outStream[i * rowSize] < sampleNum;
     }
-    logInfo += "]";
 
-    log_D(modelName, logInfo);
+    Inference_Result_t* slots = resultBuffer->reserve(detectionNum);
+    if (!slots)
+    {
+        logf_W(modelName, "Result buffer is full, drop {} detections", detectionNum);
+        return;
+    }
 
     /* ******************************************
-    * Decode the results
-    * ******************************************
-    */
-    const float* outStream = results[0].GetTensorMutableData<float>();
-
-    log_I(modelName, "Batch, x, y, width, height, label, confidence");
-    for (int i = 0; i < output_node_dims[0]; i++)
+     * Decode the results
+     * ******************************************
+     */
+    for (int i = 0; i < rowNum; i++)
     {
-        logInfo  = to_string((int)outStream[i * output_node_dims[1]]) + ", ";
-        logInfo += to_string(outStream[i * output_node_dims[1] + 1]) + ", ";
-        logInfo += to_string(outStream[i * output_node_dims[1] + 2]) + ", ";
-        logInfo += to_string(outStream[i * output_node_dims[1] + 3]) + ", ";
-        logInfo += to_string(outStream[i * output_node_dims[1] + 4]) + ", ";
-        logInfo += labels[outStream[i * output_node_dims[1] + 5]]    + ", ";
-        logInfo += to_string(outStream[i * output_node_dims[1] + 6]);
+        const float* row = outStream + i * rowSize;
+        if ((int)row[0] >= sampleNum) continue;
+
+        Inference_Result_t& result = *slots++;
+        result.model    = this;
+        result.sampleId = (int)row[0];
+        result.box[0]   = row[1];
+        result.box[1]   = row[2];
+        result.box[2]   = row[3];
+        result.box[3]   = row[4];
+        result.classId  = (int)row[5];
+        result.score    = row[6];
+    }
+}
+
+
+/** ===============================================================================================
+ * \name    logResults
+ * 
+ * \brief   Log the detection results of this model
+ * 
+ * \param   resultBuffer the result buffer of the frame
+ * ================================================================================================
+ */
+void 
+OnnxYoloNet::logResults (const ResultBuffer& resultBuffer) 
+{
+    bool header = false;
+    for (size_t i = 0; i < resultBuffer.size(); i++) {
+        const Inference_Result_t& result = resultBuffer[i];
+        if (result.model != this) continue;
+
+        if (!header) {
+            log_I(modelName, "Batch, x0, y0, x1, y1, label, confidence");
+            header = true;
+        }
+
+        string logInfo;
+        logInfo  = to_string(result.sampleId) + ", ";
+        logInfo += to_string(result.box[0]) + ", ";
+        logInfo += to_string(result.box[1]) + ", ";
+        logInfo += to_string(result.box[2]) + ", ";
+        logInfo += to_string(result.box[3]) + ", ";
+        logInfo += labels[result.classId] + ", ";
+        logInfo += to_string(result.score);
 
         log_I(modelName, logInfo);
     }
@@ -0,0 +1,190 @@
+/**
+ * \name    OverloadController.cpp
+ *
+ * \brief   Implement the API
+ *
+ * \date    Oct 18, 2026
+ */
+
+#include "../include/OverloadController.hpp"
+
+/** ===============================================================================================
+ * \name    OverloadController
+ *
+ * \brief   Construct the controller out of overload
+ * ================================================================================================
+ */
+OverloadController::OverloadController (void)
+    : lag(0), overload(false), lastFrameId(-1), frameNum(0), overloadFrames(0), skippedFrames(0),
+      shedTaskNum(0), downgradedTaskNum(0), maxLag(0)
+{
+
+}
+
+
+/** ===============================================================================================
+ * \name    frameSynced
+ *
+ * \brief   Count the frames overwritten by the sensing before they are synced
+ *
+ * \param   sensedFrameId the dataset frame of the synced data
+ * ================================================================================================
+ */
+void
+OverloadController::frameSynced (int sensedFrameId)
+{
+    int skipped = sensedFrameId - lastFrameId - 1;
+    if (skipped > 0)
+    {
+        skippedFrames += skipped;
+        log_W("OverloadController", "Skipped stale frames: " + to_string(skipped));
+    }
+    lastFrameId = sensedFrameId;
+}
+
+
+/** ===============================================================================================
+ * \name    frameFinished
+ *
+ * \brief   Update the lag by the finished frame and the overload state
+ *
+ * \param   captureTime the capture time of the finished frame
+ * ================================================================================================
+ */
+void
+OverloadController::frameFinished (const timeval& captureTime)
+{
+    struct timeval now;
+    gettimeofday(&now, NULL);
+    float frameLag = (1000000 * (now.tv_sec - captureTime.tv_sec) + (now.tv_usec - captureTime.tv_usec)) * 0.001;
+
+    lag += OVERLOAD_LAG_SMOOTHING * (frameLag - lag);
+    maxLag = max(maxLag, frameLag);
+    frameNum++;
+    if (overload) overloadFrames++;
+
+    if (!overload && lag > OVERLOAD_LAG_THRESHOLD)
+    {
+        overload = true;
+        log_W("OverloadController", "Enter overload, lag: " + to_string(lag) + " ms");
+    } else if (overload && lag < OVERLOAD_LAG_THRESHOLD * OVERLOAD_RECOVER_RATIO) {
+        overload = false;
+        log_I("OverloadController", "Leave overload, lag: " + to_string(lag) + " ms");
+    }
+    log_D("OverloadController", "End-to-end lag: " + to_string(frameLag) + " ms, smoothed: " + to_string(lag) + " ms");
+}
+
+
+/** ===============================================================================================
+ * \name    shedTasks
+ *
+ * \brief   Keep the most priority tasks whose batches fit the budget by the profiled latency, shed
+ *          the others. The cost of a model grows by one batch whenever its last batch is full.
+ *
+ * \param   queue the task queue of the frame
+ * \param   models the models of the engine
+ * \param   budget the remaining time of the frame in ms
+ * \param   shed the shed tasks, to be released by the engine
+ *
+ * \return  the number of shed tasks
+ * ================================================================================================
+ */
+int
+OverloadController::shedTasks (TaskQueue* queue, const vector<OnnxModel*>& models, float budget, vector<Inference_Task_t>* shed)
+{
+    vector<Inference_Task_t> tasks;
+    queue->snapshot(&tasks);
+    queue->clear();
+    sort(tasks.begin(), tasks.end(), [](const Inference_Task_t& x, const Inference_Task_t& y) {return x.priority > y.priority;});
+
+    vector<int> taskNum(models.size(), 0);
+    float cost = 0;
+    int shedNum = 0;
+    for (auto& task : tasks)
+    {
+        int m = find(models.begin(), models.end(), task.model) - models.begin();
+        float batchCost = (taskNum[m] % task.model->batchLimit == 0) ? task.model->Onnx_estimateLatency(task.model->batchLimit) : 0;
+
+        if (cost + batchCost > budget)
+        {
+            shed->push_back(task);
+            shedNum++;
+            continue;
+        }
+        cost += batchCost;
+        taskNum[m]++;
+        queue->push(task);
+    }
+
+    shedTaskNum += shedNum;
+    return shedNum;
+}
+
+
+/** ===============================================================================================
+ * \name    downgradeTasks
+ *
+ * \brief   Move every task onto the fastest model by the profiled latency. The tasks of the same
+ *          data become duplicated on that model and are shed.
+ *
+ * \param   queue the task queue of the frame
+ * \param   models the models of the engine
+ * \param   shed the duplicated tasks, to be released by the engine
+ *
+ * \return  the number of downgraded tasks
+ * ================================================================================================
+ */
+int
+OverloadController::downgradeTasks (TaskQueue* queue, const vector<OnnxModel*>& models, vector<Inference_Task_t>* shed)
+{
+    if (models.empty()) return 0;
+
+    OnnxModel* fastest = models.front();
+    for (auto model : models)
+    {
+        if (model->Onnx_estimateLatency(1) < fastest->Onnx_estimateLatency(1)) fastest = model;
+    }
+
+    vector<Inference_Task_t> tasks;
+    queue->snapshot(&tasks);
+    queue->clear();
+    sort(tasks.begin(), tasks.end(), [](const Inference_Task_t& x, const Inference_Task_t& y) {return x.priority > y.priority;});
+
+    int downgradedNum = 0;
+    vector<void*> datas;
+    for (auto& task : tasks)
+    {
+        if (task.model != fastest)
+        {
+            task.model = fastest;
+            downgradedNum++;
+        }
+
+        if (find(datas.begin(), datas.end(), task.data) != datas.end())
+        {
+            shed->push_back(task);
+            shedTaskNum++;
+            continue;
+        }
+        datas.push_back(task.data);
+        queue->push(task);
+    }
+
+    downgradedTaskNum += downgradedNum;
+    return downgradedNum;
+}
+
+
+/** ===============================================================================================
+ * \name    report
+ *
+ * \brief   Log the counters of the run
+ * ================================================================================================
+ */
+void
+OverloadController::report (void)
+{
+    log_I("OverloadController", "Frames: " + to_string(frameNum) + ", overloaded: " + to_string(overloadFrames) +
+                                ", skipped: " + to_string(skippedFrames) + ", shed tasks: " + to_string(shedTaskNum) +
+                                ", downgraded tasks: " + to_string(downgradedTaskNum) + ", max lag: " + to_string(maxLag) + " ms");
+}
@@ -0,0 +1,271 @@
+/**
+ * \name    Pipeline.cpp
+ *
+ * \brief   Implement the API
+ *
+ * \date    Oct 18, 2026
+ */
+
+#include "../include/Pipeline.hpp"
+
+/* The backpressure time of the current stage function, excluded from its busy time */
+static thread_local long blockedInStage = 0;
+
+/** ===============================================================================================
+ * \name    Pipeline
+ *
+ * \brief   Construct an empty pipeline
+ * ================================================================================================
+ */
+Pipeline::Pipeline (void) : running(false)
+{
+
+}
+
+
+/** ===============================================================================================
+ * \name    ~Pipeline
+ *
+ * \brief   Drain and release all stages
+ * ================================================================================================
+ */
+Pipeline::~Pipeline (void)
+{
+    stop();
+
+    for (auto stage : stages)
+    {
+        sem_destroy(&stage->pending);
+        delete stage->queue;
+        delete stage;
+    }
+}
+
+
+/** ===============================================================================================
+ * \name    addStage
+ *
+ * \brief   Append a stage, must be called before \b start
+ *
+ * \param   name the stage name for the report
+ * \param   func the stage function
+ * \param   arg the argument passed into the stage function
+ * \param   threadNum the number of threads of the stage
+ * \param   queueSize the capacity of the input queue of the stage
+ *
+ * \return  the stage id
+ * ================================================================================================
+ */
+int
+Pipeline::addStage (string name, Stage_Func_t func, void* arg, int threadNum, int queueSize)
+{
+    Stage_t* stage = new Stage_t();
+    stage->name         = name;
+    stage->id           = stages.size();
+    stage->func         = func;
+    stage->arg          = arg;
+    stage->pipeline     = this;
+    stage->queue        = new RingQueue<void*>(queueSize);
+    stage->closed       = false;
+    stage->items        = 0;
+    stage->busyUs       = 0;
+    stage->blockedUs    = 0;
+    stage->depthSum     = 0;
+    stage->depthSamples = 0;
+    stage->threads.resize(max(1, threadNum));
+    sem_init(&stage->pending, 0, 0);
+
+    stages.push_back(stage);
+    return stage->id;
+}
+
+
+/** ===============================================================================================
+ * \name    start
+ *
+ * \brief   Start the threads of all stages
+ * ================================================================================================
+ */
+void
+Pipeline::start (void)
+{
+    if (running) return;
+    running = true;
+    gettimeofday(&startTime, NULL);
+
+    for (auto stage : stages)
+    {
+        for (auto& thread : stage->threads)
+        {
+            pthread_create(&thread, NULL, Pipeline::threadStage, (void*)stage);
+        }
+        log_D("Pipeline", "Start stage " + stage->name + " with " + to_string(stage->threads.size()) + " threads");
+    }
+}
+
+
+/** ===============================================================================================
+ * \name    push
+ *
+ * \brief   Feed an item into the first stage, block while the queue is full
+ * ================================================================================================
+ */
+void
+Pipeline::push (void* item)
+{
+    enqueue(0, item, nullptr);
+}
+
+
+/** ===============================================================================================
+ * \name    emit
+ *
+ * \brief   Pass an item from a stage into the next stage, block while the queue is full. Must not
+ *          be called by the last stage.
+ *
+ * \param   stageId the stage id of the caller
+ * ================================================================================================
+ */
+void
+Pipeline::emit (int stageId, void* item)
+{
+    enqueue(stageId + 1, item, stages[stageId]);
+}
+
+
+/** ===============================================================================================
+ * \name    stop
+ *
+ * \brief   Close the stages in order, every stage drains its queue before the next one is closed
+ * ================================================================================================
+ */
+void
+Pipeline::stop (void)
+{
+    if (!running) return;
+    running = false;
+
+    for (auto stage : stages)
+    {
+        stage->closed = true;
+        for (size_t i = 0; i < stage->threads.size(); i++)
+        {
+            sem_post(&stage->pending);
+        }
+        for (auto thread : stage->threads)
+        {
+            pthread_join(thread, NULL);
+        }
+    }
+}
+
+
+/** ===============================================================================================
+ * \name    report
+ *
+ * \brief   Log the throughput, the busy ratio of the threads, the backpressure ratio and the average
+ *          queue occupancy of every stage
+ * ================================================================================================
+ */
+void
+Pipeline::report (void)
+{
+    struct timeval now;
+    gettimeofday(&now, NULL);
+    float elapsedUs = 1000000 * (now.tv_sec - startTime.tv_sec) + (now.tv_usec - startTime.tv_usec);
+    if (elapsedUs <= 0) return;
+
+    log_I("Pipeline", "Stage, threads, items, throughput (/s), busy, blocked, queue occupancy");
+    for (auto stage : stages)
+    {
+        float threadUs = elapsedUs * stage->threads.size();
+        float depth = stage->depthSamples ? (float)stage->depthSum / stage->depthSamples : 0;
+
+        string logInfo;
+        logInfo  = stage->name + ", ";
+        logInfo += to_string(stage->threads.size()) + ", ";
+        logInfo += to_string(stage->items.load()) + ", ";
+        logInfo += to_string(stage->items * 1000000.0 / elapsedUs) + ", ";
+        logInfo += to_string(stage->busyUs * 100.0 / threadUs) + "%, ";
+        logInfo += to_string(stage->blockedUs * 100.0 / threadUs) + "%, ";
+        logInfo += to_string(depth * 100.0 / stage->queue->capacity()) + "%";
+
+        log_I("Pipeline", logInfo);
+    }
+}
+
+
+/** ===============================================================================================
+ * \name    enqueue
+ *
+ * \brief   Push into the queue of the stage, account the blocked time into the producer stage
+ * ================================================================================================
+ */
+void
+Pipeline::enqueue (int stageId, void* item, Stage_t* producer)
+{
+    Stage_t* stage = stages[stageId];
+
+    stage->depthSum += stage->queue->size();
+    stage->depthSamples++;
+
+    if (!stage->queue->push(item))
+    {
+        struct timeval start, end;
+        gettimeofday(&start, NULL);
+            while (!stage->queue->push(item))
+            {
+                sched_yield();
+            }
+        gettimeofday(&end, NULL);
+
+        long blockedUs = 1000000 * (end.tv_sec - start.tv_sec) + (end.tv_usec - start.tv_usec);
+        if (producer)
+        {
+            producer->blockedUs += blockedUs;
+            blockedInStage += blockedUs;
+        }
+    }
+    sem_post(&stage->pending);
+}
+
+
+/** ===============================================================================================
+ * \name    threadStage
+ *
+ * \brief   Keep processing the items of one stage until the stage is closed and drained
+ *
+ * \param   arg the pointer of the Stage_t
+ * ================================================================================================
+ */
+void*
+Pipeline::threadStage (void* arg)
+{
+    Stage_t* stage = (Stage_t*) arg;
+    TRACE_THREAD(traceIntern("stage " + stage->name));
+
+    for (;;)
+    {
+        sem_wait(&stage->pending);
+
+        void* item;
+        if (!stage->queue->pop(item))
+        {
+            /* woken up by stop() with nothing left to do */
+            if (stage->closed.load()) break;
+            continue;
+        }
+
+        struct timeval start, end;
+        blockedInStage = 0;
+        gettimeofday(&start, NULL);
+            stage->func(item, stage->pipeline, stage->id, stage->arg);
+        gettimeofday(&end, NULL);
+
+        long spendUs = 1000000 * (end.tv_sec - start.tv_sec) + (end.tv_usec - start.tv_usec);
+        stage->busyUs += spendUs - blockedInStage;
+        stage->items++;
+    }
+
+    pthread_exit(nullptr);
+}
@@ -0,0 +1,200 @@
+/**
+ * \name    ResultBuffer.cpp
+ *
+ * \brief   Implement the API
+ *
+ * \date    Oct 18, 2026
+ */
+
+#include "../include/ResultBuffer.hpp"
+
+/** ===============================================================================================
+ * \name    ResultBuffer
+ *
+ * \brief   Preallocate the result buffer
+ *
+ * \param   capacity the maximum number of results in one frame
+ * ================================================================================================
+ */
+ResultBuffer::ResultBuffer (size_t capacity) : results(capacity), count(0)
+{
+
+}
+
+
+/** ===============================================================================================
+ * \name    reserve
+ *
+ * \brief   Reserve continuous slots for a decoded batch, thread-safe
+ *
+ * \param   num the number of slots
+ *
+ * \return  the first reserved slot, or nullptr if the buffer is full
+ * ================================================================================================
+ */
+Inference_Result_t*
+ResultBuffer::reserve (size_t num)
+{
+    /* a failed reservation leaves the count untouched */
+    size_t start = count.load();
+    do {
+        if (start + num > results.size()) return nullptr;
+    } while (!count.compare_exchange_weak(start, start + num));
+
+    return &results[start];
+}
+
+
+/** ===============================================================================================
+ * \name    simdMax
+ *
+ * \brief   The maximum value of the array
+ * ================================================================================================
+ */
+float
+simdMax (const float* data, int length)
+{
+    int i = 0;
+    float maxValue = -INFINITY;
+
+#if defined(__ARM_NEON)
+    if (length >= 4)
+    {
+        float32x4_t vmax = vld1q_f32(data);
+        for (i = 4; i + 4 <= length; i += 4)
+        {
+            vmax = vmaxq_f32(vmax, vld1q_f32(data + i));
+        }
+        float32x2_t pair = vpmax_f32(vget_low_f32(vmax), vget_high_f32(vmax));
+        pair = vpmax_f32(pair, pair);
+        maxValue = vget_lane_f32(pair, 0);
+    }
+#elif defined(__SSE2__)
+    if (length >= 4)
+    {
+        __m128 vmax = _mm_loadu_ps(data);
+        for (i = 4; i + 4 <= length; i += 4)
+        {
+            vmax = _mm_max_ps(vmax, _mm_loadu_ps(data + i));
+        }
+        vmax = _mm_max_ps(vmax, _mm_shuffle_ps(vmax, vmax, _MM_SHUFFLE(2, 3, 0, 1)));
+        vmax = _mm_max_ps(vmax, _mm_shuffle_ps(vmax, vmax, _MM_SHUFFLE(1, 0, 3, 2)));
+        maxValue = _mm_cvtss_f32(vmax);
+    }
+#endif
+
+    /* the tail, or the whole array without SIMD */
+    for (; i < length; i++)
+    {
+        if (data[i] > maxValue) maxValue = data[i];
+    }
+
+    return maxValue;
+}
+
+
+/** ===============================================================================================
+ * \name    simdArgmax
+ *
+ * \brief   The index of the first maximum value of the array
+ * ================================================================================================
+ */
+int
+simdArgmax (const float* data, int length)
+{
+    float maxValue = simdMax(data, length);
+
+    for (int i = 0; i < length; i++)
+    {
+        if (data[i] == maxValue) return i;
+    }
+
+    return 0;
+}
+
+
+/** ===============================================================================================
+ * \name    softmaxScore
+ *
+ * \brief   The softmax probability of the maximum logit
+ *
+ * \param   maxValue the maximum of the logits, from \b simdMax
+ * ================================================================================================
+ */
+float
+softmaxScore (const float* data, int length, float maxValue)
+{
+    float sum = 0;
+    for (int i = 0; i < length; i++)
+    {
+        sum += expf(data[i] - maxValue);
+    }
+
+    return sum > 0 ? 1.0f / sum : 0;
+}
+
+
+/** ===============================================================================================
+ * \name    simdTopK
+ *
+ * \brief   The indices of the k largest values in descending order. A block of 4 values is skipped
+ *          by one vector compare when none of them beats the current k-th value.
+ *
+ * \param   indices the output array, at least k elements
+ *
+ * \return  the number of found indices, min(k, length)
+ * ================================================================================================
+ */
+int
+simdTopK (const float* data, int length, int k, int* indices)
+{
+    k = min(k, length);
+    if (k <= 0) return 0;
+    if (k == 1)
+    {
+        indices[0] = simdArgmax(data, length);
+        return 1;
+    }
+
+    int found = 0;
+    float threshold = -INFINITY;
+
+    /* insert into the sorted indices, drop the smallest if full */
+    auto insert = [&](int idx) {
+        int pos = found < k ? found++ : k - 1;
+        while (pos > 0 && data[indices[pos - 1]] < data[idx])
+        {
+            indices[pos] = indices[pos - 1];
+            pos--;
+        }
+        indices[pos] = idx;
+        if (found == k) threshold = data[indices[k - 1]];
+    };
+
+    int i = 0;
+#if defined(__ARM_NEON) || defined(__SSE2__)
+    for (; i + 4 <= length; i += 4)
+    {
+#if defined(__ARM_NEON)
+        uint32x4_t greater = vcgtq_f32(vld1q_f32(data + i), vdupq_n_f32(threshold));
+        uint32x2_t pair = vpmax_u32(vget_low_u32(greater), vget_high_u32(greater));
+        bool any = vget_lane_u32(vpmax_u32(pair, pair), 0) != 0;
+#else
+        bool any = _mm_movemask_ps(_mm_cmpgt_ps(_mm_loadu_ps(data + i), _mm_set1_ps(threshold))) != 0;
+#endif
+        if (!any && found == k) continue;
+
+        for (int j = i; j < i + 4; j++)
+        {
+            if (found < k || data[j] > threshold) insert(j);
+        }
+    }
+#endif
+
+    for (; i < length; i++)
+    {
+        if (found < k || data[i] > threshold) insert(i);
+    }
+
+    return found;
+}
@@ -0,0 +1,197 @@
+/**
+ * \name    TaskQueue.cpp
+ *
+ * \brief   Implement the API
+ *
+ * \date    Oct 18, 2026
+ */
+
+#include "../include/TaskQueue.hpp"
+
+/** ===============================================================================================
+ * \name    TaskQueue
+ *
+ * \brief   Construct an empty task queue
+ * ================================================================================================
+ */
+TaskQueue::TaskQueue (void) : taskNum(0)
+{
+
+}
+
+
+/** ===============================================================================================
+ * \name    addModel
+ *
+ * \brief   Register a model, the tasks of unregistered models are registered on the first push
+ *
+ * \return  the index of the model heap
+ * ================================================================================================
+ */
+int
+TaskQueue::addModel (OnnxModel* model)
+{
+    int index = modelIndex(model);
+    if (index >= 0) return index;
+
+    models.push_back(model);
+    heaps.emplace_back();
+    priorities.push_back(0);
+
+    return models.size() - 1;
+}
+
+
+/** ===============================================================================================
+ * \name    push
+ *
+ * \brief   Insert a task into the heap of its model
+ * ================================================================================================
+ */
+void
+TaskQueue::push (const Inference_Task_t& task)
+{
+    int index = addModel(task.model);
+
+    heaps[index].push_back(task);
+    push_heap(heaps[index].begin(), heaps[index].end(), lowerPriority);
+    priorities[index] += task.priority;
+    taskNum++;
+}
+
+
+/** ===============================================================================================
+ * \name    pop
+ *
+ * \brief   Remove the most priority task of all models, the queue must not be empty
+ * ================================================================================================
+ */
+Inference_Task_t
+TaskQueue::pop (void)
+{
+    int best = -1;
+    for (int i = 0; i < heaps.size(); i++)
+    {
+        if (heaps[i].empty()) continue;
+        if (best < 0 || heaps[i].front().priority > heaps[best].front().priority) best = i;
+    }
+
+    return pop(models[best]);
+}
+
+
+/** ===============================================================================================
+ * \name    pop
+ *
+ * \brief   Remove the most priority task of the model, the model must have tasks
+ * ================================================================================================
+ */
+Inference_Task_t
+TaskQueue::pop (OnnxModel* model)
+{
+    int index = modelIndex(model);
+    vector<Inference_Task_t>& heap = heaps[index];
+
+    pop_heap(heap.begin(), heap.end(), lowerPriority);
+    Inference_Task_t task = heap.back();
+    heap.pop_back();
+
+    priorities[index] = heap.empty() ? 0 : priorities[index] - task.priority;
+    taskNum--;
+
+    return task;
+}
+
+
+/** ===============================================================================================
+ * \name    top
+ *
+ * \brief   The most priority task of the model, the model must have tasks
+ * ================================================================================================
+ */
+const Inference_Task_t&
+TaskQueue::top (OnnxModel* model) const
+{
+    return heaps[modelIndex(model)].front();
+}
+
+
+/** ===============================================================================================
+ * \name    priority
+ *
+ * \return  the summed priority of the tasks of the model
+ * ================================================================================================
+ */
+float
+TaskQueue::priority (OnnxModel* model) const
+{
+    int index = modelIndex(model);
+    return index < 0 ? 0 : priorities[index];
+}
+
+
+/** ===============================================================================================
+ * \name    size
+ *
+ * \return  the number of the tasks of the model
+ * ================================================================================================
+ */
+size_t
+TaskQueue::size (OnnxModel* model) const
+{
+    int index = modelIndex(model);
+    return index < 0 ? 0 : heaps[index].size();
+}
+
+
+/** ===============================================================================================
+ * \name    snapshot
+ *
+ * \brief   Copy out all tasks in heap order, for logging
+ * ================================================================================================
+ */
+void
+TaskQueue::snapshot (vector<Inference_Task_t>* tasks) const
+{
+    tasks->clear();
+    for (auto& heap : heaps)
+    {
+        tasks->insert(tasks->end(), heap.begin(), heap.end());
+    }
+}
+
+
+/** ===============================================================================================
+ * \name    clear
+ *
+ * \brief   Remove all tasks, keep the registered models and the heap capacity
+ * ================================================================================================
+ */
+void
+TaskQueue::clear (void)
+{
+    for (int i = 0; i < heaps.size(); i++)
+    {
+        heaps[i].clear();
+        priorities[i] = 0;
+    }
+    taskNum = 0;
+}
+
+
+/** ===============================================================================================
+ * \name    modelIndex
+ *
+ * \return  the heap index of the model, -1 if not registered
+ * ================================================================================================
+ */
+int
+TaskQueue::modelIndex (OnnxModel* model) const
+{
+    for (int i = 0; i < models.size(); i++)
+    {
+        if (models[i] == model) return i;
+    }
+
+    return -1;
+}
@@ -0,0 +1,243 @@
+/**
+ * \name    Trace.cpp
+ *
+ * \brief   Implement the API
+ *
+ * \date    Oct 18, 2026
+ */
+
+#include "../include/Trace.hpp"
+
+#include <set>
+
+#include <pthread.h>
+#include <stdio.h>
+
+/* ************************************************************************************************
+ * Type Define
+ * ************************************************************************************************
+ */
+/* The events of one thread, the oldest are overwritten once full */
+typedef struct {
+    std::vector<Trace_Event_t>  events;
+    size_t                      mask;
+    std::atomic<size_t>         head;       // the next event to write
+    int                         tid;
+    const char*                 name;
+}Trace_Buffer_t;
+
+/* ************************************************************************************************
+ * Global Resource
+ * ************************************************************************************************
+ */
+static pthread_mutex_t traceMutex = PTHREAD_MUTEX_INITIALIZER;
+
+/* The buffers of all threads, registered once per thread under traceMutex */
+static std::vector<Trace_Buffer_t*> buffers;
+static thread_local Trace_Buffer_t* threadBuffer = nullptr;
+
+static std::atomic<bool> tracing(false);
+static uint64_t traceStart = 0;
+
+/* The names built at run time, kept until the export */
+static std::set<std::string> internedNames;
+
+static Trace_Buffer_t* traceBuffer (void);
+static void traceWriteString (FILE* file, const char* str);
+
+/* ************************************************************************************************
+ * Global Resource
+ * ************************************************************************************************
+ */
+void traceInit (void)
+{
+    traceStart = traceNow();
+    tracing = true;
+}
+
+void traceDestory (void)
+{
+    if (!tracing.exchange(false)) return;
+
+    /* ******************************************
+     * Export, the traced threads are stopped
+     * ******************************************
+     */
+    FILE* file = fopen(TRACE_FILE, "w");
+    pthread_mutex_lock(&traceMutex);
+    if (file)
+    {
+        fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+        fprintf(file, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"RT_Inference\"}}");
+
+        for (auto buffer : buffers)
+        {
+            if (buffer->name)
+            {
+                fprintf(file, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":", buffer->tid);
+                traceWriteString(file, buffer->name);
+                fprintf(file, "}}");
+            }
+
+            size_t head = buffer->head.load(std::memory_order_acquire);
+            size_t tail = head > buffer->events.size() ? head - buffer->events.size() : 0;
+            for (size_t i = tail; i < head; i++)
+            {
+                const Trace_Event_t& event = buffer->events[i & buffer->mask];
+                double ts = (event.start - traceStart) * 0.001;
+
+                fprintf(file, ",\n{\"name\":");
+                traceWriteString(file, event.name);
+                fprintf(file, ",\"cat\":");
+                traceWriteString(file, event.category);
+                fprintf(file, ",\"ph\":\"%c\",\"pid\":1,\"tid\":%d,\"ts\":%.3f", event.phase, buffer->tid, ts);
+
+                if (event.phase == 'X')
+                {
+                    fprintf(file, ",\"dur\":%.3f", event.duration * 0.001);
+                } else if (event.phase == 'i') {
+                    fprintf(file, ",\"s\":\"t\"");
+                }
+
+                if (event.phase == 'C')
+                {
+                    fprintf(file, ",\"args\":{\"value\":%ld}", event.arg);
+                } else if (event.arg >= 0) {
+                    fprintf(file, ",\"args\":{\"arg\":%ld}", event.arg);
+                }
+                fprintf(file, "}");
+            }
+        }
+
+        fprintf(file, "\n]}\n");
+        fclose(file);
+    }
+
+        for (auto buffer : buffers)
+        {
+            delete buffer;
+        }
+        buffers.clear();
+        internedNames.clear();
+    pthread_mutex_unlock(&traceMutex);
+
+    /* the buffers of the living threads are gone */
+    threadBuffer = nullptr;
+}
+
+
+/** ===============================================================================================
+ * \name    traceThread
+ *
+ * \brief   Name the calling thread in the timeline
+ *
+ * \param   name a string literal or an interned name
+ * ================================================================================================
+ */
+void
+traceThread (const char* name)
+{
+    Trace_Buffer_t* buffer = traceBuffer();
+    if (buffer) buffer->name = name;
+}
+
+
+/** ===============================================================================================
+ * \name    traceRecord
+ *
+ * \brief   Write an event into the buffer of the calling thread
+ *
+ * \param   phase 'X' complete span, 'i' instant, 'C' counter
+ * \param   category the group of the event
+ * \param   name the event
+ * \param   start ns of CLOCK_MONOTONIC
+ * \param   duration ns of a complete span
+ * \param   arg the argument of the event, omitted if negative, the value of a counter
+ * ================================================================================================
+ */
+void
+traceRecord (char phase, const char* category, const char* name, uint64_t start, uint64_t duration, long arg)
+{
+    Trace_Buffer_t* buffer = traceBuffer();
+    if (!buffer) return;
+
+    size_t head = buffer->head.load(std::memory_order_relaxed);
+    Trace_Event_t& event = buffer->events[head & buffer->mask];
+    event.category  = category;
+    event.name      = name;
+    event.start     = start;
+    event.duration  = duration;
+    event.arg       = arg;
+    event.phase     = phase;
+    buffer->head.store(head + 1, std::memory_order_release);
+}
+
+
+/** ===============================================================================================
+ * \name    traceIntern
+ *
+ * \brief   Keep a name built at run time until the export, e.g. the name of a model
+ *
+ * \return  the name to pass to the trace macros
+ * ================================================================================================
+ */
+const char*
+traceIntern (const std::string& str)
+{
+    pthread_mutex_lock(&traceMutex);
+        const char* name = internedNames.insert(str).first->c_str();
+    pthread_mutex_unlock(&traceMutex);
+
+    return name;
+}
+
+
+/** ===============================================================================================
+ * \name    traceBuffer
+ *
+ * \brief   The buffer of the calling thread, registered at the first event
+ *
+ * \return  nullptr if the tracing is not running
+ * ================================================================================================
+ */
+static Trace_Buffer_t*
+traceBuffer (void)
+{
+    if (!tracing.load(std::memory_order_relaxed)) return nullptr;
+    if (threadBuffer) return threadBuffer;
+
+    Trace_Buffer_t* buffer = new Trace_Buffer_t();
+    size_t size = 2;
+    while (size < TRACE_BUFFER_SIZE) size <<= 1;
+    buffer->events.resize(size);
+    buffer->mask = size - 1;
+    buffer->head = 0;
+    buffer->name = nullptr;
+
+    pthread_mutex_lock(&traceMutex);
+        buffer->tid = buffers.size() + 1;
+        buffers.push_back(buffer);
+    pthread_mutex_unlock(&traceMutex);
+
+    threadBuffer = buffer;
+    return buffer;
+}
+
+
+/** ===============================================================================================
+ * \name    traceWriteString
+ *
+ * \brief   Write a JSON string
+ * ================================================================================================
+ */
+static void
+traceWriteString (FILE* file, const char* str)
+{
+    fputc('"', file);
+    for (const char* c = str ? str : ""; *c; c++)
+    {
+        if (*c == '"' || *c == '\\') fputc('\\', file);
+        if ((unsigned char)*c >= 0x20) fputc(*c, file);
+    }
+    fputc('"', file);
+}
@@ -2,6 +2,7 @@
 #include "include/InferenceEngine.hpp"
 #include "include/Log.hpp"
 #include "include/SensingEngine.hpp"
+#include "include/Trace.hpp"
 
 /* ************************************************************************************************
  * Global Resource
@@ -10,10 +11,17 @@
 void globalResourceInit_hook (void)
 {
     logInit();
+#if TRACE_ENABLE
+    traceInit();
+    TRACE_THREAD("main");
+#endif
 }
 
 void globalResourceDestory_hook (void)
 {
+#if TRACE_ENABLE
+    traceDestory();
+#endif
     logDestory();
 }
 
@@ -26,6 +34,51 @@ int main (int argc, char** argv)
 
     globalResourceInit_hook();
 
+#if MULTI_STREAM_NUM > 1
+    // Several streams on one shared model pool
+    MultiStreamEngine* MSE = new MultiStreamEngine();
+    vector<SensingEngine*> sensors;
+
+    /* the datasets of the streams from the arguments, or from the configuration */
+    vector<string> datasetPaths(argv + 1, argv + argc);
+    if (datasetPaths.empty()) datasetPaths = STREAM_DATASET_PATHS;
+    if (datasetPaths.size() < MULTI_STREAM_NUM)
+    {
+        log_W("main", to_string(datasetPaths.size()) + " datasets for " + to_string(MULTI_STREAM_NUM) + " streams, the streams replay them in turn");
+    }
+
+    for (int streamId = 0; streamId < MULTI_STREAM_NUM; streamId++)
+    {
+        SensingEngine* SE = new SensingEngine(datasetPaths[streamId % datasetPaths.size()]);
+        SE->run();
+        sensors.push_back(SE);
+
+#if (INFERENCE_ENGINE == RT_CPS)
+        MSE->addStream(new CPS_Engine(SE));
+#elif (INFERENCE_ENGINE == RT_SGE)
+        MSE->addStream(new SGE_Engine(SE));
+#endif
+    }
+    MSE->run();
+
+    // Finish all
+    log_D("main", "Finish multi-stream engine");
+    for (auto SE : sensors)
+    {
+        SE->stop();
+    }
+
+    /* the stream engines are deleted with the MultiStreamEngine */
+    delete MSE;
+    for (auto SE : sensors)
+    {
+        delete SE;
+    }
+
+    globalResourceDestory_hook();
+    return 0;
+#endif
+
     // Parallel perception sensing, synchronous in period.
     SensingEngine SE;
     SE.run();
@@ -45,6 +98,7 @@ int main (int argc, char** argv)
     // Finish all
     log_D("main", "Finish inference engine");
     SE.stop();
+    delete IE;
 
     globalResourceDestory_hook();
 }
\ No newline at end of file
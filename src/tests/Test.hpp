@@ -0,0 +1,42 @@
+/**
+ * \name    Test.hpp
+ *
+ * \brief   The minimal checks of the test programs, each program under tests/ is built with the
+ *          library objects and run by "make test"
+ *
+ * \date    Oct 18, 2026
+ */
+
+#ifndef _TEST_HPP_
+#define _TEST_HPP_
+
+/* ************************************************************************************************
+ * Include Library
+ * ************************************************************************************************
+ */
+#include <stdio.h>
+#include <stdlib.h>
+
+/* ************************************************************************************************
+ * Test Macros
+ *
+ * CHECK aborts the program at the first failure, RUN_TEST prints the name of every test case.
+ * ************************************************************************************************
+ */
+#define CHECK(cond)                                                                     \
+    do {                                                                                \
+        if (!(cond))                                                                    \
+        {                                                                               \
+            fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #cond);    \
+            exit(1);                                                                    \
+        }                                                                               \
+    } while (0)
+
+#define RUN_TEST(test)                                                                  \
+    do {                                                                                \
+        printf("[ RUN  ] %s\n", #test);                                                 \
+        test();                                                                         \
+        printf("[  OK  ] %s\n", #test);                                                 \
+    } while (0)
+
+#endif
@@ -0,0 +1,134 @@
+/**
+ * \name    test_EdfDispatcher.cpp
+ *
+ * \brief   Check the heap order of the EDF dispatcher: the earliest deadline first, then the most
+ *          priority among the tasks of the same deadline
+ *
+ * \date    Oct 18, 2026
+ */
+
+#include "Test.hpp"
+#include "../include/EdfDispatcher.hpp"
+
+/** ===============================================================================================
+ * \name    EdfDispatcherTest
+ *
+ * \brief   Drive the private deadline heap of EdfDispatcher
+ * ================================================================================================
+ */
+class EdfDispatcherTest
+{
+public:
+    typedef EdfDispatcher::Edf_Task_t Edf_Task_t;
+
+    static Edf_Task_t* makeTask (long deadlineUs, float priority)
+    {
+        Edf_Task_t* task = new Edf_Task_t();
+        task->task.data         = nullptr;
+        task->task.priority     = priority;
+        task->task.model        = nullptr;
+        task->frameId           = 0;
+        task->deadline.tv_sec   = deadlineUs / 1000000;
+        task->deadline.tv_usec  = deadlineUs % 1000000;
+        return task;
+    }
+
+    static void push (vector<Edf_Task_t*>& heap, Edf_Task_t* task)
+    {
+        heap.push_back(task);
+        push_heap(heap.begin(), heap.end(), EdfDispatcher::laterDeadline);
+    }
+
+    static Edf_Task_t* pop (vector<Edf_Task_t*>& heap)
+    {
+        pop_heap(heap.begin(), heap.end(), EdfDispatcher::laterDeadline);
+        Edf_Task_t* task = heap.back();
+        heap.pop_back();
+        return task;
+    }
+
+    /* ********************************************************************************************
+     * Test Cases
+     * ********************************************************************************************
+     */
+    static void testDeadlineFirst (void)
+    {
+        vector<Edf_Task_t*> heap;
+        push(heap, makeTask(3000000, 1.0f));
+        push(heap, makeTask(1500000, 0.1f));
+        push(heap, makeTask(2999999, 9.0f));
+        push(heap, makeTask(1000001, 0.5f));
+
+        /* the seconds and the microseconds are compared together */
+        long expected[] = {1000001, 1500000, 2999999, 3000000};
+        for (long deadlineUs : expected)
+        {
+            Edf_Task_t* task = pop(heap);
+            CHECK(task->deadline.tv_sec * 1000000 + task->deadline.tv_usec == deadlineUs);
+            delete task;
+        }
+        CHECK(heap.empty());
+    }
+
+    static void testPriorityTieBreak (void)
+    {
+        vector<Edf_Task_t*> heap;
+        push(heap, makeTask(2000000, 0.2f));
+        push(heap, makeTask(1000000, 0.3f));
+        push(heap, makeTask(1000000, 0.9f));
+        push(heap, makeTask(1000000, 0.1f));
+
+        float expected[] = {0.9f, 0.3f, 0.1f, 0.2f};
+        for (float priority : expected)
+        {
+            Edf_Task_t* task = pop(heap);
+            CHECK(task->task.priority == priority);
+            delete task;
+        }
+    }
+
+    static void testInterleaved (void)
+    {
+        /* the admissions of the next frames interleave with the dispatching */
+        vector<Edf_Task_t*> heap;
+        srand(1);
+
+        long lastDeadline = -1;
+        float lastPriority = 0;
+        long now = 0;
+        for (int i = 0; i < 10000; i++)
+        {
+            if (heap.empty() || rand() % 3)
+            {
+                push(heap, makeTask(now + rand() % 100000, (float) (rand() % 8)));
+                continue;
+            }
+
+            /* a popped task is never later than the rest of the heap */
+            Edf_Task_t* task = pop(heap);
+            long deadlineUs = task->deadline.tv_sec * 1000000 + task->deadline.tv_usec;
+            for (auto rest : heap)
+            {
+                CHECK(!EdfDispatcher::laterDeadline(task, rest));
+            }
+            if (deadlineUs == lastDeadline) CHECK(task->task.priority <= lastPriority);
+
+            lastDeadline = deadlineUs;
+            lastPriority = task->task.priority;
+            now = deadlineUs;
+            delete task;
+        }
+
+        for (auto task : heap) delete task;
+    }
+};
+
+
+int
+main (void)
+{
+    RUN_TEST(EdfDispatcherTest::testDeadlineFirst);
+    RUN_TEST(EdfDispatcherTest::testPriorityTieBreak);
+    RUN_TEST(EdfDispatcherTest::testInterleaved);
+    return 0;
+}
@@ -0,0 +1,271 @@
+/**
+ * \name    test_InferenceExecutor.cpp
+ *
+ * \brief   Check the completion of the inference jobs and the preemption by the urgent jobs. The
+ *          cases with a model are skipped if the model is not under MODEL_PATH.
+ *
+ * \date    Oct 18, 2026
+ */
+
+#include "Test.hpp"
+#include "../include/InferenceExecutor.hpp"
+#include "../include/OnnxModels.hpp"
+
+#include <fstream>
+
+#include <pthread.h>
+#include <sched.h>
+
+/* ************************************************************************************************
+ * Global Resource
+ * ************************************************************************************************
+ */
+#define TEST_MODEL_NAME     "resnet50_56_56"
+#define TEST_BATCH_LIMIT    4
+#define COMPLETION_ROUNDS   100000
+#define NORMAL_JOB_NUM      8
+
+typedef struct {
+    RingQueue<InferenceJob*>*   jobs;
+    atomic<bool>                running;
+}Finisher_Arg_t;
+
+
+/** ===============================================================================================
+ * \name    testJobCompletion
+ *
+ * \brief   The waiter deletes the job as soon as \b wait returns, while the worker could still be
+ *          inside \b finish. Every job wakes up the waiter and the notify exactly once.
+ * ================================================================================================
+ */
+static void*
+threadFinisher (void* arg)
+{
+    Finisher_Arg_t* finisher = (Finisher_Arg_t*) arg;
+    InferenceJob* job;
+    while (finisher->running.load() || finisher->jobs->size() > 0)
+    {
+        if (finisher->jobs->pop(job))
+        {
+            job->finish();
+        } else {
+            sched_yield();
+        }
+    }
+    return nullptr;
+}
+
+static void
+testJobCompletion (void)
+{
+    RingQueue<InferenceJob*> jobs(16);
+    Finisher_Arg_t finisher;
+    finisher.jobs = &jobs;
+    finisher.running = true;
+
+    sem_t notify;
+    sem_init(&notify, 0, 0);
+
+    pthread_t thread;
+    pthread_create(&thread, NULL, threadFinisher, &finisher);
+
+    for (int i = 0; i < COMPLETION_ROUNDS; i++)
+    {
+        InferenceJob* job = new InferenceJob(nullptr);
+        job->notify = &notify;
+        while (!jobs.push(job)) sched_yield();
+
+        job->wait();
+        CHECK(job->isDone());
+        delete job;
+    }
+
+    finisher.running = false;
+    pthread_join(thread, NULL);
+
+    int notified = 0;
+    while (sem_trywait(&notify) == 0) notified++;
+    CHECK(notified == COMPLETION_ROUNDS);
+    sem_destroy(&notify);
+}
+
+
+/** ===============================================================================================
+ * \name    loadTestModel
+ *
+ * \brief   Load the test model if it is exported
+ *
+ * \return  nullptr if the model is not found
+ * ================================================================================================
+ */
+static OnnxModel*
+loadTestModel (void)
+{
+    string prefix = string(MODEL_PATH) + TEST_MODEL_NAME;
+    if (!ifstream(prefix + ".onnx").good() && !ifstream(prefix + ".segments").good())
+    {
+        printf("[ SKIP ] %s not found\n", (prefix + ".onnx").c_str());
+        return nullptr;
+    }
+    return new OnnxResNet(TEST_MODEL_NAME, TEST_BATCH_LIMIT);
+}
+
+static InferenceJob*
+submitBatch (InferenceExecutor* executor, OnnxModel* model, int sampleNum, const timeval* deadline, bool urgent, ResultBuffer* results)
+{
+    for (int i = 0; i < sampleNum; i++)
+    {
+        model->Onnx_addInput(vector<float>(model->singleInputSize, 0.5f));
+    }
+    return executor->submit(model, deadline, urgent, results);
+}
+
+
+/** ===============================================================================================
+ * \name    testExecutorPreemption
+ *
+ * \brief   With one worker, an urgent job overtakes the queued normal jobs and preempts the running
+ *          one between its segments. The preempted job is resumed and every job completes with its
+ *          results.
+ * ================================================================================================
+ */
+static void
+testExecutorPreemption (void)
+{
+    OnnxModel* model = loadTestModel();
+    if (!model) return;
+
+    InferenceExecutor executor;
+    executor.addModel(model, 1);
+
+    ResultBuffer normalResults, urgentResults;
+    vector<InferenceJob*> normalJobs;
+    for (int i = 0; i < NORMAL_JOB_NUM; i++)
+    {
+        normalJobs.push_back(submitBatch(&executor, model, TEST_BATCH_LIMIT, nullptr, false, &normalResults));
+    }
+    InferenceJob* urgentJob = submitBatch(&executor, model, 1, nullptr, true, &urgentResults);
+
+    urgentJob->wait();
+    CHECK(!urgentJob->cancelled);
+    CHECK(urgentResults.size() == RESULT_TOP_K);
+
+    /* the urgent job does not wait for the whole queue */
+    int normalDone = 0;
+    for (auto job : normalJobs)
+    {
+        if (job->isDone()) normalDone++;
+    }
+    CHECK(normalDone < NORMAL_JOB_NUM);
+    delete urgentJob;
+
+    for (auto job : normalJobs)
+    {
+        job->wait();
+        CHECK(!job->cancelled);
+        CHECK(job->progress.nextSegment == 0);
+        delete job;
+    }
+    CHECK(normalResults.size() == NORMAL_JOB_NUM * TEST_BATCH_LIMIT * RESULT_TOP_K);
+
+    executor.stop();
+    delete model;
+}
+
+
+/** ===============================================================================================
+ * \name    testExecutorCancel
+ *
+ * \brief   A job past its deadline and a revoked job queued behind a busy worker are finished as
+ *          cancelled without results
+ * ================================================================================================
+ */
+static void
+testExecutorCancel (void)
+{
+    OnnxModel* model = loadTestModel();
+    if (!model) return;
+
+    InferenceExecutor executor;
+    executor.addModel(model, 1);
+
+    ResultBuffer results;
+    timeval past;
+    gettimeofday(&past, NULL);
+    past.tv_sec -= 1;
+
+    InferenceJob* expiredJob = submitBatch(&executor, model, 1, &past, false, &results);
+    expiredJob->wait();
+    CHECK(expiredJob->cancelled);
+    CHECK(results.size() == 0);
+    delete expiredJob;
+
+    vector<InferenceJob*> busyJobs;
+    for (int i = 0; i < NORMAL_JOB_NUM; i++)
+    {
+        busyJobs.push_back(submitBatch(&executor, model, TEST_BATCH_LIMIT, nullptr, false, nullptr));
+    }
+    InferenceJob* revokedJob = submitBatch(&executor, model, 1, nullptr, false, &results);
+    revokedJob->revoke();
+
+    revokedJob->wait();
+    CHECK(revokedJob->cancelled);
+    CHECK(results.size() == 0);
+    delete revokedJob;
+
+    for (auto job : busyJobs)
+    {
+        job->wait();
+        delete job;
+    }
+
+    executor.stop();
+    delete model;
+}
+
+
+/** ===============================================================================================
+ * \name    testExecutorStop
+ *
+ * \brief   Stopping with jobs in the queues finishes them as cancelled, no waiter is left blocked
+ * ================================================================================================
+ */
+static void
+testExecutorStop (void)
+{
+    OnnxModel* model = loadTestModel();
+    if (!model) return;
+
+    InferenceExecutor executor;
+    executor.addModel(model, 1);
+
+    vector<InferenceJob*> jobs;
+    for (int i = 0; i < NORMAL_JOB_NUM; i++)
+    {
+        jobs.push_back(submitBatch(&executor, model, TEST_BATCH_LIMIT, nullptr, false, nullptr));
+    }
+    executor.stop();
+
+    int cancelledNum = 0;
+    for (auto job : jobs)
+    {
+        job->wait();
+        if (job->cancelled) cancelledNum++;
+        delete job;
+    }
+
+    /* the worker only finishes the jobs it took before the stop */
+    CHECK(cancelledNum > 0);
+    delete model;
+}
+
+
+int
+main (void)
+{
+    RUN_TEST(testJobCompletion);
+    RUN_TEST(testExecutorPreemption);
+    RUN_TEST(testExecutorCancel);
+    RUN_TEST(testExecutorStop);
+    return 0;
+}
@@ -0,0 +1,153 @@
+/**
+ * \name    test_LatencyProfile.cpp
+ *
+ * \brief   Check the latency histogram: the percentiles within the bucket error, the worst case, the
+ *          batch size fallback and the save then load round trip
+ *
+ * \date    Oct 18, 2026
+ */
+
+#include "Test.hpp"
+#include "../include/LatencyProfile.hpp"
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+/* ************************************************************************************************
+ * Global Resource
+ * ************************************************************************************************
+ */
+#define TEST_PROFILE_NAME   "test_latency_profile"
+
+/* The upper edge of a bucket is at most one growth step above the sample */
+static bool
+withinBucket (float estimate, float latency)
+{
+    return estimate >= latency * 0.999f && estimate <= latency * LATENCY_BUCKET_GROWTH * 1.001f;
+}
+
+
+/** ===============================================================================================
+ * \name    testPercentiles
+ *
+ * \brief   The percentiles of 1..100 ms are within one bucket of the exact ranks, and never above
+ *          the observed maximum
+ * ================================================================================================
+ */
+static void
+testPercentiles (void)
+{
+    LatencyHistogram histogram;
+    CHECK(histogram.percentile(0.5) == 0);
+
+    for (int i = 100; i >= 1; i--)
+    {
+        histogram.record((float) i);
+    }
+
+    CHECK(histogram.count == 100);
+    CHECK(histogram.maxLatency == 100);
+    CHECK(fabs(histogram.mean() - 50.5) < 1e-3);
+
+    CHECK(withinBucket(histogram.percentile(0.50), 50));
+    CHECK(withinBucket(histogram.percentile(0.95), 95));
+    CHECK(withinBucket(histogram.percentile(0.99), 99));
+    CHECK(histogram.percentile(1.0) == 100);
+    CHECK(histogram.percentile(0) <= histogram.percentile(0.5));
+
+    /* one outlier moves the max and the tail only */
+    histogram.record(1000);
+    CHECK(histogram.maxLatency == 1000);
+    CHECK(histogram.percentile(1.0) == 1000);
+    CHECK(withinBucket(histogram.percentile(0.50), 51));
+}
+
+
+/** ===============================================================================================
+ * \name    testBatchFallback
+ *
+ * \brief   A batch size without samples falls back to the smallest larger one, otherwise to the
+ *          largest profiled one
+ * ================================================================================================
+ */
+static void
+testBatchFallback (void)
+{
+    LatencyProfile profile(TEST_PROFILE_NAME);
+    CHECK(profile.getPercentile(1, 0.95) == 0);
+    CHECK(!profile.isProfiled(1));
+
+    for (int i = 0; i < 10; i++)
+    {
+        profile.record(2, 10);
+        profile.record(4, 20);
+    }
+    profile.record(4, 40);
+
+    CHECK(profile.isProfiled(2) && profile.isProfiled(4) && !profile.isProfiled(3));
+    CHECK(withinBucket(profile.getPercentile(1, 0.5), 10));
+    CHECK(withinBucket(profile.getPercentile(3, 0.5), 20));
+    CHECK(withinBucket(profile.getPercentile(8, 0.5), 20));
+    CHECK(profile.getMax(2) == 10);
+    CHECK(profile.getMax(4) == 40);
+}
+
+
+/** ===============================================================================================
+ * \name    testSaveLoad
+ *
+ * \brief   A saved profile is loaded back with the same counts, maxima and percentiles
+ * ================================================================================================
+ */
+static void
+testSaveLoad (void)
+{
+    mkdir(LATENCY_PROFILE_PATH, 0755);
+    string filePath = string(LATENCY_PROFILE_PATH) + TEST_PROFILE_NAME + ".latency";
+    unlink(filePath.c_str());
+
+    LatencyProfile saved(TEST_PROFILE_NAME);
+    CHECK(!saved.load());
+
+    for (int i = 1; i <= 200; i++)
+    {
+        saved.record(1, 0.5f + i * 0.01f);
+        saved.record(4, 3.0f + i * 0.1f);
+    }
+    CHECK(saved.save());
+
+    LatencyProfile loaded(TEST_PROFILE_NAME);
+    CHECK(loaded.load());
+    for (int batchSize : {1, 4})
+    {
+        CHECK(loaded.isProfiled(batchSize));
+        CHECK(loaded.getMax(batchSize) == saved.getMax(batchSize));
+        for (float p : {0.5f, 0.95f, 0.99f})
+        {
+            CHECK(loaded.getPercentile(batchSize, p) == saved.getPercentile(batchSize, p));
+        }
+    }
+    CHECK(!loaded.isProfiled(2));
+
+    /* a broken file is ignored as a whole */
+    FILE* file = fopen(filePath.c_str(), "a");
+    CHECK(file);
+    fprintf(file, "2 broken\n");
+    fclose(file);
+
+    LatencyProfile broken(TEST_PROFILE_NAME);
+    CHECK(!broken.load());
+    CHECK(!broken.isProfiled(1));
+
+    unlink(filePath.c_str());
+}
+
+
+int
+main (void)
+{
+    RUN_TEST(testPercentiles);
+    RUN_TEST(testBatchFallback);
+    RUN_TEST(testSaveLoad);
+    return 0;
+}
@@ -0,0 +1,143 @@
+/**
+ * \name    test_ResultBuffer.cpp
+ *
+ * \brief   Check the concurrent reservation of the result buffer: no overlapped slots and a full
+ *          buffer never overshoots its capacity
+ *
+ * \date    Oct 18, 2026
+ */
+
+#include "Test.hpp"
+#include "../include/ResultBuffer.hpp"
+
+#include <pthread.h>
+
+/* ************************************************************************************************
+ * Global Resource
+ * ************************************************************************************************
+ */
+#define WRITER_NUM          8
+#define RESERVE_PER_WRITER  10000
+
+typedef struct {
+    ResultBuffer*   buffer;
+    int             writerId;
+    size_t          reserveNum;     // the slots of one reservation
+    int             accepted;       // the successful reservations
+}Writer_Arg_t;
+
+
+/** ===============================================================================================
+ * \name    testReserveBound
+ *
+ * \brief   A reservation larger than the free slots fails and leaves the buffer usable
+ * ================================================================================================
+ */
+static void
+testReserveBound (void)
+{
+    ResultBuffer buffer(10);
+    CHECK(buffer.size() == 0);
+
+    Inference_Result_t* first = buffer.reserve(4);
+    CHECK(first == &buffer[0]);
+    CHECK(buffer.reserve(7) == nullptr);
+    CHECK(buffer.size() == 4);
+
+    Inference_Result_t* second = buffer.reserve(6);
+    CHECK(second == &buffer[4]);
+    CHECK(buffer.size() == 10);
+    CHECK(buffer.reserve(1) == nullptr);
+    CHECK(buffer.size() == 10);
+
+    buffer.clear();
+    CHECK(buffer.size() == 0);
+    CHECK(buffer.reserve(10) == &buffer[0]);
+}
+
+
+/** ===============================================================================================
+ * \name    testConcurrentReserve
+ *
+ * \brief   The writers fill the slots they reserved, every slot is written by one writer only and
+ *          the failed reservations of a full buffer do not move the count
+ * ================================================================================================
+ */
+static void*
+threadWriter (void* arg)
+{
+    Writer_Arg_t* writer = (Writer_Arg_t*) arg;
+    for (int i = 0; i < RESERVE_PER_WRITER; i++)
+    {
+        Inference_Result_t* slots = writer->buffer->reserve(writer->reserveNum);
+        if (!slots) continue;
+
+        for (size_t j = 0; j < writer->reserveNum; j++)
+        {
+            slots[j].model      = nullptr;
+            slots[j].sampleId   = i;
+            slots[j].classId    = writer->writerId;
+            slots[j].score      = (float) j;
+        }
+        writer->accepted++;
+    }
+    return nullptr;
+}
+
+static void
+testConcurrentReserve (void)
+{
+    /* room for a part of the reservations only, the rest should fail */
+    const size_t capacity = 30000;
+    ResultBuffer buffer(capacity);
+
+    pthread_t writers[WRITER_NUM];
+    Writer_Arg_t args[WRITER_NUM];
+    for (int i = 0; i < WRITER_NUM; i++)
+    {
+        args[i] = {&buffer, i, (size_t) (i % 3 + 1), 0};
+        pthread_create(&writers[i], NULL, threadWriter, &args[i]);
+    }
+
+    size_t reserved = 0;
+    for (int i = 0; i < WRITER_NUM; i++)
+    {
+        pthread_join(writers[i], NULL);
+        reserved += args[i].accepted * args[i].reserveNum;
+    }
+
+    CHECK(reserved <= capacity);
+    CHECK(buffer.size() == reserved);
+
+    /* every reservation is contiguous and owned by one writer */
+    vector<int> written(WRITER_NUM, 0);
+    for (size_t i = 0; i < buffer.size(); )
+    {
+        int writerId = buffer[i].classId;
+        CHECK(writerId >= 0 && writerId < WRITER_NUM);
+
+        size_t reserveNum = args[writerId].reserveNum;
+        CHECK(i + reserveNum <= buffer.size());
+        for (size_t j = 0; j < reserveNum; j++)
+        {
+            CHECK(buffer[i + j].classId == writerId);
+            CHECK(buffer[i + j].score == (float) j);
+        }
+        written[writerId]++;
+        i += reserveNum;
+    }
+
+    for (int i = 0; i < WRITER_NUM; i++)
+    {
+        CHECK(written[i] == args[i].accepted);
+    }
+}
+
+
+int
+main (void)
+{
+    RUN_TEST(testReserveBound);
+    RUN_TEST(testConcurrentReserve);
+    return 0;
+}
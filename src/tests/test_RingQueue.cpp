@@ -0,0 +1,170 @@
+/**
+ * \name    test_RingQueue.cpp
+ *
+ * \brief   Check the bounded MPMC queue: the capacity, the FIFO order and no lost or duplicated
+ *          element under concurrent producers and consumers
+ *
+ * \date    Oct 18, 2026
+ */
+
+#include "Test.hpp"
+#include "../include/RingQueue.hpp"
+
+#include <pthread.h>
+#include <sched.h>
+
+/* ************************************************************************************************
+ * Global Resource
+ * ************************************************************************************************
+ */
+#define PRODUCER_NUM        4
+#define CONSUMER_NUM        4
+#define ITEMS_PER_PRODUCER  200000
+
+typedef struct {
+    RingQueue<size_t>*  queue;
+    int                 producerId;
+    atomic<size_t>*     popped;
+    vector<atomic<int>>* seen;
+}Worker_Arg_t;
+
+
+/** ===============================================================================================
+ * \name    testCapacity
+ *
+ * \brief   The capacity is rounded up to the power of 2, a full queue rejects the push and an
+ *          empty queue rejects the pop
+ * ================================================================================================
+ */
+static void
+testCapacity (void)
+{
+    RingQueue<int> queue(5);
+    CHECK(queue.capacity() == 8);
+
+    int data;
+    CHECK(!queue.pop(data));
+
+    for (int i = 0; i < 8; i++)
+    {
+        CHECK(queue.push(i));
+    }
+    CHECK(!queue.push(8));
+    CHECK(queue.size() == 8);
+
+    CHECK(queue.pop(data) && data == 0);
+    CHECK(queue.push(8));
+    CHECK(!queue.push(9));
+}
+
+
+/** ===============================================================================================
+ * \name    testFifoWrapAround
+ *
+ * \brief   One thread keeps the FIFO order across many laps of the ring
+ * ================================================================================================
+ */
+static void
+testFifoWrapAround (void)
+{
+    RingQueue<int> queue(4);
+    int next = 0;
+
+    for (int i = 0; i < 1000; i++)
+    {
+        CHECK(queue.push(2 * i));
+        CHECK(queue.push(2 * i + 1));
+
+        int data;
+        CHECK(queue.pop(data) && data == next++);
+        CHECK(queue.pop(data) && data == next++);
+    }
+    CHECK(queue.size() == 0);
+}
+
+
+/** ===============================================================================================
+ * \name    testConcurrent
+ *
+ * \brief   Every pushed element is popped exactly once, and the elements of one producer keep
+ *          their order for each consumer
+ * ================================================================================================
+ */
+static void*
+threadProducer (void* arg)
+{
+    Worker_Arg_t* worker = (Worker_Arg_t*) arg;
+    for (size_t i = 0; i < ITEMS_PER_PRODUCER; i++)
+    {
+        size_t item = worker->producerId * ITEMS_PER_PRODUCER + i;
+        while (!worker->queue->push(item)) sched_yield();
+    }
+    return nullptr;
+}
+
+static void*
+threadConsumer (void* arg)
+{
+    Worker_Arg_t* worker = (Worker_Arg_t*) arg;
+    vector<long> last(PRODUCER_NUM, -1);
+
+    while (worker->popped->load() < PRODUCER_NUM * ITEMS_PER_PRODUCER)
+    {
+        size_t item;
+        if (!worker->queue->pop(item))
+        {
+            sched_yield();
+            continue;
+        }
+        worker->popped->fetch_add(1);
+        (*worker->seen)[item]++;
+
+        size_t producer = item / ITEMS_PER_PRODUCER;
+        long index = item % ITEMS_PER_PRODUCER;
+        CHECK(index > last[producer]);
+        last[producer] = index;
+    }
+    return nullptr;
+}
+
+static void
+testConcurrent (void)
+{
+    RingQueue<size_t> queue(64);
+    atomic<size_t> popped(0);
+    vector<atomic<int>> seen(PRODUCER_NUM * ITEMS_PER_PRODUCER);
+    for (auto& count : seen) count = 0;
+
+    pthread_t producers[PRODUCER_NUM], consumers[CONSUMER_NUM];
+    Worker_Arg_t producerArgs[PRODUCER_NUM], consumerArg = {&queue, 0, &popped, &seen};
+
+    for (int i = 0; i < CONSUMER_NUM; i++)
+    {
+        pthread_create(&consumers[i], NULL, threadConsumer, &consumerArg);
+    }
+    for (int i = 0; i < PRODUCER_NUM; i++)
+    {
+        producerArgs[i] = {&queue, i, &popped, &seen};
+        pthread_create(&producers[i], NULL, threadProducer, &producerArgs[i]);
+    }
+
+    for (int i = 0; i < PRODUCER_NUM; i++) pthread_join(producers[i], NULL);
+    for (int i = 0; i < CONSUMER_NUM; i++) pthread_join(consumers[i], NULL);
+
+    CHECK(popped.load() == PRODUCER_NUM * ITEMS_PER_PRODUCER);
+    for (auto& count : seen)
+    {
+        CHECK(count.load() == 1);
+    }
+    CHECK(queue.size() == 0);
+}
+
+
+int
+main (void)
+{
+    RUN_TEST(testCapacity);
+    RUN_TEST(testFifoWrapAround);
+    RUN_TEST(testConcurrent);
+    return 0;
+}
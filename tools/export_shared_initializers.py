@@ -0,0 +1,52 @@
+# Export the initializers which are identical across the resolution variants of a model family, e.g.
+#
+#   python3 export_shared_initializers.py ../models/resnet50 ../models/resnet50_*.onnx
+#
+# writes ../models/resnet50_initializers/{manifest.txt, <id>.bin}. OnnxModel loads them once and
+# adds them into every session of the family, so the weights are resident only once.
+import os
+import sys
+
+import numpy as np
+import onnx
+from onnx import numpy_helper
+
+if len(sys.argv) < 3:
+    print("usage: export_shared_initializers.py <family path> <model.onnx> ...")
+    sys.exit(1)
+
+family = sys.argv[1]
+models = sys.argv[2:]
+
+# -----------------------------------------------------------------------
+# collect the float initializers which have the same content in every model
+shared = None
+for model_path in models:
+    graph = onnx.load(model_path).graph
+    weights = {}
+    for init in graph.initializer:
+        array = numpy_helper.to_array(init)
+        if array.dtype == np.float32:
+            weights[init.name] = array
+
+    if shared is None:
+        shared = weights
+    else:
+        shared = {name: array for name, array in shared.items()
+                  if name in weights and weights[name].shape == array.shape and np.array_equal(weights[name], array)}
+
+# -----------------------------------------------------------------------
+# dump the raw data with the manifest: "<name> <file> <ndims> <dims...>"
+folder = family + "_initializers"
+if not os.path.exists(folder):
+    os.mkdir(folder)
+
+total = 0
+with open(os.path.join(folder, "manifest.txt"), "w") as manifest:
+    for idx, (name, array) in enumerate(sorted(shared.items())):
+        file_name = "{}.bin".format(idx)
+        np.ascontiguousarray(array).tofile(os.path.join(folder, file_name))
+        manifest.write("{} {} {} {}\n".format(name, file_name, array.ndim, " ".join(str(d) for d in array.shape)))
+        total += array.nbytes
+
+print("Export {} shared initializers, {:.1f} MB into {}".format(len(shared), total / 1024 / 1024, folder))
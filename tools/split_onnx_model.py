@@ -0,0 +1,62 @@
+# Partition a model into sequential subgraph segments for the preemptible inference, e.g.
+#
+#   python3 split_onnx_model.py ../models/resnet50_1280_1920.onnx 4
+#
+# writes ../models/resnet50_1280_1920_seg{0..3}.onnx and ../models/resnet50_1280_1920.segments.
+# The outputs of segment i are exactly the inputs of segment i+1 in the same order, so OnnxModel can
+# hand the intermediate tensors over without matching the names.
+import sys
+
+import onnx
+from onnx import utils
+
+if len(sys.argv) < 3:
+    print("usage: split_onnx_model.py <model.onnx> <segment num>")
+    sys.exit(1)
+
+model_path = sys.argv[1]
+segment_num = int(sys.argv[2])
+prefix = model_path[:-len(".onnx")]
+
+model = onnx.shape_inference.infer_shapes(onnx.load(model_path))
+graph = model.graph
+initializers = set(init.name for init in graph.initializer)
+graph_inputs = [i.name for i in graph.input if i.name not in initializers]
+graph_outputs = [o.name for o in graph.output]
+
+# -----------------------------------------------------------------------
+# find the cut points: after node k, the only live activation is one tensor
+last_use = {}
+for idx, node in enumerate(graph.node):
+    for name in node.input:
+        last_use[name] = idx
+
+candidates = []
+live = set(graph_inputs)
+for idx, node in enumerate(graph.node):
+    live.update(node.output)
+    live = set(name for name in live if last_use.get(name, -1) > idx)
+    if len(live) == 1 and 0 < idx < len(graph.node) - 1:
+        candidates.append((idx, next(iter(live))))
+
+if len(candidates) < segment_num - 1:
+    print("Only {} cut points, can't split into {} segments".format(len(candidates), segment_num))
+    sys.exit(1)
+
+# pick the cut points evenly by the number of nodes
+cuts = []
+for k in range(1, segment_num):
+    target = len(graph.node) * k / segment_num
+    cuts.append(min(candidates, key=lambda c: abs(c[0] - target))[1])
+cuts = sorted(set(cuts), key=lambda name: [c[1] for c in candidates].index(name))
+
+# -----------------------------------------------------------------------
+# extract the segments
+boundaries = [graph_inputs] + [[cut] for cut in cuts] + [graph_outputs]
+for seg in range(len(boundaries) - 1):
+    utils.extract_model(model_path, "{}_seg{}.onnx".format(prefix, seg), boundaries[seg], boundaries[seg + 1])
+
+with open(prefix + ".segments", "w") as manifest:
+    manifest.write("{}\n".format(len(boundaries) - 1))
+
+print("Split {} into {} segments at {}".format(model_path, len(boundaries) - 1, cuts))